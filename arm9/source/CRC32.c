@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "CRC32.h"
+#include "emu/gzfile.h"
 
 #define CRC32_POLY 0x04C11DB7
 
@@ -60,6 +61,8 @@ const u32 crc32_table[256] = {
 
 // ------------------------------------------------------------------------------------
 // Read the file in and compute CRC... it's a bit slow but good enough and accurate!
+// A gzip compressed image is read uncompressed so it finds the same settings as the
+// plain one does.
 // ------------------------------------------------------------------------------------
 u8 file_crc_buffer[1024];
 u32 getFileCrc(const char* filename)
@@ -67,7 +70,7 @@ u32 getFileCrc(const char* filename)
     u32 crc = 0xFFFFFFFF;
     int bytesRead;
 
-    FILE* file = fopen(filename, "rb");
+    FILE* file = GZ_fopen(filename, "rb");
     if (file)
     {
         while ((bytesRead = fread(file_crc_buffer, 1, sizeof(file_crc_buffer), file)) > 0)
@@ -88,7 +91,7 @@ u32 getFileCrcATR(const char* filename)
     u32 crc = 0xFFFFFFFF;
     int bytesRead;
 
-    FILE* file = fopen(filename, "rb");
+    FILE* file = GZ_fopen(filename, "rb");
     if (file)
     {
         // For ATR files we are using the first 8K only - good enough and many ATR disks get written so we can't rely on more...
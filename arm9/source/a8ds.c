@@ -36,7 +36,10 @@
 #include "cartridge.h"
 #include "input.h"
 #include "esc.h"
+#include "cpu.h"
+#include "profile.h"
 #include "rtime.h"
+#include "sio.h"
 #include "emu/pia.h"
 
 #include "clickNoQuit_wav.h"
@@ -58,7 +61,7 @@
 
 #define MAX_FILES 1024                      // No more than this many files can be processed per directory
 
-FICA_A8 a8romlist[MAX_FILES];               // For reading all the .ATR .XEX .CAR and .ROM files from the SD card
+FICA_A8 a8romlist[MAX_FILES];               // For reading all the .ATR .XEX .CAR .ROM and .CAS files from the SD card
 u16 count8bit=0, countfiles=0, ucFicAct=0;  // Counters for all the 8-bit files found on the SD card
 u16 gTotalAtariFrames = 0;                  // For FPS counting
 int bg0, bg1, bg2, bg3, bg0b, bg1b;         // Background "pointers"
@@ -73,11 +76,19 @@ bool bShowKeyboard = false;                 // set to true when the virtual keyb
 u8 sound_buffer[32]         __attribute__((aligned (2))) = {0};
 u16* aptr                   __attribute__((section(".dtcm"))) = (u16*) ((u32)&sound_buffer[0] + 0xA000000); 
 u16* bptr                   __attribute__((section(".dtcm"))) = (u16*) ((u32)&sound_buffer[2] + 0xA000000);
+u16* cptr                   __attribute__((section(".dtcm"))) = (u16*) ((u32)&sound_buffer[4] + 0xA000000);   // Right channel when the second Pokey is in
+u16* dptr                   __attribute__((section(".dtcm"))) = (u16*) ((u32)&sound_buffer[6] + 0xA000000);
 u16 sound_idx               __attribute__((section(".dtcm"))) = 0;
-u8 myPokeyBufIdx            __attribute__((section(".dtcm"))) = 0;
+u16 myPokeyBufIdx           __attribute__((section(".dtcm"))) = 0;
 u8 bMute                    __attribute__((section(".dtcm"))) = 0;
+u8 bStereo                  __attribute__((section(".dtcm"))) = 0;     // The Pokey buffer holds left/right pairs - one per chip
 u16 sampleExtender[256]     __attribute__((section(".dtcm"))) = {0};
 
+extern int snd_playback_freq;   // The rate the Pokey sound core was set up for - SOUND_FREQ when the game was loaded
+extern unsigned char Num_pokeys;// And how many chips it was set up with - 2 for stereo
+extern u32 snd_samples_bypassed;// Samples the Pokey sound core filled in without synthesis - nothing sounding
+extern u16 pokeyBufIdx;         // Where the Pokey writes its next sample - VsoundHandler() follows it with myPokeyBufIdx
+
 short int screen_slide_x __attribute__((section(".dtcm"))) = 0;
 short int screen_slide_y __attribute__((section(".dtcm"))) = 0;
 
@@ -111,6 +122,38 @@ ITCM_CODE static void DumpDebugData(void)
             siprintf(dbgbuf, "%02d: %10d  %08X", i, debug[i], debug[i]);
             dsPrintValue(0,3+i,0, dbgbuf);
         }
+        // And how many 6502 cycles the idle-loop skipper saved us in the last second
+        static ULONG last_idle_cycles = 0;
+        siprintf(dbgbuf, "IDLE: %10d CYC/SEC  ", (int)(idle_cycles_skipped - last_idle_cycles));
+        dsPrintValue(0,3+MAX_DEBUG,0, dbgbuf);
+        last_idle_cycles = idle_cycles_skipped;
+        // And how many frames were drawn and skipped (and how far behind we are for SKIP FRAMES = AUTO)
+        static ULONG last_drawn = 0, last_skipped = 0;
+        siprintf(dbgbuf, "SKIP:%3d DRAWN %3d SKIP %4d LAG", (int)(frames_drawn - last_drawn), (int)(frames_skipped - last_skipped), autoskip_lag);
+        dsPrintValue(0,4+MAX_DEBUG,0, dbgbuf);
+        last_drawn = frames_drawn;
+        last_skipped = frames_skipped;
+        // And how many sound samples went out with nothing sounding - no Pokey synthesis needed
+        static u32 last_bypassed = 0;
+        siprintf(dbgbuf, "SND:  %10d QUIET/SEC  ", (int)(snd_samples_bypassed - last_bypassed));
+        dsPrintValue(0,5+MAX_DEBUG,0, dbgbuf);
+        last_bypassed = snd_samples_bypassed;
+        // And whether the sound kept flowing - ticks with no sample, samples written over and the AUDIO CLOCK nudge
+        static ULONG last_under = 0, last_over = 0;
+        siprintf(dbgbuf, "PACE:%4d UNDR %4d OVR %+4d ADJ", (int)(pace_underruns - last_under), (int)(pace_overruns - last_over), pace_adjust);
+        dsPrintValue(0,6+MAX_DEBUG,0, dbgbuf);
+        last_under = pace_underruns;
+        last_over = pace_overruns;
+        // And how the disk read-ahead did for D1 and D2 - sectors from the buffer and from the file
+        static ULONG last_hits[2] = {0,0}, last_misses[2] = {0,0};
+        siprintf(dbgbuf, "DISK:%4d/%-4d D1 %4d/%-4d D2", (int)(SIO_readahead_hits[0] - last_hits[0]), (int)(SIO_readahead_misses[0] - last_misses[0]),
+                 (int)(SIO_readahead_hits[1] - last_hits[1]), (int)(SIO_readahead_misses[1] - last_misses[1]));
+        dsPrintValue(0,7+MAX_DEBUG,0, dbgbuf);
+        for (int i=0; i<2; i++)
+        {
+            last_hits[i] = SIO_readahead_hits[i];
+            last_misses[i] = SIO_readahead_misses[i];
+        }
     }
 }
 
@@ -147,24 +190,115 @@ void dsClearDiskActivity(void)
 }
 
 // ---------------------------------------------------------------------------
-// This is called very frequently (about 16,000 times per second) to fill the
-// pipeline of sound values from the pokey buffer into the Nintendo DS sound
-// buffer which will be processed in the background by the ARM 7 processor.
+// Show what percentage of scanlines ANTIC found unchanged and didn't have to
+// redraw over the last second. Goes where the disk activity indicator does -
+// disk activity simply writes over it.
+// ---------------------------------------------------------------------------
+void dsShowLineSkip(void)
+{
+    static ULONG last_drawn = 0, last_skipped = 0;
+    char buf[5];
+
+    ULONG drawn = antic_lines_drawn - last_drawn;
+    ULONG skipped = antic_lines_skipped - last_skipped;
+    last_drawn = antic_lines_drawn;
+    last_skipped = antic_lines_skipped;
+
+    int pct = (drawn + skipped) ? (int)((skipped * 100) / (drawn + skipped)) : 0;
+    if (pct > 99) pct = 99;
+    buf[0] = '0' + pct / 10;
+    buf[1] = '0' + pct % 10;
+    buf[2] = '%';
+    buf[3] = 0;
+    dsPrintValue(3,0,0, buf);
+}
+
+// ---------------------------------------------------------------------------
+// This is called very frequently (once per output sample - about 16,000 times
+// per second, up to 31,000 at the highest SOUND rate) to fill the pipeline of
+// sound values from the pokey buffer into the Nintendo DS sound buffer which
+// will be processed in the background by the ARM 7 processor. In stereo the
+// pokey buffer holds a left and right sample for each tick and the right one
+// goes out on a second DS channel panned hard over.
 // ---------------------------------------------------------------------------
 ITCM_CODE void VsoundHandler(void)
 {
     extern unsigned char pokey_buffer[];
     extern u16 pokeyBufIdx;
     
-    if (bMute) *bptr = *aptr;
+    if (bMute) {*bptr = *aptr; *dptr = *cptr;}
+
+    else if (bStereo)
+    {
+        myPokeyBufIdx = (myPokeyBufIdx + 1) & (SNDLENGTH - 2);     // Round an odd index left from mono up to a pair - as the Pokey side does
+        if (myPokeyBufIdx != pokeyBufIdx)
+        {
+            u16 left  = sampleExtender[pokey_buffer[myPokeyBufIdx]];
+            u16 right = sampleExtender[pokey_buffer[myPokeyBufIdx+1]];
+            myPokeyBufIdx = (myPokeyBufIdx + 2) & (SNDLENGTH - 1);
+            *aptr = left;  *bptr = left;
+            *cptr = right; *dptr = right;
+        }
+        else pace_underruns++;
+    }
 
     // If there is a fresh sample... 
     else if (myPokeyBufIdx != pokeyBufIdx)
     {
-        u16 sample = sampleExtender[pokey_buffer[myPokeyBufIdx++]];
+        u16 sample = sampleExtender[pokey_buffer[myPokeyBufIdx]];
+        myPokeyBufIdx = (myPokeyBufIdx + 1) & (SNDLENGTH - 1);
         *aptr = sample;
         *bptr = sample;
     }
+    else pace_underruns++;  // Nothing new - the DS keeps playing the last sample
+}
+
+// ---------------------------------------------------------------------------
+// How many samples the Pokey has put in its ring that VsoundHandler() hasn't
+// played yet.
+// ---------------------------------------------------------------------------
+static inline int dsSoundFill(void)
+{
+    return ((pokeyBufIdx - myPokeyBufIdx) & (SNDLENGTH - 1)) >> bStereo;
+}
+
+// ---------------------------------------------------------------------------
+// The rate the sound timer takes samples out of the Pokey ring. With DS TIMER
+// pacing it runs very slightly faster than the Pokey makes them to ensure we
+// always swallow all samples produced. With AUDIO CLOCK pacing the frames
+// follow the sound, so it runs at the Pokey rate nudged by the pacer.
+// ---------------------------------------------------------------------------
+static int dsSoundTimerFreq(void)
+{
+    if (myConfig.frame_pacing == PACING_AUDIO) return snd_playback_freq + ((snd_playback_freq * pace_adjust) >> 16);
+    return snd_playback_freq + 10;
+}
+
+// ---------------------------------------------------------------------------
+// Sleep until the next sound timer interrupt - one comes every 32-64us, so
+// this is as fine-grained as spinning on a timer but lets the ARM9 halt in
+// between. Returns 0 without waiting if the sound timer isn't running (or
+// is muted and not taking samples).
+// ---------------------------------------------------------------------------
+static inline int dsWaitSoundTick(void)
+{
+    if (bMute || !(TIMER2_CR & TIMER_ENABLE) || !(REG_IE & IRQ_TIMER2)) return 0;
+    swiIntrWait(1, IRQ_TIMER2);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// FRAME PACING = AUDIO CLOCK. Wait for the sound timer to play the Pokey ring
+// down to one frame's worth of samples and then let Atari800_PaceRate() nudge
+// the sound timer to keep it there when the emulation falls behind.
+// ---------------------------------------------------------------------------
+static void dsPaceToAudio(void)
+{
+    int frame = snd_playback_freq / (myConfig.tv_type == TV_NTSC ? 60:50);
+
+    while ((dsSoundFill() > frame) && dsWaitSoundTick())
+        ;
+    Atari800_PaceRate(dsSoundFill());
 }
 
 // ---------------------------------------------------------------------------
@@ -477,6 +611,9 @@ void dsInitTimer(void)
 // --------------------------------------------------
 void dsShowScreenEmu(void)
 {
+    // Whatever ANTIC left in the bitmaps can't be trusted after a trip through the menus
+    ANTIC_InvalidateLines();
+
     // Change vram
     if (myConfig.alphaBlend)
     {
@@ -779,12 +916,34 @@ void dsShowRomInfo(void)
     dsPrintValue(7,0,0, line2);
 }
 
+// ----------------------------------------------------------------------------------------
+// The extension that says what sort of image a file is. A gzip compressed image keeps its
+// own ahead of the .gz (GAME.ATR.GZ is an .ATR) and .ATZ is the short name for an .ATR.GZ
+// ----------------------------------------------------------------------------------------
+static const char *dsImageType(const char *filename)
+{
+    static char ext[10];
+    const char *dot = strrchr(filename, '.');
+
+    if (dot == NULL) return "";
+    if (strcasecmp(dot, ".atz") == 0) return ".atr";
+    if (strcasecmp(dot, ".gz") == 0)
+    {
+        const char *inner = dot;
+        while (inner > filename && *(inner-1) != '.' && (dot - inner) < (int)sizeof(ext)) inner--;
+        if (inner == filename || *(inner-1) != '.') return dot;
+        inner--;
+        memcpy(ext, inner, dot - inner);
+        ext[dot - inner] = 0;
+        return ext;
+    }
+    return dot;
+}
+
 bool isDisk(char *filename)
 {
-    if (strcasecmp(strrchr(filename, '.'), ".atr") == 0) return TRUE;
-    if (strcasecmp(strrchr(filename, '.'), ".ATR") == 0) return TRUE;
-    if (strcasecmp(strrchr(filename, '.'), ".atx") == 0) return TRUE;
-    if (strcasecmp(strrchr(filename, '.'), ".ATX") == 0) return TRUE;
+    if (strcasecmp(dsImageType(filename), ".atr") == 0) return TRUE;
+    if (strcasecmp(dsImageType(filename), ".atx") == 0) return TRUE;
     return FALSE;
 }
 
@@ -835,10 +994,11 @@ void dsLoadGame(char *filename, int disk_num, bool bRestart, bool bReadOnly)
 
       dsSetAtariPalette();
 
-      // In case we switched PAL/NTSC
+      // In case we switched PAL/NTSC or the SOUND rate
       dsInstallSoundEmuFIFO();
 
-      TIMER2_DATA = TIMER_FREQ(SOUND_FREQ+10);   // Very slightly faster to ensure we always swallow all samples produced by the Pokey
+      pace_adjust = 0;
+      TIMER2_DATA = TIMER_FREQ(dsSoundTimerFreq());
       TIMER2_CR = TIMER_DIV_1 | TIMER_IRQ_REQ | TIMER_ENABLE;
       irqSet(IRQ_TIMER2, VsoundHandler);
 
@@ -1618,12 +1778,16 @@ int dsHandleStarRaidersKeyboard(int Tx, int Ty)
 void dsInstallSoundEmuFIFO(void)
 {
     static int last_sound_fifo = -1;
-    if (last_sound_fifo == -1)
+    static int last_sound_pokeys = -1;
+    if ((last_sound_fifo != snd_playback_freq) || (last_sound_pokeys != Num_pokeys))    // First time in, or the Pokey was set up for another rate (TV type or SOUND option) or for stereo
     {
-        last_sound_fifo = 1;
+        last_sound_fifo = snd_playback_freq;
+        last_sound_pokeys = Num_pokeys;
         irqDisable(IRQ_TIMER2);    
         fifoSendValue32(FIFO_USER_01,(1<<16) | SOUND_KILL);
-        *aptr = 0; *bptr=0;
+        fifoSendValue32(FIFO_USER_01,(2<<16) | SOUND_KILL);
+        *aptr = 0; *bptr=0; *cptr = 0; *dptr = 0;
+        bStereo = (Num_pokeys > 1);
         // We are going to use the 16-bit sound engine so we need to scale up our 8-bit values...
         for (int i=0; i<256; i++)
         {
@@ -1634,19 +1798,23 @@ void dsInstallSoundEmuFIFO(void)
         {
             aptr = (u16*) ((u32)&sound_buffer[0] + 0xA000000); 
             bptr = (u16*) ((u32)&sound_buffer[2] + 0xA000000);
+            cptr = (u16*) ((u32)&sound_buffer[4] + 0xA000000); 
+            dptr = (u16*) ((u32)&sound_buffer[6] + 0xA000000);
         }
         else
         {
             aptr = (u16*) ((u32)&sound_buffer[0] + 0x00400000);
             bptr = (u16*) ((u32)&sound_buffer[2] + 0x00400000);
+            cptr = (u16*) ((u32)&sound_buffer[4] + 0x00400000);
+            dptr = (u16*) ((u32)&sound_buffer[6] + 0x00400000);
         }
         swiWaitForVBlank();swiWaitForVBlank();    // Wait 2 vertical blanks... that's enough for the ARM7 to stop...
 
         FifoMessage msg;
         msg.SoundPlay.data = &sound_buffer;
-        msg.SoundPlay.freq = SOUND_FREQ*2;
+        msg.SoundPlay.freq = snd_playback_freq*2;
         msg.SoundPlay.volume = 127;
-        msg.SoundPlay.pan = 64;
+        msg.SoundPlay.pan = bStereo ? 0 : 64;   // First Pokey hard left in stereo
         msg.SoundPlay.loop = 1;
         msg.SoundPlay.format = ((1)<<4) | SoundFormat_16Bit;
         msg.SoundPlay.loopPoint = 0;
@@ -1654,6 +1822,14 @@ void dsInstallSoundEmuFIFO(void)
         msg.type = EMUARM7_PLAY_SND;
         fifoSendDatamsg(FIFO_USER_01, sizeof(msg), (u8*)&msg);
 
+        if (bStereo)    // Second Pokey on channel 2, hard right, from the next two samples of the buffer
+        {
+            msg.SoundPlay.data = &sound_buffer[4];
+            msg.SoundPlay.pan = 127;
+            msg.SoundPlay.format = ((2)<<4) | SoundFormat_16Bit;
+            fifoSendDatamsg(FIFO_USER_01, sizeof(msg), (u8*)&msg);
+        }
+
         swiWaitForVBlank();swiWaitForVBlank();    // Wait 2 vertical blanks... that's enough for the ARM7 to start chugging...
         irqEnable(IRQ_TIMER2);
     }
@@ -1706,6 +1882,7 @@ void dsMainLoop(void)
 
       case A8_PLAYINIT:
         dsShowScreenEmu();
+        Atari800_ResetFrameSkip();  // Time spent in the menus isn't lag
         irqEnable(IRQ_TIMER2);
         bMute = 0;            
         emu_state = A8_PLAYGAME;
@@ -1722,10 +1899,21 @@ void dsMainLoop(void)
         // 32,728.5 ticks = 1 second
         // 1 frame = 1/50 or 1/60 (0.02 or 0.016)
         // 655 -> 50 fps and 546 -> 60 fps
+        // With AUDIO CLOCK pacing the frames wait on the sound instead.
         if (myConfig.fps_setting < 2)
         {
-            while(TIMER0_DATA < ((myConfig.tv_type == TV_NTSC ? 546:656)*atari_frames))
-                ;
+            if (myConfig.frame_pacing == PACING_AUDIO) dsPaceToAudio();
+            else
+            {
+                while(TIMER0_DATA < ((myConfig.tv_type == TV_NTSC ? 546:656)*atari_frames))
+                    dsWaitSoundTick();
+            }
+        }
+        {
+            static int last_sound_freq = 0;
+            int sound_freq = dsSoundTimerFreq();
+            if (sound_freq != last_sound_freq) TIMER2_DATA = TIMER_FREQ(sound_freq);
+            last_sound_freq = sound_freq;
         }
 
         // ------------------------------------------------------------------------
@@ -1735,7 +1923,17 @@ void dsMainLoop(void)
         // frame. All of the NTSC and PAL scanlines are done here - and this is
         // where the Nitnendo DS is spending most of its CPU time. 
         // ------------------------------------------------------------------------
-        Atari800_Frame();
+        {
+            u16 frame_start = TIMER0_DATA;
+            u16 made_from = pokeyBufIdx, played_from = myPokeyBufIdx;
+            int fill = dsSoundFill();
+            Atari800_Frame();
+            if (myConfig.skip_frames == SKIP_FRAMES_AUTO) Atari800_FrameTime((u16)(TIMER0_DATA - frame_start));
+
+            // Anything made beyond what the ring holds wrote over samples not yet played
+            fill += (((pokeyBufIdx - made_from) & (SNDLENGTH - 1)) - ((myPokeyBufIdx - played_from) & (SNDLENGTH - 1))) >> bStereo;
+            if (fill >= (SNDLENGTH >> bStereo)) pace_overruns += fill - (SNDLENGTH >> bStereo) + 1;
+        }
 
         // ----------------------------------------------------
         // If we have processed 60/50 frames we start anew...
@@ -1770,6 +1968,7 @@ void dsMainLoop(void)
             gTotalAtariFrames = 0;
             DumpDebugData();
             dsClearDiskActivity();
+            if (myConfig.fps_setting) dsShowLineSkip(); // Shares the slot with the disk activity indicator
             if(bAtariCrash) dsPrintValue(1,23,0, "GAME CRASH - PICK ANOTHER GAME");
         }
 
@@ -2155,6 +2354,18 @@ void dsMainLoop(void)
                     {
                         lcdSwap();  // Exchange (Swap) LCD screens...
                     }
+#ifdef CPU_PROFILE
+                    else if (keys_pressed & KEY_B)
+                    {
+                        // Write out the 6502 hot-spot report and start counting afresh
+                        DIR* dir = opendir("/data");
+                        if (dir) closedir(dir); else mkdir("/data", 0777);
+                        dsPrintValue(3,0,0, (char*)"PROF");
+                        PROFILE_Dump(PROFILE_FILE);
+                        PROFILE_Reset();
+                        dsPrintValue(3,0,0, (char*)"    ");
+                    }
+#endif
                     else
                     {
                         dsPrintValue(3,0,0, (char*)"SNAP");
@@ -2233,30 +2444,35 @@ void a8FindFiles(void)
       }
       else
       {
-          if (strcmp(file_load_id,"D2")!=0)      // For D2: we don't load .xex
+          if (strcmp(file_load_id,"D2")!=0)      // For D2: we don't load .xex (or carts and tapes)
           {
-              if ( (strcasecmp(strrchr(filenametmp, '.'), ".xex") == 0) )  {
+              if ( (strcasecmp(dsImageType(filenametmp), ".xex") == 0) )  {
+                a8romlist[count8bit].directory = false;
+                strcpy(a8romlist[count8bit].filename,filenametmp);
+                count8bit++;countfiles++;
+              }
+              if ( (strcasecmp(dsImageType(filenametmp), ".car") == 0) )  {
                 a8romlist[count8bit].directory = false;
                 strcpy(a8romlist[count8bit].filename,filenametmp);
                 count8bit++;countfiles++;
               }
-              if ( (strcasecmp(strrchr(filenametmp, '.'), ".car") == 0) )  {
+              if ( (strcasecmp(dsImageType(filenametmp), ".rom") == 0) )  {
                 a8romlist[count8bit].directory = false;
                 strcpy(a8romlist[count8bit].filename,filenametmp);
                 count8bit++;countfiles++;
               }
-              if ( (strcasecmp(strrchr(filenametmp, '.'), ".rom") == 0) )  {
+              if ( (strcasecmp(dsImageType(filenametmp), ".cas") == 0) )  {
                 a8romlist[count8bit].directory = false;
                 strcpy(a8romlist[count8bit].filename,filenametmp);
                 count8bit++;countfiles++;
               }
           }
-          if ( (strcasecmp(strrchr(filenametmp, '.'), ".atr") == 0) )  {
+          if ( (strcasecmp(dsImageType(filenametmp), ".atr") == 0) )  {
             a8romlist[count8bit].directory = false;
             strcpy(a8romlist[count8bit].filename,filenametmp);
             count8bit++;countfiles++;
           }
-          if ( (strcasecmp(strrchr(filenametmp, '.'), ".atx") == 0) )  {
+          if ( (strcasecmp(dsImageType(filenametmp), ".atx") == 0) )  {
             a8romlist[count8bit].directory = false;
             strcpy(a8romlist[count8bit].filename,filenametmp);
             count8bit++;countfiles++;
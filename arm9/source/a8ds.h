@@ -49,7 +49,7 @@ extern u16 emu_state;
 extern u16 atari_frames;
 
 extern u16 sound_idx;
-extern u8 myPokeyBufIdx;
+extern u16 myPokeyBufIdx;
 
 extern void FadeToColor(unsigned char ucSens, unsigned short ucBG, unsigned char ucScr, unsigned char valEnd, unsigned char uWait);
 extern void vblankIntr();
@@ -55,7 +55,7 @@ UBYTE bAtariOS=false;                         // Real Atari XL BIOS is OFF by de
 UBYTE bAtariOSB=false;                        // Real Atari OSB BIOS is OFF by default
 UBYTE bAtariBASIC=false;                      // Real Atari Basic Rev C is OFF by default
 
-UBYTE option_table        = 0;                // We have 2 pages of configuration options - this toggles between them
+UBYTE option_table        = 0;                // We have 3 pages of configuration options - X steps through them
 UBYTE force_tv_type       = 99;               // When selecting a game, the user can force the TV type (NTSC vs PAL)
 UBYTE force_basic_type    = 99;               // When selecting a game, the user can force the use of BASIC
 
@@ -130,10 +130,10 @@ void InitGameSettings(void)
     for (int i=0; i<MAX_GAME_SETTINGS; i++)
     {
         GameDB.GameSettings[i].slot_used = 0;
-        // Map one with a default of '1' which may come in handy in the future....
-        GameDB.GameSettings[i].spare6 = 1;
+        // Idle-loop skipping is on unless a game is known not to like it
+        GameDB.GameSettings[i].idle_skip = 1;
     }
-    GameDB.default_skip_frames = (isDSiMode() ? 0:1);   // For older DS models, we skip frames to get full speed...
+    GameDB.default_skip_frames = (isDSiMode() ? 0:SKIP_FRAMES_AUTO);   // For older DS models, we skip frames (only when behind) to get full speed...
     GameDB.default_os_type = (bAtariOS ? OS_ATARI_XL : OS_ALTIRRA_XL);
     GameDB.default_blending = 1;
     GameDB.default_ram_type = RAM_IDX_128K;
@@ -242,6 +242,11 @@ void WriteGameSettings(void)
         GameDB.GameSettings[idx].cart_type          = myConfig.cart_type;
         GameDB.GameSettings[idx].emulatorText       = myConfig.emulatorText;
         GameDB.GameSettings[idx].alphaBlend         = myConfig.alphaBlend;
+        GameDB.GameSettings[idx].idle_skip          = myConfig.idle_skip;
+        GameDB.GameSettings[idx].collision_disable  = myConfig.collision_disable;
+        GameDB.GameSettings[idx].sound_mode         = myConfig.sound_mode;
+        GameDB.GameSettings[idx].pokey_stereo       = myConfig.pokey_stereo;
+        GameDB.GameSettings[idx].frame_pacing       = myConfig.frame_pacing;
         for (int i=0; i<8; i++) GameDB.GameSettings[idx].keyMap[i] = myConfig.keyMap[i];
         GameDB.checksum = 0;
         char *ptr = (char *)GameDB.GameSettings;
@@ -407,6 +412,11 @@ void SetMyConfigDefaults(void)
     myConfig.auto_fire          = GameDB.default_auto_fire;
     myConfig.key_click_disable  = GameDB.default_key_click_disable;
     myConfig.disk_speedup = 1;
+    myConfig.idle_skip = 1;
+    myConfig.collision_disable = 0;
+    myConfig.sound_mode = 0;
+    myConfig.pokey_stereo = 0;
+    myConfig.frame_pacing = 0;
     for (int i=0; i<8; i++)  myConfig.keyMap[i] = GameDB.default_keyMap[i];
 }
 
@@ -447,6 +457,11 @@ void ApplyGameSpecificSettings(void)
         myConfig.cart_type          = GameDB.GameSettings[idx].cart_type;
         myConfig.emulatorText       = GameDB.GameSettings[idx].emulatorText;
         myConfig.alphaBlend         = GameDB.GameSettings[idx].alphaBlend;
+        myConfig.idle_skip          = GameDB.GameSettings[idx].idle_skip;
+        myConfig.collision_disable  = GameDB.GameSettings[idx].collision_disable;
+        myConfig.sound_mode         = GameDB.GameSettings[idx].sound_mode;
+        myConfig.pokey_stereo       = GameDB.GameSettings[idx].pokey_stereo;
+        myConfig.frame_pacing       = GameDB.GameSettings[idx].frame_pacing;
         for (int i=0; i<8; i++)  myConfig.keyMap[i] = GameDB.GameSettings[idx].keyMap[i];
     }
     else // No match. Use defaults for this game...
@@ -538,7 +553,7 @@ struct options_t
                     "38-SWXEGS1024", "39-PHOENIX8", "40-BLIZZARD16", "41-ATMAX128", "42-ATMAX1024", "43-SDX128", "44-OSS8", "45-OSS16-043M", "45-NO SUPPORT", "46-NO SUPPORT", "47-NO SUPPORT", "48-NO SUPPORT", \
                     "49-NO SUPPORT", "50-TURBO64", "51-TURBO128", "52-NO SUPPORT", "53-NO SUPPORT", "54-SIC128", "55-SIC256", "56-SIC512", "57-NO SUPPORT", "58-STD4" }
 
-const struct options_t Option_Table[2][20] =
+const struct options_t Option_Table[3][20] =
 {
     // Page 1
     {
@@ -549,14 +564,15 @@ const struct options_t Option_Table[2][20] =
                          "ALTIRRA 800", "ATARIOSB.ROM"},                    &myConfig.os_type,              OPT_NORMAL, 4,   "BUILT-IN ALTIRRA  ",   "USUALLY. FEW GAMES",  "REQUIRE ATARIXL OR",  "ATARIOSB TO WORK  "},
         {"BASIC",       {"DISABLED",    "ALTIRRA",      "ATARIBAS.ROM"},    &myConfig.basic_type,           OPT_NORMAL, 3,   "NORMALLY DISABLED ",   "EXCEPT FOR BASIC  ",  "GAMES THAT REQUIRE",  "THE CART INSERTED "},
         {"PALETTE",     {"NTSC",        "PAL"},                             &myConfig.palette_type,         OPT_NORMAL, 2,   "CHOOSE PALETTE    ",   "THAT BEST SUITS   ",  "YOUR VIEWING      ",  "PREFERENCE        "},
-        {"SKIP FRAMES", {"NO",          "MODERATE",     "AGGRESSIVE"},      &myConfig.skip_frames,          OPT_NORMAL, 3,   "OFF NORMALLY AS   ",   "SOME GAMES CAN    ",  "GLITCH WHEN SET   ",  "TO FRAMESKIP      "},
+        {"SKIP FRAMES", {"NO",          "MODERATE",     "AGGRESSIVE",
+                         "AUTO"},                                           &myConfig.skip_frames,          OPT_NORMAL, 4,   "OFF NORMALLY. AUTO",   "SKIPS ONLY WHEN   ",  "BEHIND. SOME GAMES",  "GLITCH WHEN SKIP  "},
         
         {"FPS SETTING", {"OFF",         "ON", "ON-TURBO"},                  &myConfig.fps_setting,          OPT_NORMAL, 3,   "SHOW FPS ON MAIN  ",   "DISPLAY. OPTIONALY",  "RUN IN TURBO MODE ",  "FAST AS POSSIBLE  "},
         {"ARTIFACTING", {"OFF",         "1:BROWN/BLUE", "2:BLUE/BROWN",
                                         "3:RED/GREEN","4:GREEN/RED"},       &myConfig.artifacting,          OPT_NORMAL, 5,   "A FEW HIRES GAMES ",   "NEED ARTIFACING   ",  "TO LOOK RIGHT     ",  "OTHERWISE SET OFF "},
         {"SCREEN BLUR", {"NONE",        "LIGHT", "HEAVY"},                  &myConfig.blending,             OPT_NORMAL, 3,   "NORMALLY LIGHT    ",   "BLUR TO HELP WITH ",  "SCREEN SCALING    ",  "                  "},
         {"ALPHA BLEND", {"OFF",         "ON"},                              &myConfig.alphaBlend,           OPT_NORMAL, 2,   "TURN THIS ON TO   ",   "BLEND FRAMES. THIS",  "MAKES THE SCREEN  ",  "BRIGHTER ON NON-XL"},
-        {"DISK SPEEDUP",{"OFF",         "ON"},                              &myConfig.disk_speedup,         OPT_NORMAL, 2,   "NORMALLY ON IS    ",   "DESIRED TO SPEED  ",  "UP FLOPPY DISK    ",  "ACCESS. OFF=SLOW  "},
+        {"DISK SPEEDUP",{"OFF",         "ON"},                              &myConfig.disk_speedup,         OPT_NORMAL, 2,   "NORMALLY ON TO    ",   "SPEED UP DISK AND ",  "TAPE ACCESS. OFF= ",  "REAL SPEED (SLOW) "},
         {"KEY CLICK",   {"ON",          "OFF"},                             &myConfig.key_click_disable,    OPT_NORMAL, 2,   "NORMALLY ON       ",   "CAN BE USED TO    ",  "SILENCE KEY CLICKS",  "FOR KEYBOARD USE  "},
         {"EMULATOR TXT",{"OFF",         "ON"},                              &myConfig.emulatorText,         OPT_NORMAL, 2,   "NORMALLY ON       ",   "CAN BE USED TO    ",  "DISABLE FILENAME  ",  "INFO ON MAIN SCRN "},
         {"KEYBOARD",    {"800XL STYLE1","800XL STYLE2", 
@@ -576,11 +592,21 @@ const struct options_t Option_Table[2][20] =
         {"SELECT BTN",  KEY_MAP_TEXT,                                       &myConfig.keyMap[7],            OPT_KEYSEL, 71,  "SET SELECT KEY TO ",   "DESIRED FUNCTION  ",  "JOYSTICK, KEYBOARD ", "OR META BUTTON.   "},
         {"D-PAD",       {"JOY 1", "JOY 2", "DIAGONALS", "CURSORS"},         &myConfig.dpad_type,            OPT_NORMAL, 4,   "CHOOSE HOW THE    ",   "JOYSTICK OPERATES ",  "CAN SWAP JOY1 AND ",  "JOY2 OR MAP CURSOR"},    
         {"AUTOFIRE",    {"OFF",         "SLOW",   "MED",  "FAST"},          &myConfig.auto_fire,            OPT_NORMAL, 4,   "TOGGLE AUTOFIRE   ",   "SLOW = 4x/SEC     ",  "MED  = 8x/SEC     ",  "FAST = 15x/SEC    "},
+        {"IDLE SKIP",   {"OFF",         "ON"},                              &myConfig.idle_skip,            OPT_NORMAL, 2,   "NORMALLY ON. SKIPS",   "WAIT-FOR-VBLANK   ",  "LOOPS QUICKLY. SET",  "OFF IF GAME GLITCH"},
+        {"COLLISIONS",  {"ON",          "OFF"},                             &myConfig.collision_disable,    OPT_NORMAL, 2,   "NORMALLY ON. OFF  ",   "SAVES A LITTLE FOR",  "GAMES THAT NEVER  ",  "CHECK COLLISIONS  "},
         {"X OFFSET",    {"XX"},                                     (UBYTE*)&myConfig.xOffset,              OPT_NUMERIC,0,   "SET SCREEN OFFSET ",   "                  ",  "                  ",  "                  "},
         {"Y OFFSET",    {"XX"},                                     (UBYTE*)&myConfig.yOffset,              OPT_NUMERIC,0,   "SET SCREEN OFFSET ",   "                  ",  "                  ",  "                  "},
         {"X SCALE",     {"XX"},                                     (UBYTE*)&myConfig.xScale,               OPT_NUMERIC,0,   "SET SCREEN SCALE  ",   "                  ",  "                  ",  "                  "},
         {"Y SCALE",     {"XX"},                                     (UBYTE*)&myConfig.yScale,               OPT_NUMERIC,0,   "SET SCREEN SCALE  ",   "                  ",  "                  ",  "                  "},
         
+        {NULL,          {"",            ""},                                NULL,                           OPT_NORMAL, 2,   "HELP1             ",   "HELP2             ",  "HELP3             ",  "HELP4             "}
+    },
+    // Page 3
+    {
+        {"SOUND",       {"15.7K CLASSIC", "15.7K SMOOTH",
+                         "23.6K SMOOTH",  "31.4K SMOOTH"},                  &myConfig.sound_mode,           OPT_NORMAL, 4,   "CLASSIC IS FASTEST",   "SMOOTH BAND-LIMITS",  "HIGH TONES. HIGHER",  "RATES COST MORE   "},
+        {"STEREO POKEY",{"OFF",         "ON"},                              &myConfig.pokey_stereo,         OPT_NORMAL, 2,   "NORMALLY OFF. ON  ",   "ADDS A SECOND     ",  "POKEY AT $D210 FOR",  "STEREO SOUND      "},
+        {"FRAME PACING",{"DS TIMER",    "AUDIO CLOCK"},                     &myConfig.frame_pacing,         OPT_NORMAL, 2,   "AUDIO CLOCK RUNS  ",   "EACH FRAME AS THE ",  "SOUND PLAYS OUT - ",  "NO GAPS OR LAG    "},
         {NULL,          {"",            ""},                                NULL,                           OPT_NORMAL, 2,   "HELP1             ",   "HELP2             ",  "HELP3             ",  "HELP4             "}
     }
 };
@@ -776,7 +802,7 @@ void dsChooseOptions(int bOkayToChangePalette)
             }
             if (keysCurrent() & KEY_X)  // Toggle options
             {
-                option_table = (option_table + 1) % 2;
+                option_table = (option_table + 1) % 3;
                 idx=display_options_list(true);
                 optionHighlighted = 0;
                 while (keysCurrent() != 0)
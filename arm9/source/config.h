@@ -56,12 +56,12 @@ struct GameSettings_t
     UBYTE fps_setting;
     UBYTE emulatorText;
     UBYTE alphaBlend;
-    UBYTE spare1;
-    UBYTE spare2;
-    UBYTE spare3;
-    UBYTE spare4;
+    UBYTE collision_disable;
+    UBYTE sound_mode;
+    UBYTE pokey_stereo;
+    UBYTE frame_pacing;
     UBYTE spare5;
-    UBYTE spare6;
+    UBYTE idle_skip;
     short int xOffset;
     short int yOffset;
     short int xScale;
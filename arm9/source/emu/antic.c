@@ -356,6 +356,9 @@ int right_border_start __attribute__((section(".dtcm")));
 /* set with CHBASE *and* CHACTL - bits 0..2 set if flip on */
 UWORD chbase_20 __attribute__((section(".dtcm")));           /* CHBASE for 20 character mode */
 
+/* row of the font the character modes draw the current line from - see line_font() */
+static const UBYTE *font_ptr __attribute__((section(".dtcm")));
+
 /* set with CHACTL */
 UBYTE invert_mask __attribute__((section(".dtcm")));
 int blank_mask __attribute__((section(".dtcm")));
@@ -522,6 +525,8 @@ UWORD pmbase_d __attribute__((section(".dtcm")));
 
 extern UBYTE pm_scanline[ATARI_WIDTH / 2 + 8] __attribute__((section(".dtcm")));
 extern UBYTE pm_dirty __attribute__((section(".dtcm")));
+extern UWORD pm_span_lo __attribute__((section(".dtcm")));
+extern UWORD pm_span_hi __attribute__((section(".dtcm")));
 
 /* PMG lookup tables */
 UBYTE pm_lookup_table[20][256];
@@ -757,6 +762,8 @@ static void setup_art_colours(void)
 
 void ANTIC_Initialise(void) {
     ANTIC_UpdateArtifacting();
+    ANTIC_InvalidateLines();
+    ANTIC_ResetGlyphCache();
 
     playfield_lookup[0x00] = L_BAK;
     playfield_lookup[0x40] = L_PF0;
@@ -780,6 +787,7 @@ void ANTIC_Reset(void) {
     NMIEN = 0x00;
     NMIST = 0x1f;
     ANTIC_PutByte(_DMACTL, 0);
+    ANTIC_InvalidateLines();
 }
 
 /* Border ------------------------------------------------------------------ */
@@ -870,15 +878,22 @@ static void do_border_gtia11(void)
 ITCM_CODE static void draw_antic_0(void)
 {
     UWORD *ptr = scrn_ptr + LBORDER_START;
-    if (pm_dirty) {
-        const UBYTE *pm_scanline_ptr = &pm_scanline[LBORDER_START];
+    FILL_VIDEO(ptr, cl_lookup[C_BAK], (RBORDER_END - LBORDER_START) * 2);
+    /* then only the four pixel groups the PM span reaches */
+    if (pm_dirty && pm_span_lo < pm_span_hi) {
+        int lo = pm_span_lo & ~3;
+        int hi = (pm_span_hi + 3) & ~3;
+        const UBYTE *pm_scanline_ptr;
         ULONG background = lookup_gtia9[0];
-        do
+        if (lo < LBORDER_START)
+            lo = LBORDER_START;
+        if (hi > RBORDER_END)
+            hi = RBORDER_END;
+        ptr = scrn_ptr + lo;
+        pm_scanline_ptr = &pm_scanline[lo];
+        while (pm_scanline_ptr < &pm_scanline[hi])
             DO_BORDER
-        while (pm_scanline_ptr < &pm_scanline[RBORDER_END]);
     }
-    else
-        FILL_VIDEO(ptr, cl_lookup[C_BAK], (RBORDER_END - LBORDER_START) * 2);
 }
 
 static void draw_antic_0_gtia10(void)
@@ -1093,11 +1108,7 @@ static void draw_an_gtia11(const ULONG *t_pm_scanline_ptr)
 
 #define ADD_FONT_CYCLES xpos += font_cycles[md]
 
-#define INIT_ANTIC_2    const UBYTE *chptr;\
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)\
-        chptr = antic_xe_ptr + ((dctr ^ chbase_20) & 0x3c07);\
-    else\
-        chptr = AnticMainMemLookup(((dctr ^ chbase_20) & 0xfc07));\
+#define INIT_ANTIC_2    const UBYTE *chptr = font_ptr;\
     ADD_FONT_CYCLES;\
     blank_lookup[0x60] = (anticmode == 2 || dctr & 0xe) ? 0xff : 0;\
     blank_lookup[0x00] = blank_lookup[0x20] = blank_lookup[0x40] = (dctr & 0xe) == 8 ? 0 : 0xff;
@@ -1106,19 +1117,297 @@ static void draw_an_gtia11(const ULONG *t_pm_scanline_ptr)
     if (blank_lookup[screendata & blank_mask])\
         chdata ^= chptr[(screendata & 0x7f) << 3];
 
+/* Glyph row cache
+   The normal character modes spend most of their time turning each font byte
+   into pixels through the colour lookups, for the same few dozen characters
+   over and over. These tables hold that expansion, as the two longs the 8 (or
+   in modes 6 and 7 the 4) pixels of a character row come to, for every font
+   byte under one set of colours. They are keyed on the font byte itself rather
+   than on where it came from, so writes to the font need no invalidation; a
+   few colour sets are kept at once because DLIs commonly recolour each text
+   row, and a colour set that isn't there costs one rebuild. */
+
+#define GLYPH_SETS      4
+#define GLYPH_NO_KEY    0xffffffff      /* no colour register word can make this */
+
+static ULONG glyph2_key[GLYPH_SETS][2];
+static ULONG glyph2_row[GLYPH_SETS][256][2];
+static ULONG glyph4_key[GLYPH_SETS][3];
+static ULONG glyph4_row[GLYPH_SETS][2][256][2];    /* [inverse video (PF3 for PF2)][font byte] */
+static ULONG glyph6_key[GLYPH_SETS][3];
+static ULONG glyph6_row[GLYPH_SETS][4][16][2];     /* [colour - top two bits of the character][nibble] */
+static int glyph2_next;
+static int glyph4_next;
+static int glyph6_next;
+static ULONG nibble_e[16];                          /* modes E and F - see nibbles_e() */
+static ULONG nibble_e_key[2];
+static ULONG nibble_f[16];
+static ULONG nibble_f_key[2];
+
+ULONG antic_glyph_rebuilds = 0;
+UBYTE antic_glyph_cache = TRUE;
+
+void ANTIC_ResetGlyphCache(void)
+{
+    int i;
+    for (i = 0; i < GLYPH_SETS; i++)
+        glyph2_key[i][1] = glyph4_key[i][2] = glyph6_key[i][2] = GLYPH_NO_KEY;
+    nibble_e_key[1] = nibble_f_key[1] = GLYPH_NO_KEY;
+}
+
+#define GLYPH_PAIR(lo, hi)  ((ULONG) (lo) | ((ULONG) (hi) << 16))
+
+/* Two longs of pixels into the bitmap, which is only word aligned under odd HSCROL */
+#define DRAW_GLYPH(row) {\
+    if (((ULONG)ptr & 0x03) == 0) {\
+        WRITE_VIDEO_LONG((ULONG *) ptr, (row)[0]);\
+        WRITE_VIDEO_LONG((ULONG *) ptr + 1, (row)[1]);\
+    }\
+    else {\
+        WRITE_VIDEO(ptr, (UWORD) (row)[0]);\
+        WRITE_VIDEO(ptr + 1, (UWORD) ((row)[0] >> 16));\
+        WRITE_VIDEO(ptr + 2, (UWORD) (row)[1]);\
+        WRITE_VIDEO(ptr + 3, (UWORD) ((row)[1] >> 16));\
+    }\
+    ptr += 4;\
+}
+
+/* The characters of a line that no player or missile reaches need neither
+   the PM test nor the collision work per byte. pm_span_chars() works out how
+   many of the nchars from t_pm_scanline_ptr on lie before the PM span - all of
+   them when pm_dirty is clear, as new_pm_scanline() found nothing to draw - and
+   how many after it; only those in between go through the per byte loop. */
+static inline int pm_span_chars(int nchars, const ULONG *t_pm_scanline_ptr, int *trail)
+{
+    int base = (const UBYTE *) t_pm_scanline_ptr - pm_scanline;
+    int lead;
+    int end;
+
+    if (!pm_dirty || pm_span_lo >= pm_span_hi) {
+        *trail = 0;
+        return nchars;
+    }
+    lead = (pm_span_lo - base) >> 2;
+    end = (pm_span_hi - base + 3) >> 2;
+    if (lead < 0)
+        lead = 0;
+    else if (lead > nchars)
+        lead = nchars;
+    if (end < lead)
+        end = lead;
+    else if (end > nchars)
+        end = nchars;
+    *trail = nchars - end;
+    return lead;
+}
+
+/* Draw a run of n PM-free characters straight from a row table, two long
+   stores per byte when the bitmap is long aligned. 'row' is the table entry
+   for the byte in screendata. */
+#define DRAW_GLYPH_RUN(n, row) if (n) {\
+    int run = (n);\
+    if (((ULONG)ptr & 0x03) == 0) {\
+        ULONG *lptr = (ULONG *) ptr;\
+        do {\
+            UBYTE screendata = *ANTIC_memptr++;\
+            const ULONG *glyph_row = (row);\
+            WRITE_VIDEO_LONG(lptr, glyph_row[0]);\
+            WRITE_VIDEO_LONG(lptr + 1, glyph_row[1]);\
+            lptr += 2;\
+        } while (--run);\
+        ptr = (UWORD *) lptr;\
+    }\
+    else {\
+        do {\
+            UBYTE screendata = *ANTIC_memptr++;\
+            DRAW_GLYPH(row)\
+        } while (--run);\
+    }\
+}
+
+/* Modes E and F go through a table of the four pixels each nibble makes
+   instead - only 16 longs, so one set is enough: rebuilding it for colours
+   a DLI changes on every line costs less than the line itself. Mode E, after
+   draw_antic_e has set up lookup2 for the current colours: */
+static const ULONG *nibbles_e(void)
+{
+    ULONG k0 = GLYPH_PAIR(cl_lookup[C_BAK], cl_lookup[C_PF0]);
+    ULONG k1 = GLYPH_PAIR(cl_lookup[C_PF1], cl_lookup[C_PF2]);
+    int n;
+
+    if (nibble_e_key[0] != k0 || nibble_e_key[1] != k1) {
+        nibble_e_key[0] = k0;
+        nibble_e_key[1] = k1;
+        for (n = 0; n < 16; n++)
+            nibble_e[n] = GLYPH_PAIR(lookup2[(n << 4) & 0xc0], lookup2[(n << 4) & 0x30]);
+    }
+    return nibble_e;
+}
+
+/* Mode F, after INIT_HIRES */
+static const ULONG *nibbles_f(void)
+{
+    ULONG k0 = GLYPH_PAIR(cl_lookup[C_PF2], hires_lum(0x40));
+    ULONG k1 = GLYPH_PAIR(hires_lum(0x80), hires_lum(0xc0));
+    int n;
+
+    if (nibble_f_key[0] != k0 || nibble_f_key[1] != k1) {
+        nibble_f_key[0] = k0;
+        nibble_f_key[1] = k1;
+        for (n = 0; n < 16; n++)
+            nibble_f[n] = GLYPH_PAIR(hires_norm((n << 4) & 0xc0), hires_norm((n << 4) & 0x30));
+    }
+    return nibble_f;
+}
+
+#define DRAW_NIBBLES(nibble) {\
+    if (((ULONG)ptr & 0x03) == 0) {\
+        WRITE_VIDEO_LONG((ULONG *) ptr, (nibble)[screendata >> 4]);\
+        WRITE_VIDEO_LONG((ULONG *) ptr + 1, (nibble)[screendata & 0xf]);\
+    }\
+    else {\
+        WRITE_VIDEO(ptr, (UWORD) (nibble)[screendata >> 4]);\
+        WRITE_VIDEO(ptr + 1, (UWORD) ((nibble)[screendata >> 4] >> 16));\
+        WRITE_VIDEO(ptr + 2, (UWORD) (nibble)[screendata & 0xf]);\
+        WRITE_VIDEO(ptr + 3, (UWORD) ((nibble)[screendata & 0xf] >> 16));\
+    }\
+    ptr += 4;\
+}
+
+#define DRAW_NIBBLE_RUN(n, nibble) if (n) {\
+    int run = (n);\
+    if (((ULONG)ptr & 0x03) == 0) {\
+        ULONG *lptr = (ULONG *) ptr;\
+        do {\
+            UBYTE screendata = *ANTIC_memptr++;\
+            WRITE_VIDEO_LONG(lptr, (nibble)[screendata >> 4]);\
+            WRITE_VIDEO_LONG(lptr + 1, (nibble)[screendata & 0xf]);\
+            lptr += 2;\
+        } while (--run);\
+        ptr = (UWORD *) lptr;\
+    }\
+    else {\
+        do {\
+            UBYTE screendata = *ANTIC_memptr++;\
+            DRAW_NIBBLES(nibble)\
+        } while (--run);\
+    }\
+}
+
+/* Mode 2 and 3 - hires, after INIT_HIRES has set up hires_norm() for the current colours */
+static ULONG (*glyph_rows_2(void))[2]
+{
+    ULONG k0 = GLYPH_PAIR(cl_lookup[C_PF2], hires_lum(0x40));
+    ULONG k1 = GLYPH_PAIR(hires_lum(0x80), hires_lum(0xc0));
+    int set;
+    int c;
+
+    for (set = 0; set < GLYPH_SETS; set++)
+        if (glyph2_key[set][0] == k0 && glyph2_key[set][1] == k1)
+            return glyph2_row[set];
+
+    set = glyph2_next++ & (GLYPH_SETS - 1);
+    glyph2_key[set][0] = k0;
+    glyph2_key[set][1] = k1;
+    for (c = 0; c < 256; c++) {
+        glyph2_row[set][c][0] = GLYPH_PAIR(hires_norm(c & 0xc0), hires_norm(c & 0x30));
+        glyph2_row[set][c][1] = GLYPH_PAIR(hires_norm(c & 0x0c), hires_norm((c & 0x03) << 2));
+    }
+    antic_glyph_rebuilds++;
+    return glyph2_row[set];
+}
+
+/* Mode 4 and 5 - four colour characters, PF3 in place of PF2 for inverse video */
+static ULONG (*glyph_rows_4(void))[256][2]
+{
+    ULONG k0 = GLYPH_PAIR(cl_lookup[C_BAK], cl_lookup[C_PF0]);
+    ULONG k1 = GLYPH_PAIR(cl_lookup[C_PF1], cl_lookup[C_PF2]);
+    ULONG k2 = cl_lookup[C_PF3];
+    UWORD colour[2][4];
+    int set;
+    int inv;
+    int c;
+
+    for (set = 0; set < GLYPH_SETS; set++)
+        if (glyph4_key[set][0] == k0 && glyph4_key[set][1] == k1 && glyph4_key[set][2] == k2)
+            return glyph4_row[set];
+
+    set = glyph4_next++ & (GLYPH_SETS - 1);
+    glyph4_key[set][0] = k0;
+    glyph4_key[set][1] = k1;
+    glyph4_key[set][2] = k2;
+    colour[0][0] = colour[1][0] = cl_lookup[C_BAK];
+    colour[0][1] = colour[1][1] = cl_lookup[C_PF0];
+    colour[0][2] = colour[1][2] = cl_lookup[C_PF1];
+    colour[0][3] = cl_lookup[C_PF2];
+    colour[1][3] = cl_lookup[C_PF3];
+    for (inv = 0; inv < 2; inv++)
+        for (c = 0; c < 256; c++) {
+            glyph4_row[set][inv][c][0] = GLYPH_PAIR(colour[inv][c >> 6], colour[inv][(c >> 4) & 3]);
+            glyph4_row[set][inv][c][1] = GLYPH_PAIR(colour[inv][(c >> 2) & 3], colour[inv][c & 3]);
+        }
+    antic_glyph_rebuilds++;
+    return glyph4_row[set];
+}
+
+/* Mode 6 and 7 - one colour per character, each font bit a double width pixel */
+static ULONG (*glyph_rows_6(void))[16][2]
+{
+    ULONG k0 = GLYPH_PAIR(cl_lookup[C_BAK], cl_lookup[C_PF0]);
+    ULONG k1 = GLYPH_PAIR(cl_lookup[C_PF1], cl_lookup[C_PF2]);
+    ULONG k2 = cl_lookup[C_PF3];
+    int set;
+    int col;
+    int n;
+
+    for (set = 0; set < GLYPH_SETS; set++)
+        if (glyph6_key[set][0] == k0 && glyph6_key[set][1] == k1 && glyph6_key[set][2] == k2)
+            return glyph6_row[set];
+
+    set = glyph6_next++ & (GLYPH_SETS - 1);
+    glyph6_key[set][0] = k0;
+    glyph6_key[set][1] = k1;
+    glyph6_key[set][2] = k2;
+    for (col = 0; col < 4; col++) {
+        UWORD fg = COLOUR((playfield_lookup + 0x40)[col << 6]);
+        UWORD bg = cl_lookup[C_BAK];
+        for (n = 0; n < 16; n++) {
+            glyph6_row[set][col][n][0] = GLYPH_PAIR(n & 8 ? fg : bg, n & 4 ? fg : bg);
+            glyph6_row[set][col][n][1] = GLYPH_PAIR(n & 2 ? fg : bg, n & 1 ? fg : bg);
+        }
+    }
+    antic_glyph_rebuilds++;
+    return glyph6_row[set];
+}
+
+/* The row for the byte in screendata, as GET_CHDATA_ANTIC_2 would make it */
+#define GLYPH_ANTIC_2   glyph[((screendata & invert_mask) ? 0xff : 0) ^ (blank_lookup[screendata & blank_mask] ? chptr[(screendata & 0x7f) << 3] : 0)]
+
 static void draw_antic_2(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
     INIT_BACKGROUND_6
     INIT_ANTIC_2
     INIT_HIRES
+    ULONG (*glyph)[2] = antic_glyph_cache ? glyph_rows_2() : NULL;
+    int trail = 0;
+
+    if (glyph) {
+        int lead = pm_span_chars(nchars, t_pm_scanline_ptr, &trail);
+        DRAW_GLYPH_RUN(lead, GLYPH_ANTIC_2)
+        t_pm_scanline_ptr += lead;
+        nchars -= lead + trail;
+    }
 
+    if (nchars)
     CHAR_LOOP_BEGIN
         UBYTE screendata = *ANTIC_memptr++;
         int chdata;
 
         GET_CHDATA_ANTIC_2
         if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
-            if (chdata) {
+            if (glyph)
+                DRAW_GLYPH(glyph[chdata])
+            else if (chdata) {
                 WRITE_VIDEO(ptr++, hires_norm(chdata & 0xc0));
                 WRITE_VIDEO(ptr++, hires_norm(chdata & 0x30));
                 WRITE_VIDEO(ptr++, hires_norm(chdata & 0x0c));
@@ -1131,6 +1420,7 @@ static void draw_antic_2(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, cons
             DO_PMG_HIRES(chdata)
         t_pm_scanline_ptr++;
     CHAR_LOOP_END
+    DRAW_GLYPH_RUN(trail, GLYPH_ANTIC_2)
     do_border();
 }
 
@@ -1166,11 +1456,7 @@ static void draw_antic_2_artif(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr
 static void prepare_an_antic_2(int nchars, const UBYTE *ANTIC_memptr, const ULONG *t_pm_scanline_ptr)
 {
     UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - pm_scanline);
-    const UBYTE *chptr;
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)
-        chptr = antic_xe_ptr + ((dctr ^ chbase_20) & 0x3c07);
-    else
-        chptr = AnticMainMemLookup(((dctr ^ chbase_20) & 0xfc07));
+    const UBYTE *chptr = font_ptr;
 
     CHAR_LOOP_BEGIN
         UBYTE screendata = *ANTIC_memptr++;
@@ -1321,11 +1607,7 @@ static void draw_antic_2_gtia11(int nchars, const UBYTE *ANTIC_memptr, UWORD *pt
 ITCM_CODE static void draw_antic_4(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
     INIT_BACKGROUND_8
-    const UBYTE *chptr;
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)
-        chptr = antic_xe_ptr + (((anticmode == 4 ? dctr : dctr >> 1) ^ chbase_20) & 0x3c07);
-    else
-        chptr = AnticMainMemLookup((((anticmode == 4 ? dctr : dctr >> 1) ^ chbase_20) & 0xfc07));
+    const UBYTE *chptr = font_ptr;
 
     ADD_FONT_CYCLES;
     lookup2[0x0f] = lookup2[0x00] = cl_lookup[C_BAK];
@@ -1335,7 +1617,17 @@ ITCM_CODE static void draw_antic_4(int nchars, const UBYTE *ANTIC_memptr, UWORD
     lookup2[0x80] = lookup2[0x20] = lookup2[0x08] = lookup2[0x02] = cl_lookup[C_PF1];
     lookup2[0xc0] = lookup2[0x30] = lookup2[0x0c] = lookup2[0x03] = cl_lookup[C_PF2];
     lookup2[0xcf] = lookup2[0x3f] = lookup2[0x1b] = lookup2[0x12] = cl_lookup[C_PF3];
+    ULONG (*glyph)[256][2] = antic_glyph_cache ? glyph_rows_4() : NULL;
+    int trail = 0;
+
+    if (glyph) {
+        int lead = pm_span_chars(nchars, t_pm_scanline_ptr, &trail);
+        DRAW_GLYPH_RUN(lead, glyph[screendata >> 7][chptr[(screendata & 0x7f) << 3]])
+        t_pm_scanline_ptr += lead;
+        nchars -= lead + trail;
+    }
 
+    if (nchars)
     CHAR_LOOP_BEGIN
         UBYTE screendata = *ANTIC_memptr++;
         const UWORD *lookup;
@@ -1346,7 +1638,9 @@ ITCM_CODE static void draw_antic_4(int nchars, const UBYTE *ANTIC_memptr, UWORD
             lookup = lookup2;
         chdata = chptr[(screendata & 0x7f) << 3];
         if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
-            if (chdata) {
+            if (glyph)
+                DRAW_GLYPH(glyph[screendata >> 7][chdata])
+            else if (chdata) {
                 WRITE_VIDEO(ptr++, lookup[chdata & 0xc0]);
                 WRITE_VIDEO(ptr++, lookup[chdata & 0x30]);
                 WRITE_VIDEO(ptr++, lookup[chdata & 0x0c]);
@@ -1370,17 +1664,14 @@ ITCM_CODE static void draw_antic_4(int nchars, const UBYTE *ANTIC_memptr, UWORD
         t_pm_scanline_ptr++;
     CHAR_LOOP_END
     playfield_lookup[0xc0] = L_PF2;
+    DRAW_GLYPH_RUN(trail, glyph[screendata >> 7][chptr[(screendata & 0x7f) << 3]])
     do_border();
 }
 
 static void prepare_an_antic_4(int nchars, const UBYTE *ANTIC_memptr, const ULONG *t_pm_scanline_ptr)
 {
     UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - pm_scanline);
-    const UBYTE *chptr;
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)
-        chptr = antic_xe_ptr + (((anticmode == 4 ? dctr : dctr >> 1) ^ chbase_20) & 0x3c07);
-    else
-        chptr = AnticMainMemLookup((((anticmode == 4 ? dctr : dctr >> 1) ^ chbase_20) & 0xfc07));
+    const UBYTE *chptr = font_ptr;
 
     ADD_FONT_CYCLES;
     CHAR_LOOP_BEGIN
@@ -1403,11 +1694,8 @@ DEFINE_DRAW_AN(4)
 
 ITCM_CODE static void draw_antic_6(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
-    const UBYTE *chptr;
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)
-        chptr = antic_xe_ptr + (((anticmode == 6 ? dctr & 7 : dctr >> 1) ^ chbase_20) - 0x4000);
-    else
-        chptr = AnticMainMemLookup(((anticmode == 6 ? dctr & 7 : dctr >> 1) ^ chbase_20));
+    const UBYTE *chptr = font_ptr;
+    ULONG (*glyph)[16][2] = antic_glyph_cache ? glyph_rows_6() : NULL;
 
     ADD_FONT_CYCLES;
     CHAR_LOOP_BEGIN
@@ -1419,7 +1707,9 @@ ITCM_CODE static void draw_antic_6(int nchars, const UBYTE *ANTIC_memptr, UWORD
         chdata = chptr[(screendata & 0x3f) << 3];
         do {
             if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
-                if (chdata & 0xf0) {
+                if (glyph)
+                    DRAW_GLYPH(glyph[screendata >> 6][chdata >> 4])
+                else if (chdata & 0xf0) {
                     if (chdata & 0x80) {
                         WRITE_VIDEO(ptr++, colour);
                     }
@@ -1475,11 +1765,7 @@ ITCM_CODE static void draw_antic_6(int nchars, const UBYTE *ANTIC_memptr, UWORD
 static void prepare_an_antic_6(int nchars, const UBYTE *ANTIC_memptr, const ULONG *t_pm_scanline_ptr)
 {
     UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - pm_scanline);
-    const UBYTE *chptr;
-    if (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000)
-        chptr = antic_xe_ptr + (((anticmode == 6 ? dctr & 7 : dctr >> 1) ^ chbase_20) - 0x4000);
-    else
-        chptr = AnticMainMemLookup(((anticmode == 6 ? dctr & 7 : dctr >> 1) ^ chbase_20));
+    const UBYTE *chptr = font_ptr;
 
     ADD_FONT_CYCLES;
     CHAR_LOOP_BEGIN
@@ -1702,11 +1988,23 @@ static void draw_antic_e(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, cons
     lookup2[0x40] = lookup2[0x10] = lookup2[0x04] = lookup2[0x01] = cl_lookup[C_PF0];
     lookup2[0x80] = lookup2[0x20] = lookup2[0x08] = lookup2[0x02] = cl_lookup[C_PF1];
     lookup2[0xc0] = lookup2[0x30] = lookup2[0x0c] = lookup2[0x03] = cl_lookup[C_PF2];
+    const ULONG *nibble = antic_glyph_cache ? nibbles_e() : NULL;
+    int trail = 0;
+
+    if (nibble) {
+        int lead = pm_span_chars(nchars, t_pm_scanline_ptr, &trail);
+        DRAW_NIBBLE_RUN(lead, nibble)
+        t_pm_scanline_ptr += lead;
+        nchars -= lead + trail;
+    }
 
+    if (nchars)
     CHAR_LOOP_BEGIN
         UBYTE screendata = *ANTIC_memptr++;
         if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
-            if (screendata) {
+            if (nibble)
+                DRAW_NIBBLES(nibble)
+            else if (screendata) {
                 WRITE_VIDEO(ptr++, lookup2[screendata & 0xc0]);
                 WRITE_VIDEO(ptr++, lookup2[screendata & 0x30]);
                 WRITE_VIDEO(ptr++, lookup2[screendata & 0x0c]);
@@ -1729,6 +2027,7 @@ static void draw_antic_e(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, cons
         }
         t_pm_scanline_ptr++;
     CHAR_LOOP_END
+    DRAW_NIBBLE_RUN(trail, nibble)
     do_border();
 }
 
@@ -1806,11 +2105,23 @@ static void draw_antic_f(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, cons
 {
     INIT_BACKGROUND_6
     INIT_HIRES
+    const ULONG *nibble = antic_glyph_cache ? nibbles_f() : NULL;
+    int trail = 0;
+
+    if (nibble) {
+        int lead = pm_span_chars(nchars, t_pm_scanline_ptr, &trail);
+        DRAW_NIBBLE_RUN(lead, nibble)
+        t_pm_scanline_ptr += lead;
+        nchars -= lead + trail;
+    }
 
+    if (nchars)
     CHAR_LOOP_BEGIN
         int screendata = *ANTIC_memptr++;
         if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
-            if (screendata) {
+            if (nibble)
+                DRAW_NIBBLES(nibble)
+            else if (screendata) {
                 WRITE_VIDEO(ptr++, hires_norm(screendata & 0xc0));
                 WRITE_VIDEO(ptr++, hires_norm(screendata & 0x30));
                 WRITE_VIDEO(ptr++, hires_norm(screendata & 0x0c));
@@ -1823,6 +2134,7 @@ static void draw_antic_f(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, cons
             DO_PMG_HIRES(screendata)
         t_pm_scanline_ptr++;
     CHAR_LOOP_END
+    DRAW_NIBBLE_RUN(trail, nibble)
     do_border();
 }
 
@@ -2127,6 +2439,8 @@ void ANTIC_UpdateArtifacting(void)
     UBYTE q;
     UBYTE art_white;
 
+    ANTIC_InvalidateLines();
+
     if (myConfig.artifacting == 0) {
         draw_antic_table[0][2] = draw_antic_table[0][3] = draw_antic_2;
         draw_antic_table[0][0xf] = draw_antic_f;
@@ -2258,6 +2572,217 @@ static void ANTIC_load(void)
     }
 }
 
+/* Display list plan -------------------------------------------------------- */
+
+/* ANTIC_Frame writes down what it made of the display list as it walks it: one
+   entry per instruction with where it was, the instruction and its LMS or JMP
+   address, where DLIST went after it, the scanline it started on and how many
+   it ran for. The next frame follows that plan for as long as the list reads
+   the same. Nothing is taken on trust - the CPU and DLIs can rewrite the list
+   or DLISTL/H at any point in the frame - so each entry is checked against the
+   bytes at DLIST when ANTIC gets to it, and the first one that differs sends
+   the rest of the frame back to fetching and decoding as it goes. Tools get the
+   last complete plan from ANTIC_GetDListPlan(). */
+
+static antic_dl_plan_t dl_plan[2];
+static antic_dl_plan_t *dl_plan_ptr __attribute__((section(".dtcm"))) = &dl_plan[0];    /* being built */
+static antic_dl_entry_t *dl_entry __attribute__((section(".dtcm")));                  /* last entry added */
+static const antic_dl_entry_t *dl_follow __attribute__((section(".dtcm")));           /* next entry of the last plan - NULL once off it */
+static const antic_dl_entry_t *dl_follow_end __attribute__((section(".dtcm")));
+
+UBYTE antic_dl_plan __attribute__((section(".dtcm"))) = TRUE;
+ULONG antic_dl_followed __attribute__((section(".dtcm"))) = 0;
+ULONG antic_dl_decoded __attribute__((section(".dtcm"))) = 0;
+
+/* The plan of the last complete frame */
+const antic_dl_plan_t *ANTIC_GetDListPlan(void)
+{
+    return (dl_plan_ptr == &dl_plan[0]) ? &dl_plan[1] : &dl_plan[0];
+}
+
+static inline void dl_plan_begin(void)
+{
+    const antic_dl_plan_t *last = ANTIC_GetDListPlan();
+
+    dl_plan_ptr->start = dlist;
+    dl_plan_ptr->count = 0;
+    dl_entry = NULL;
+    dl_follow = (antic_dl_plan && last->start == dlist) ? last->entry : NULL;
+    dl_follow_end = last->entry + last->count;
+}
+
+/* Returns the entry of the last frame's plan if the instruction at DLIST (and
+   its address, if it has one) is the one it expects next, else NULL */
+static inline const antic_dl_entry_t *dl_plan_follow(void)
+{
+    const antic_dl_entry_t *e = dl_follow;
+    UWORD addr = dlist;
+
+    if (e == NULL)
+        return NULL;
+    /* GRAFP3 picks up the address bytes as they are fetched with player flickering */
+    if (e < dl_follow_end && e->addr == addr && !player_flickering && ANTIC_GetDLByte(&addr) == e->ir
+     && (e->dl_cycles == 1 || ANTIC_GetDLWord(&addr) == e->operand)) {
+        dl_follow = e + 1;
+        return e;
+    }
+    dl_follow = NULL;
+    return NULL;
+}
+
+/* Called with IR just fetched from addr, followed is the plan entry it matched */
+static inline void dl_plan_add(UWORD addr, const antic_dl_entry_t *followed)
+{
+    if (dl_entry != NULL)
+        dl_entry->lines = ypos - dl_entry->ypos;
+    if (dl_plan_ptr->count == ANTIC_DL_MAX) {
+        dl_entry = NULL;
+        return;
+    }
+    dl_entry = &dl_plan_ptr->entry[dl_plan_ptr->count++];
+    if (followed != NULL) {
+        *dl_entry = *followed;
+        antic_dl_followed++;
+    }
+    else {
+        dl_entry->addr = addr;
+        dl_entry->next = dlist;
+        dl_entry->operand = 0;
+        dl_entry->ir = IR;
+        dl_entry->dl_cycles = 1;
+        antic_dl_decoded++;
+    }
+    dl_entry->ypos = ypos;
+}
+
+/* The LMS or JMP/JVB address just fetched for the instruction last added */
+static inline UWORD dl_plan_operand(UWORD operand)
+{
+    if (dl_entry != NULL) {
+        dl_entry->operand = operand;
+        dl_entry->next = ((dl_entry->ir & 0x0f) == 1) ? operand : dlist;
+        dl_entry->dl_cycles = 3;
+    }
+    return operand;
+}
+
+static inline void dl_plan_end(void)
+{
+    if (dl_entry != NULL)
+        dl_entry->lines = ATARI_HEIGHT + 8 - dl_entry->ypos;
+    dl_plan_ptr = (dl_plan_ptr == &dl_plan[0]) ? &dl_plan[1] : &dl_plan[0];
+}
+
+/* Dirty scanlines ---------------------------------------------------------- */
+
+/* Most of the screen is the same from one frame to the next, so each drawn
+   line leaves a signature of everything its draw routine looks at: the routine
+   itself, the colour registers and PRIOR, the mode and width parameters, the
+   bytes ANTIC fetched and - in the character modes - the font row they point
+   at. If the next frame comes up with the same signature for the same line of
+   the same buffer, what is already in the bitmap is what would be drawn and the
+   draw is skipped. Lines with players or missiles on them are always drawn as
+   the draw routines are also where the collisions get worked out. A signature
+   of 0 is never produced, so 0 marks a line that has to be drawn. */
+
+/* FNV-1a a word at a time. The multiply only carries differences upwards, so a
+   change in the top bits of two words could cancel out - and leave a changed line
+   undrawn - unless the top half is folded back down after every step. */
+static inline ULONG sig_mix(ULONG h, ULONG v)
+{
+    h = (h ^ v) * 0x01000193;
+    return h ^ (h >> 16);
+}
+
+#define SIG(h, v)   sig_mix((h), (ULONG) (v))
+
+static ULONG line_sig[2][ATARI_HEIGHT];
+static ULONG *line_sig_ptr __attribute__((section(".dtcm")));
+
+ULONG antic_lines_drawn __attribute__((section(".dtcm"))) = 0;
+ULONG antic_lines_skipped __attribute__((section(".dtcm"))) = 0;
+UBYTE antic_skip_unchanged __attribute__((section(".dtcm"))) = TRUE;
+
+void ANTIC_InvalidateLines(void)
+{
+    memset(line_sig, 0x00, sizeof(line_sig));
+}
+
+/* The font row the character mode draw routines read this line from - ANTIC_Frame
+   puts it in font_ptr before each line in modes 2 to 7 */
+static const UBYTE *line_font(void)
+{
+    int row = (anticmode <= 4) ? dctr : (anticmode == 6) ? (dctr & 7) : (dctr >> 1);
+    int xe = (antic_xe_ptr != NULL && chbase_20 < 0x8000 && chbase_20 >= 0x4000);
+    if (anticmode <= 5)
+        return xe ? antic_xe_ptr + ((row ^ chbase_20) & 0x3c07) : AnticMainMemLookup((row ^ chbase_20) & 0xfc07);
+    return xe ? antic_xe_ptr + ((row ^ chbase_20) - 0x4000) : AnticMainMemLookup(row ^ chbase_20);
+}
+
+/* Which characters of the font row the draw routine indexes with */
+static inline int font_mask(void)
+{
+    return (anticmode >= 6 || (anticmode >= 4 && PRIOR >= 0x40)) ? 0x3f : 0x7f;
+}
+
+/* Returns TRUE if the line has to be drawn (and remembers its signature) */
+ITCM_CODE static int line_changed(int playfield)
+{
+    ULONG *sig = &line_sig_ptr[ypos - 8];
+    ULONG h = 0x811c9dc5;
+
+    if (pm_dirty || !antic_skip_unchanged || (playfield && draw_antic_ptr == draw_antic_f_gtia_bug)) {
+        *sig = 0;
+        antic_lines_drawn++;
+        return TRUE;
+    }
+
+    h = SIG(h, (uintptr_t) (playfield ? (void *) draw_antic_ptr : (void *) draw_antic_0_ptr));
+    h = SIG(h, COLBK | (COLPF0 << 8) | (COLPF1 << 16) | (COLPF2 << 24));
+    h = SIG(h, COLPF3 | (PRIOR << 8) | (COLPM0 << 16) | (COLPM1 << 24));
+    h = SIG(h, COLPM2 | (COLPM3 << 8));
+
+    if (playfield) {
+        /* Whole words of ANTIC_memory (it is a multiple of 4 long), taking in
+           the bytes either side that the artifacting routines look at */
+        int first = (ANTIC_margin + ch_offset[md] - 2) & ~3;
+        int last = ANTIC_margin + ch_offset[md] + chars_displayed[md] + 1;
+        const UBYTE *p;
+        if (first < 0)
+            first = 0;
+        if (last > (int) sizeof(ANTIC_memory))
+            last = sizeof(ANTIC_memory);
+
+        h = SIG(h, anticmode | (md << 4) | (dctr << 8) | (invert_mask << 16) | (blank_mask << 24));
+        h = SIG(h, chbase_20 | (x_min[md] << 16) | (left_border_chars << 24));
+        h = SIG(h, chars_displayed[md] | (ch_offset[md] << 8) | (right_border_start << 16));
+
+        if (anticmode <= 7) {
+            const UBYTE *chptr = font_ptr;
+            int mask = font_mask();
+            for (p = ANTIC_memory + first; p < ANTIC_memory + last; p += 4) {
+                h = SIG(h, p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+                h = SIG(h, chptr[(p[0] & mask) << 3] | (chptr[(p[1] & mask) << 3] << 8) |
+                          (chptr[(p[2] & mask) << 3] << 16) | (chptr[(p[3] & mask) << 3] << 24));
+            }
+        }
+        else {
+            for (p = ANTIC_memory + first; p < ANTIC_memory + last; p += 4)
+                h = SIG(h, p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
+        }
+    }
+
+    if (h == 0)
+        h = 1;
+    if (*sig == h) {
+        antic_lines_skipped++;
+        return FALSE;
+    }
+    *sig = h;
+    antic_lines_drawn++;
+    return TRUE;
+}
+
 UBYTE mode_type[32] __attribute__((section(".dtcm"))) = {
         NORMAL0, NORMAL0, NORMAL0, NORMAL0, NORMAL0, NORMAL0, NORMAL1, NORMAL1,
         NORMAL2, NORMAL2, NORMAL1, NORMAL1, NORMAL1, NORMAL0, NORMAL0, NORMAL0,
@@ -2278,159 +2803,283 @@ __attribute__((noinline)) void ANTIC_FrameSetup()
     if (myConfig.alphaBlend)
     {
         scrn_ptr = bgGetGfxPtr((gTotalAtariFrames&1) ? bg2:bg3);
+        line_sig_ptr = line_sig[gTotalAtariFrames&1];
     }
     else
     {
         scrn_ptr = bgGetGfxPtr(bg2);
+        line_sig_ptr = line_sig[1];
     }
 
     need_dl = TRUE;
 }
 
-/* This function emulates one frame drawing screen at atari_screen */
-ITCM_CODE void ANTIC_Frame(int draw_display) 
+/* Visible scanlines ------------------------------------------------------- */
+
+/* Each visible line runs in three stages with the CPU going in between:
+   line_start() (DL fetch, DLI, refresh cycles), the CPU up to SCR_C,
+   line_screen() (PM and playfield DMA, draw), the CPU up to LINE_C and
+   line_end(). Only line_start() may need the CPU to run within it - to VSCON_C
+   when vertical scrolling starts and to NMIST_C/NMI_C for a DLI.
+
+   Rather than return to ANTIC_Frame() at every SCR_C and LINE_C, GO() calls
+   ANTIC_SliceNext() when it gets to xpos_limit. That runs the stage that is due
+   and calls CPU_Go_Startup() for the next limit, just as a new GO() would, so
+   the CPU carries on through the stages and lines in one call. xpos_limit and
+   the WSYNC handling are the same as line by line. The slice stops, and GO()
+   returns, at the end of the display or before the start of a line that would
+   need the CPU: one that starts vertical scrolling or may raise a DLI. */
+
+#define LINE_START  0
+#define LINE_SCREEN 1
+#define LINE_END    2
+
+static UBYTE line_stage __attribute__((section(".dtcm")));      /* the next stage due */
+static UBYTE line_blank __attribute__((section(".dtcm")));      /* no playfield on this line */
+static UBYTE line_draw __attribute__((section(".dtcm")));       /* draw_display of this frame */
+static UBYTE vscrol_flag __attribute__((section(".dtcm")));
+static UBYTE no_jvb __attribute__((section(".dtcm")));
+static UBYTE need_load __attribute__((section(".dtcm")));
+
+UBYTE antic_slice __attribute__((section(".dtcm"))) = TRUE;
+UBYTE antic_slicing __attribute__((section(".dtcm"))) = FALSE;   /* GO() may call ANTIC_SliceNext() */
+ULONG antic_slice_lines __attribute__((section(".dtcm"))) = 0;  /* lines started inside GO() */
+ULONG antic_slice_stops __attribute__((section(".dtcm"))) = 0;  /* and from ANTIC_Frame() */
+
+static void line_start(void)
 {
-    UBYTE vscrol_flag = FALSE;
-    UBYTE no_jvb = TRUE;
-    UBYTE need_load;
+    const antic_dl_entry_t *planned;
 
-    ANTIC_FrameSetup();
-    
-    do {
-        POKEY_Scanline();       /* check and generate IRQ */
-        if (missile_or_player_dma_enabled) 
-        {
-            pmg_dma();
-        }
+    POKEY_Scanline();       /* check and generate IRQ */
+    if (missile_or_player_dma_enabled) 
+    {
+        pmg_dma();
+    }
 
-        need_load = FALSE;
-        if (need_dl) {
-            if (DMACTL & 0x20) {
-                IR = ANTIC_GetDLByte(&dlist);
-                anticmode = IR & 0xf;
-                xpos++;
-                /* PMG flickering :-) */
-                if (missile_flickering)
-                    GRAFM = ypos & 1 ? IR : ((GRAFM ^ IR) & hold_missiles_tab[VDELAY & 0xf]) ^ IR;
-                if (player_flickering) {
-                    UBYTE hold = ypos & 1 ? 0 : VDELAY;
-                    if ((hold & 0x10) == 0)
-                        GRAFP0 = dGetByte((UWORD) (regPC - xpos + 8));
-                    if ((hold & 0x20) == 0)
-                        GRAFP1 = dGetByte((UWORD) (regPC - xpos + 9));
-                    if ((hold & 0x40) == 0)
-                        GRAFP2 = dGetByte((UWORD) (regPC - xpos + 10));
-                    if ((hold & 0x80) == 0)
-                        GRAFP3 = dGetByte((UWORD) (regPC - xpos + 11));
-                }
+    need_load = FALSE;
+    planned = NULL;
+    if (need_dl) {
+        if (DMACTL & 0x20) {
+            UWORD dl_addr = dlist;
+            planned = dl_plan_follow();
+            if (planned != NULL) {
+                IR = planned->ir;
+                dlist = planned->next;
             }
             else
-                IR &= 0x7f; /* repeat last instruction, but don't generate DLI */
+                IR = ANTIC_GetDLByte(&dlist);
+            dl_plan_add(dl_addr, planned);
+            anticmode = IR & 0xf;
+            xpos++;
+            /* PMG flickering :-) */
+            if (missile_flickering)
+                GRAFM = ypos & 1 ? IR : ((GRAFM ^ IR) & hold_missiles_tab[VDELAY & 0xf]) ^ IR;
+            if (player_flickering) {
+                UBYTE hold = ypos & 1 ? 0 : VDELAY;
+                if ((hold & 0x10) == 0)
+                    GRAFP0 = dGetByte((UWORD) (regPC - xpos + 8));
+                if ((hold & 0x20) == 0)
+                    GRAFP1 = dGetByte((UWORD) (regPC - xpos + 9));
+                if ((hold & 0x40) == 0)
+                    GRAFP2 = dGetByte((UWORD) (regPC - xpos + 10));
+                if ((hold & 0x80) == 0)
+                    GRAFP3 = dGetByte((UWORD) (regPC - xpos + 11));
+            }
+        }
+        else
+            IR &= 0x7f; /* repeat last instruction, but don't generate DLI */
 
-            dctr = 0;
-            need_dl = FALSE;
-            vscrol_off = FALSE;
+        dctr = 0;
+        need_dl = FALSE;
+        vscrol_off = FALSE;
 
-            switch (anticmode) {
-            case 0x00:
-                lastline = (IR >> 4) & 7;
+        switch (anticmode) {
+        case 0x00:
+            lastline = (IR >> 4) & 7;
+            if (vscrol_flag) {
+                lastline = VSCROL;
+                vscrol_flag = FALSE;
+                vscrol_off = TRUE;
+            }
+            break;
+        case 0x01:
+            lastline = 0;
+            if (IR & 0x40 && DMACTL & 0x20) {
+                if (planned == NULL)
+                    dlist = dl_plan_operand(ANTIC_GetDLWord(&dlist));
+                xpos += 2;
+                no_jvb = FALSE;
+            }
+            else
                 if (vscrol_flag) {
                     lastline = VSCROL;
                     vscrol_flag = FALSE;
                     vscrol_off = TRUE;
                 }
-                break;
-            case 0x01:
-                lastline = 0;
-                if (IR & 0x40 && DMACTL & 0x20) {
-                    dlist = ANTIC_GetDLWord(&dlist);
-                    xpos += 2;
-                    no_jvb = FALSE;
-                }
-                else
-                    if (vscrol_flag) {
-                        lastline = VSCROL;
-                        vscrol_flag = FALSE;
-                        vscrol_off = TRUE;
-                    }
-                break;
-            default:
-                lastline = normal_lastline[anticmode];
-                if (IR & 0x20) {
-                    if (!vscrol_flag) {
-                        GO(VSCON_C);
-                        dctr = VSCROL;
-                        vscrol_flag = TRUE;
-                    }
-                }
-                else if (vscrol_flag) {
-                    lastline = VSCROL;
-                    vscrol_flag = FALSE;
-                    vscrol_off = TRUE;
-                }
-                if (IR & 0x40 && DMACTL & 0x20) {
-                    screenaddr = ANTIC_GetDLWord(&dlist);
-                    xpos += 2;
+            break;
+        default:
+            lastline = normal_lastline[anticmode];
+            if (IR & 0x20) {
+                if (!vscrol_flag) {
+                    GO(VSCON_C);
+                    dctr = VSCROL;
+                    vscrol_flag = TRUE;
                 }
-                md = mode_type[IR & 0x1f];
-                need_load = TRUE;
-                draw_antic_ptr = draw_antic_table[PRIOR >> 6][anticmode];
-                break;
             }
+            else if (vscrol_flag) {
+                lastline = VSCROL;
+                vscrol_flag = FALSE;
+                vscrol_off = TRUE;
+            }
+            if (IR & 0x40 && DMACTL & 0x20) {
+                screenaddr = (planned != NULL) ? planned->operand : dl_plan_operand(ANTIC_GetDLWord(&dlist));
+                xpos += 2;
+            }
+            md = mode_type[IR & 0x1f];
+            need_load = TRUE;
+            draw_antic_ptr = draw_antic_table[PRIOR >> 6][anticmode];
+            break;
         }
+    }
 
-        if ((IR & 0x4f) == 1 && (DMACTL & 0x20)) {
-            dlist = ANTIC_GetDLWord(&dlist);
-            xpos += 2;
-        }
+    if ((IR & 0x4f) == 1 && (DMACTL & 0x20)) {
+        if (planned == NULL)
+            dlist = dl_plan_operand(ANTIC_GetDLWord(&dlist));
+        xpos += 2;
+    }
 
-        if (dctr == lastline) {
-            if (no_jvb)
-                need_dl = TRUE;
-            if (IR & 0x80) {
-                GO(NMIST_C);
-                NMIST = 0x9f;
-                if (NMIEN & 0x80) {
-                    GO(NMI_C);
-                    NMI();
-                }
+    if (dctr == lastline) {
+        if (no_jvb)
+            need_dl = TRUE;
+        if (IR & 0x80) {
+            GO(NMIST_C);
+            NMIST = 0x9f;
+            if (NMIEN & 0x80) {
+                GO(NMI_C);
+                NMI();
             }
         }
+    }
 
-        if (need_load && anticmode <= 5 && DMACTL & 3)
-            xpos += before_cycles[md];
+    if (need_load && anticmode <= 5 && DMACTL & 3)
+        xpos += before_cycles[md];
+}
 
-        GO(SCR_C);
-        new_pm_scanline();
+/* Would line_start() run the CPU? It may say so of a line that will not, never
+   the other way round. A new instruction is taken to raise a DLI if it has the
+   bit, whichever line of it that falls on. */
+static inline int line_start_goes(void)
+{
+    if (need_dl) {
+        UBYTE ir = (DMACTL & 0x20) ? dGetByte(dlist) : IR & 0x7f;
+        UBYTE mode = (DMACTL & 0x20) ? ir & 0xf : anticmode;
+        if (ir & 0x80)
+            return TRUE;
+        return mode >= 2 && (ir & 0x20) && !vscrol_flag;
+    }
+    return dctr == lastline && (IR & 0x80);
+}
 
-        xpos += DMAR;
-        
-        if (anticmode < 2 || (DMACTL & 3) == 0) 
-        {
-            if (draw_display) draw_antic_0_ptr();
-            GOEOL;
-            scrn_ptr += 256;
-            if (no_jvb) {
-                dctr++;
-                dctr &= 0xf;
-            }
-            continue;
-        }
+static void line_screen(void)
+{
+    new_pm_scanline();
 
-        if (need_load) {
-            if (draw_display) ANTIC_load();
-            xpos += load_cycles[md];
-            if (anticmode <= 5) /* extra cycles in font modes */
-                xpos -= extra_cycles[md];
-        }
+    xpos += DMAR;
+    
+    line_blank = anticmode < 2 || (DMACTL & 3) == 0;
+    if (line_blank) 
+    {
+        if (line_draw && line_changed(FALSE)) draw_antic_0_ptr();
+        return;
+    }
 
-        if (draw_display) draw_antic_ptr(chars_displayed[md], ANTIC_memory + ANTIC_margin + ch_offset[md], scrn_ptr + x_min[md], (ULONG *) &pm_scanline[x_min[md]]);
+    if (need_load) {
+        if (line_draw) ANTIC_load();
+        xpos += load_cycles[md];
+        if (anticmode <= 5) /* extra cycles in font modes */
+            xpos -= extra_cycles[md];
+    }
 
-        GOEOL;
-        scrn_ptr += 256;
+    if (line_draw) {
+        if (anticmode <= 7)
+            font_ptr = line_font();
+        if (line_changed(TRUE))
+            draw_antic_ptr(chars_displayed[md], ANTIC_memory + ANTIC_margin + ch_offset[md], scrn_ptr + x_min[md], (ULONG *) &pm_scanline[x_min[md]]);
+        else if (anticmode <= 7)
+            ADD_FONT_CYCLES;    /* the character mode draws also account for the font fetches */
+    }
+}
+
+static void line_end(void)
+{
+    xpos -= LINE_C; screenline_cpu_clock += LINE_C; UPDATE_DMACTL ypos++;
+    scrn_ptr += 256;
+    if (no_jvb || !line_blank) {
         dctr++;
         dctr &= 0xf;
+    }
+}
+
+/* GO() got to xpos_limit on a visible line. Runs the stage due and returns
+   TRUE with the next limit set, or FALSE to have GO() return to ANTIC_Frame(). */
+ITCM_CODE int ANTIC_SliceNext(void)
+{
+    for (;;) {
+        if (line_stage == LINE_SCREEN) {
+            line_screen();
+            line_stage = LINE_END;
+            if (!CPU_Go_Startup(LINE_C))
+                return TRUE;
+        }
+        else {
+            line_end();
+            line_stage = LINE_START;
+            if (ypos >= ATARI_HEIGHT + 8 || line_start_goes()) {
+                antic_slicing = FALSE;
+                return FALSE;
+            }
+            line_start();
+            antic_slice_lines++;
+            line_stage = LINE_SCREEN;
+            if (!CPU_Go_Startup(SCR_C))
+                return TRUE;
+        }
+        /* CPU_Go_Startup() ended a WSYNC halt short of the limit - the stage is already due */
+    }
+}
+
+/* This function emulates one frame drawing screen at atari_screen */
+ITCM_CODE void ANTIC_Frame(int draw_display) 
+{
+    ANTIC_FrameSetup();
+    dl_plan_begin();
+
+    line_draw = draw_display;
+    vscrol_flag = FALSE;
+    no_jvb = TRUE;
+    line_stage = LINE_START;
+    do {
+        if (line_stage == LINE_START) {
+            line_start();
+            antic_slice_stops++;
+            line_stage = LINE_SCREEN;
+            antic_slicing = antic_slice;
+            GO(SCR_C);
+            antic_slicing = FALSE;
+        }
+        if (line_stage == LINE_SCREEN) {
+            line_screen();
+            line_stage = LINE_END;
+            antic_slicing = antic_slice;
+            GO(LINE_C);
+            antic_slicing = FALSE;
+        }
+        if (line_stage == LINE_END) {
+            line_end();
+            line_stage = LINE_START;
+        }
     } while (ypos < (ATARI_HEIGHT + 8));
+    dl_plan_end();
     
     POKEY_Scanline();       /* check and generate IRQ */
     GO(NMIST_C);
@@ -78,6 +78,25 @@
 typedef void (*draw_antic_function)(int nchars, const UBYTE *ANTIC_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr);
 typedef void (*draw_antic_0_function)(void);
 
+/* What ANTIC made of the display list in one frame - see ANTIC_GetDListPlan() */
+#define ANTIC_DL_MAX    ATARI_HEIGHT
+
+typedef struct {
+    UWORD addr;                 /* where the instruction was fetched from */
+    UWORD next;                 /* DLIST after it - past the address bytes, or the JMP/JVB target */
+    UWORD operand;              /* LMS screen address or JMP/JVB target, if any */
+    UWORD ypos;                 /* scanline it started on */
+    UBYTE ir;                   /* the instruction: DLI, LMS, VSCROL, HSCROL flags and mode */
+    UBYTE lines;                /* scanlines it ran for */
+    UBYTE dl_cycles;            /* display list DMA cycles - 1, or 3 with an address */
+} antic_dl_entry_t;
+
+typedef struct {
+    UWORD start;                /* DLIST when the visible part of the frame began */
+    UWORD count;
+    antic_dl_entry_t entry[ANTIC_DL_MAX];
+} antic_dl_plan_t;
+
 extern draw_antic_function draw_antic_ptr;
 extern void (*draw_antic_0_ptr)(void);
 
@@ -154,17 +173,37 @@ extern UWORD pmbase_s;
 extern UWORD pmbase_d;
 extern UBYTE pm_scanline[ATARI_WIDTH / 2 + 8];
 extern UBYTE pm_dirty;
+extern UWORD pm_span_lo;
+extern UWORD pm_span_hi;
+extern ULONG pm_span_lines;
+extern ULONG pm_span_bytes;
 extern const UBYTE *pm_lookup_ptr;
+extern ULONG antic_lines_drawn;
+extern ULONG antic_lines_skipped;
+extern UBYTE antic_skip_unchanged;
+extern ULONG antic_glyph_rebuilds;
+extern UBYTE antic_glyph_cache;
+extern UBYTE antic_dl_plan;
+extern ULONG antic_dl_followed;
+extern ULONG antic_dl_decoded;
+extern UBYTE antic_slice;
+extern UBYTE antic_slicing;
+extern ULONG antic_slice_lines;
+extern ULONG antic_slice_stops;
 
 
 void ANTIC_Initialise(void);
 void ANTIC_Reset(void);
 void ANTIC_Frame(int draw_display);
+int ANTIC_SliceNext(void);
 UBYTE ANTIC_GetByte(UWORD addr);
 void ANTIC_PutByte(UWORD addr, UBYTE byte);
 UBYTE ANTIC_GetDLByte(UWORD *paddr);
 UWORD ANTIC_GetDLWord(UWORD *paddr);
 void ANTIC_UpdateArtifacting(void);
+void ANTIC_InvalidateLines(void);
+void ANTIC_ResetGlyphCache(void);
+const antic_dl_plan_t *ANTIC_GetDListPlan(void);
 UBYTE get_antic_function_idx(void);
 void set_antic_function_by_idx(UBYTE idx);
 UBYTE get_antic_0_function_idx(void);
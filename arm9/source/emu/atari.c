@@ -56,6 +56,7 @@
 #include "esc.h"
 #include "binload.h"
 #include "cartridge.h"
+#include "cassette.h"
 #include "cpu.h"
 #include "gtia.h"
 #include "input.h"
@@ -64,6 +65,7 @@
 #include "platform.h"
 #include "pokeysnd.h"
 #include "rtime.h"
+#include "sched.h"
 #include "sio.h"
 #include "util.h"
 #include "pokeysnd.h"
@@ -114,6 +116,10 @@ void Coldstart(void)
         /* hold Option during reboot */
         consol_table[2] &= ~CONSOL_OPTION;
     }
+    if (CASSETTE_hold_start) {
+        /* hold Start during reboot */
+        consol_table[2] &= ~CONSOL_START;
+    }
     consol_table[1] = consol_table[2];
 }
 
@@ -128,9 +134,12 @@ int Atari800_InitialiseMachine(void)
 int Atari800_DetectFileType(const char *filename) 
 {
     // Nothing fancy here... if the filename says it's ATR or XEX who are we to argue...
+    // (gzip compressed images keep theirs ahead of the .gz - GAME.ATR.GZ - or are .ATZ)
     if (strstr(filename, ".atr") != 0) return  AFILE_ATR;
     if (strstr(filename, ".Atr") != 0) return  AFILE_ATR;
     if (strstr(filename, ".ATR") != 0) return  AFILE_ATR;
+    if (strstr(filename, ".atz") != 0) return  AFILE_ATR;
+    if (strstr(filename, ".ATZ") != 0) return  AFILE_ATR;
     if (strstr(filename, ".atx") != 0) return  AFILE_ATX;
     if (strstr(filename, ".ATX") != 0) return  AFILE_ATX;
     if (strstr(filename, ".xex") != 0) return  AFILE_XEX;
@@ -139,6 +148,8 @@ int Atari800_DetectFileType(const char *filename)
     if (strstr(filename, ".CAR") != 0) return  AFILE_CART;
     if (strstr(filename, ".rom") != 0) return  AFILE_ROM;
     if (strstr(filename, ".ROM") != 0) return  AFILE_ROM;
+    if (strstr(filename, ".cas") != 0) return  AFILE_CAS;
+    if (strstr(filename, ".CAS") != 0) return  AFILE_CAS;
     return AFILE_ERROR;
 }
 
@@ -148,6 +159,13 @@ int Atari800_OpenFile(const char *filename, int reboot, int diskno, int readonly
     
     file_type = Atari800_DetectFileType(filename);
     
+    // Rebooting into anything else takes the tape out - a disk can still go in alongside it
+    if (file_type != AFILE_ERROR && (reboot || (file_type != AFILE_ATR && file_type != AFILE_ATX)))
+    {
+        CASSETTE_Remove();
+        CASSETTE_hold_start = 0;
+    }
+    
     switch (file_type) 
     {
     case AFILE_ATR:
@@ -186,6 +204,16 @@ int Atari800_OpenFile(const char *filename, int reboot, int diskno, int readonly
       strcpy(disk_filename[DISK_XEX], filename);
       Atari800_Coldstart();
       break;
+    case AFILE_CAS:
+      CART_Insert(bEnableBasic, file_type, filename); 
+      strcpy(disk_filename[DISK_1], "EMPTY");
+      strcpy(disk_filename[DISK_2], "EMPTY");
+      strcpy(disk_filename[DISK_XEX], filename);
+      if (!CASSETTE_Insert(filename))
+        return AFILE_ERROR;
+      CASSETTE_hold_start = !bEnableBasic;  // Boot it - with BASIC in, it is left for CLOAD or RUN "C:"
+      Atari800_Coldstart();
+      break;
     }
     return file_type;
 }
@@ -217,12 +245,14 @@ int Atari800_Initialise(void)
     Atari_Initialise();
 
     // Initialise Custom Chips
+    SCHED_Initialise();
     ANTIC_Initialise();
     GTIA_Initialise();
     PIA_Initialise();
     POKEY_Initialise();
 
     Atari800_InitialiseMachine();
+    Atari800_ResetFrameSkip();
 
     return TRUE;
 }
@@ -312,13 +342,109 @@ void Atari800_UpdatePatches(void) {
     }
 }
 
+// ----------------------------------------------------------------------------------
+// Adaptive frame skip (SKIP FRAMES = AUTO). The main loop hands us the DS timer ticks
+// each Atari800_Frame() took and we keep a running count of how far behind the
+// 546/656 tick budget (NTSC/PAL at 32,728.5 ticks/sec) we have fallen. Running ahead
+// can't be banked - the main loop just waits out the rest of the frame - so the lag
+// never goes below zero. Once we are a quarter of a frame behind we stop drawing and
+// only start again when we are back on schedule; that gap keeps us from flipping
+// between the two every other frame. No more than AUTOSKIP_MAX_RUN frames are ever
+// skipped in a row so that even the heaviest game keeps moving on screen.
+// ----------------------------------------------------------------------------------
+#define AUTOSKIP_MAX_RUN    2
+#define AUTOSKIP_MAX_LAG    4                   // Frames of lag worth catching up - beyond that, forget it
+
+UBYTE autoskip_draw = TRUE;                     // Whether the next frame gets drawn
+UBYTE autoskip_run = 0;                         // Frames skipped in a row
+int   autoskip_lag = 0;                         // Ticks behind schedule
+ULONG frames_drawn = 0;                         // Frames ANTIC drew and skipped - for every SKIP FRAMES setting
+ULONG frames_skipped = 0;
+
+void Atari800_FrameTime(int ticks)
+{
+    int budget = (myConfig.tv_type == TV_NTSC ? 546:656);
+
+    autoskip_lag += ticks - budget;
+    if (autoskip_lag < 0) autoskip_lag = 0;
+    if (autoskip_lag > budget * AUTOSKIP_MAX_LAG) autoskip_lag = budget * AUTOSKIP_MAX_LAG;
+
+    if (autoskip_draw)
+    {
+        if (autoskip_lag > budget / 4) autoskip_draw = FALSE;
+    }
+    else if (autoskip_lag == 0) autoskip_draw = TRUE;
+
+    if (!autoskip_draw && autoskip_run >= AUTOSKIP_MAX_RUN) autoskip_draw = TRUE;
+}
+
+void Atari800_ResetFrameSkip(void)
+{
+    autoskip_draw = TRUE;
+    autoskip_run = 0;
+    autoskip_lag = 0;
+}
+
+// ----------------------------------------------------------------------------------
+// Audio-clock frame pacing (FRAME PACING = AUDIO). Rather than count DS timer ticks,
+// the main loop waits until the sound played out of the Pokey ring is down to one
+// frame's worth and then runs the next frame - so the sound card sets the pace and
+// the ring never runs dry or fills up while the emulation keeps up. When it doesn't
+// (a heavy frame, a disk load) the ring runs low, and we nudge the rate the samples
+// are played at down by up to PACE_MAX_ADJUST (and back up once the ring recovers)
+// so a short shortfall is absorbed as an unhearable pitch change rather than a gap.
+// The main loop hands us the fill level it waited down to, in samples, once a frame
+// and gets back the rate adjustment in 1/65536ths.
+// ----------------------------------------------------------------------------------
+#define PACE_MAX_ADJUST     328                 // 0.5% - well under what anyone can hear
+#define PACE_SMOOTH         3                   // Adjustment moves 1/8 of the way each frame
+
+int   pace_adjust = 0;                          // Current sample rate adjustment, 1/65536ths
+ULONG pace_underruns = 0;                       // Sound ticks that found no fresh sample
+ULONG pace_overruns = 0;                        // Samples written over before they were played
+
+int Atari800_PaceRate(int fill)
+{
+    int target = snd_playback_freq / (myConfig.tv_type == TV_NTSC ? 60:50);
+    int want = ((fill - target) * PACE_MAX_ADJUST) / target;
+
+    if (want < -PACE_MAX_ADJUST) want = -PACE_MAX_ADJUST;
+    if (want > PACE_MAX_ADJUST) want = PACE_MAX_ADJUST;
+    pace_adjust += (want - pace_adjust) >> PACE_SMOOTH;
+    return pace_adjust;
+}
+
+static inline int draw_this_frame(void)
+{
+    int draw;
+    switch (myConfig.skip_frames)
+    {
+        case 0:  draw = TRUE; break;
+        case 1:  draw = (gTotalAtariFrames & 0x03); break;     // Skip every 4th frame...
+        case 2:  draw = (gTotalAtariFrames & 0x01); break;     // Or every other frame if we are "aggressive"
+        default: draw = autoskip_draw; break;
+    }
+    if (draw)
+    {
+        frames_drawn++;
+        autoskip_run = 0;
+    }
+    else
+    {
+        frames_skipped++;
+        autoskip_run++;
+    }
+    return draw;
+}
+
 void Atari800_Frame() 
 {
     //Devices_Frame();
     INPUT_Frame();
     GTIA_Frame();
-    ANTIC_Frame(myConfig.skip_frames ? (gTotalAtariFrames & (myConfig.skip_frames==1 ? 0x03:0x01)) : TRUE);  // Skip every 4th frame... or every other frame if we are "aggressive"
+    ANTIC_Frame(draw_this_frame());
     POKEY_Frame();
+    SIO_Frame();
     
     gTotalAtariFrames++;
 }
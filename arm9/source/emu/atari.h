@@ -92,8 +92,14 @@ extern int disk_readonly[DISK_MAX];
 #endif
 
 // Some global sound defines
-#define SOUND_FREQ  (myConfig.tv_type == TV_NTSC ? 15720:15600)     // 60 frames per second. 264 scanlines per frame. 1 samples per scanline. 60*264*1 = 15720... slightly different for pal 50*312*1=15600
-#define SNDLENGTH  256                                              // Must be power of 2... so we can quicly mask it
+#define SOUND_LINE_FREQ (myConfig.tv_type == TV_NTSC ? 15720:15600) // 60 frames per second. 264 scanlines per frame. 1 samples per scanline. 60*264*1 = 15720... slightly different for pal 50*312*1=15600
+#define SOUND_LINE_HALVES (myConfig.sound_mode < 2 ? 2 : myConfig.sound_mode + 1) // Samples per scanline x2 - 1, 1.5 or 2 samples a line for the 15.7K, 23.6K and 31.4K output rates
+#define SOUND_FREQ  (SOUND_LINE_FREQ * SOUND_LINE_HALVES / 2)
+#define SOUND_BLEP  (myConfig.sound_mode != 0)                      // Every rate but the classic 15.7K uses the band-limited step synthesis
+#define SOUND_POKEYS (myConfig.pokey_stereo ? 2 : 1)                // A second POKEY at $D210 for stereo - left is the first chip, right the second
+#ifndef SNDLENGTH
+#define SNDLENGTH  4096                                             // Must be power of 2... so we can quicly mask it. Room for two PAL frames at 31.4K in stereo - AUDIO CLOCK pacing keeps up to two in it
+#endif
 
 /* Public interface ------------------------------------------------------ */
 
@@ -196,6 +202,24 @@ int Atari800_Initialise(void);
 /* Emulates one frame (1/50sec for PAL, 1/60sec for NTSC). */
 void Atari800_Frame(void);
 
+/* SKIP FRAMES = AUTO: tells the frame skipper how many DS timer ticks
+   (32,728.5/sec) the last Atari800_Frame() took. */
+#define SKIP_FRAMES_AUTO 3
+void Atari800_FrameTime(int ticks);
+void Atari800_ResetFrameSkip(void);
+extern int   autoskip_lag;
+extern ULONG frames_drawn;
+extern ULONG frames_skipped;
+
+/* FRAME PACING = AUDIO: given the samples left in the sound ring when the next
+   frame starts, returns how far to move the rate they are played at, in
+   1/65536ths. */
+#define PACING_AUDIO 1
+int Atari800_PaceRate(int fill);
+extern int   pace_adjust;
+extern ULONG pace_underruns;
+extern ULONG pace_overruns;
+
 #define Atari800_Coldstart Coldstart
 #define Atari800_Warmstart Warmstart
 
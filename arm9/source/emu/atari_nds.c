@@ -43,7 +43,7 @@ u8 stick1 = STICK_CENTRE;
 void Atari_Initialise(void) 
 {
     // initialise sound routines 
-    Pokey_sound_init(FREQ_17_APPROX, SOUND_FREQ, 1, 0);
+    Pokey_sound_init(FREQ_17_APPROX, SOUND_FREQ, SOUND_POKEYS, (SOUND_BLEP ? SND_BLEP : 0) | (SOUND_POKEYS > 1 ? SND_STEREO : 0));
     trig0 = 1;
     stick0 = 15;
     key_consol = CONSOL_NONE;
@@ -49,19 +49,36 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "atari.h"
 #include "binload.h"
 #include "cpu.h"
 #include "esc.h"
+#include "gzfile.h"
 #include "memory.h"
 #include "sio.h"
 
 int BINLOAD_start_binloading = FALSE;
 int BINLOAD_loading_basic = 0;
 int BINLOAD_slow_xex_loading = FALSE;
+int BINLOAD_bulk_loading = TRUE;
 FILE *BINLOAD_bin_file = NULL;
 
+/* The segment table of the last executable loaded - see BINLOAD_ScanSegments() */
+BINLOAD_Segment *BINLOAD_segments = NULL;
+int BINLOAD_segment_count = 0;
+int BINLOAD_trailing_bytes = 0;
+
+/* The whole executable, read in one go by BINLOAD_Loader() and freed once it is loaded */
+static UBYTE *xex_data = NULL;
+static ULONG xex_len = 0;
+/* Next segment of the table to load, and the next byte of it. */
+static int next_segment = 0;
+static ULONG xex_pos = 0;
+static ULONG xex_seg_end = 0;
+
 /* These variables are for slow XEX loading only. */
 
 /* Number of CPU instructions elapsed since last loaded byte. */
@@ -76,27 +93,115 @@ static int init2e3 = FALSE;
 static int segfinished = TRUE;
 int BINLOAD_pause_loading;
 
-/* Read a word from file */
-static int read_word(void)
+static void free_xex(void)
 {
-    UBYTE buf[2];
-    if (fread(buf, 1, 2, BINLOAD_bin_file) != 2) {
-        fclose(BINLOAD_bin_file);
-        BINLOAD_bin_file = NULL;
-        if (BINLOAD_start_binloading) {
-            BINLOAD_start_binloading = FALSE;
-            return -1;
+    free(xex_data);
+    xex_data = NULL;
+    xex_len = 0;
+}
+
+/* Build the segment table for an executable held in memory: each segment's
+   addresses, where its data is and whether it sets INITAD or RUNAD. Any
+   number of $FFFF markers may come before a header. The table stops at a
+   header cut short (what is left over is counted in BINLOAD_trailing_bytes)
+   or at a segment whose data is cut short. Returns the number of segments. */
+int BINLOAD_ScanSegments(const UBYTE *data, ULONG len)
+{
+    ULONG pos = 0;
+    int max = 0;
+
+    BINLOAD_segment_count = 0;
+    BINLOAD_trailing_bytes = 0;
+    for (;;) {
+        BINLOAD_Segment *seg;
+        int flags = 0;
+        ULONG length;
+        while (pos + 2 <= len && data[pos] == 0xff && data[pos + 1] == 0xff) {
+            flags |= BINLOAD_SEG_HEADER;
+            pos += 2;
+        }
+        if (pos + 4 > len) {
+            BINLOAD_trailing_bytes = (int) (len - pos);
+            break;
         }
-        CPU_regPC = dGetWord(0x2e0);
-        return -1;
+        if (BINLOAD_segment_count == max) {
+            BINLOAD_Segment *grown;
+            max = max ? max * 2 : 64;
+            grown = (BINLOAD_Segment *) realloc(BINLOAD_segments, max * sizeof(BINLOAD_Segment));
+            if (grown == NULL)
+                break;
+            BINLOAD_segments = grown;
+        }
+        seg = &BINLOAD_segments[BINLOAD_segment_count++];
+        seg->start = data[pos] | (data[pos + 1] << 8);
+        seg->end = data[pos + 2] | (data[pos + 3] << 8);
+        pos += 4;
+        /* An end before the start wraps round through $FFFF, as the byte at a time loader always did */
+        length = ((UWORD) (seg->end - seg->start)) + 1;
+        if (seg->end < seg->start)
+            flags |= BINLOAD_SEG_WRAPS;
+        if ((UWORD) (0x2e2 - seg->start) < length || (UWORD) (0x2e3 - seg->start) < length)
+            flags |= BINLOAD_SEG_INIT;
+        if ((UWORD) (0x2e0 - seg->start) < length || (UWORD) (0x2e1 - seg->start) < length)
+            flags |= BINLOAD_SEG_RUN;
+        seg->offset = pos;
+        if (length > len - pos) {
+            length = len - pos;
+            flags |= BINLOAD_SEG_SHORT;
+        }
+        seg->length = length;
+        seg->flags = flags;
+        pos += length;
+        if (flags & BINLOAD_SEG_SHORT)
+            break;
+    }
+    return BINLOAD_segment_count;
+}
+
+/* Copy a run of a segment into Atari memory. Pages with nothing hooked on
+   writes are plain RAM and take a memcpy through mem_map[] - a page never
+   straddles one of its 4K banks - the rest (hardware, ROM) go a byte at a
+   time through PutByte() as before. Returns TRUE if any page was hooked. */
+static int copy_run(UWORD addr, const UBYTE *src, ULONG length)
+{
+    int hooked = FALSE;
+    while (length > 0) {
+        ULONG chunk = 0x100 - (addr & 0xff);
+        if (chunk > length)
+            chunk = length;
+        if (writemap[addr >> 8] == NULL)
+            memcpy(AnticMainMemLookup(addr), src, chunk);
+        else {
+            ULONG i;
+            for (i = 0; i < chunk; i++)
+                PutByte((UWORD) (addr + i), src[i]);
+            hooked = TRUE;
+        }
+        addr += chunk;
+        src += chunk;
+        length -= chunk;
+    }
+    return hooked;
+}
+
+/* The file ran out part way through a segment - run it as it is */
+static void loader_eof(void)
+{
+    free_xex();
+    CPU_regPC = dGetWord(0x2e0);
+    if (dGetByte(0x2e3) != 0xd7) {
+        /* run INIT routine which RTSes directly to RUN routine */
+        CPU_regPC--;
+        dPutByte(0x0100 + CPU_regS--, CPU_regPC >> 8);      /* high */
+        dPutByte(0x0100 + CPU_regS--, CPU_regPC & 0xff);    /* low */
+        CPU_regPC = dGetWord(0x2e2);
     }
-    return buf[0] + (buf[1] << 8);
 }
 
 /* Start or continue loading */
 static void loader_cont(void)
 {
-    if (BINLOAD_bin_file == NULL)
+    if (xex_data == NULL)
         return;
     if (BINLOAD_start_binloading) {
         dPutByte(0x244, 0);
@@ -108,20 +213,26 @@ static void loader_cont(void)
     if (init2e3)
         dPutByte(0x2e3, 0xd7);
     init2e3=FALSE;
+    /* The block cache is flushed once this ESC handler returns anyway - doing it now
+       drops its write watches on code pages, so the RAM they cover is copied straight in */
+    CPU_FlushBlockCache();
     do {
         if((!BINLOAD_wait_active || !BINLOAD_slow_xex_loading) && segfinished){
-            int temp;
-            do
-                temp = read_word();
-            while (temp == 0xffff);
-            if (temp < 0)
-                return;
-            from = (UWORD) temp;
-
-            temp = read_word();
-            if (temp < 0)
+            BINLOAD_Segment *seg;
+            if (next_segment == BINLOAD_segment_count) {
+                free_xex();
+                if (BINLOAD_start_binloading) {
+                    BINLOAD_start_binloading = FALSE;
+                    return;
+                }
+                CPU_regPC = dGetWord(0x2e0);
                 return;
-            to = (UWORD) temp;
+            }
+            seg = &BINLOAD_segments[next_segment++];
+            from = seg->start;
+            to = seg->end;
+            xex_pos = seg->offset;
+            xex_seg_end = seg->offset + seg->length;
 
             if (BINLOAD_start_binloading) {
                 dPutWord(0x2e0, from);
@@ -130,8 +241,20 @@ static void loader_cont(void)
             to++;
             segfinished = FALSE;
         }
+        if (!BINLOAD_slow_xex_loading && BINLOAD_bulk_loading) {
+            /* The rest of the segment in one go - as much of it as the file has */
+            ULONG length = xex_seg_end - xex_pos;
+            if (copy_run(from, xex_data + xex_pos, length))
+                BINLOAD_segments[next_segment - 1].flags |= BINLOAD_SEG_HOOKED;
+            from += length;
+            xex_pos += length;
+            if (BINLOAD_segments[next_segment - 1].flags & BINLOAD_SEG_SHORT) {
+                loader_eof();
+                return;
+            }
+        }
+        else
         do {
-            int byte;
             if (BINLOAD_slow_xex_loading) {
                 instr_elapsed++;
                 if ((instr_elapsed < 300) || BINLOAD_pause_loading) {
@@ -145,21 +268,13 @@ static void loader_cont(void)
                 instr_elapsed = 0;
                 BINLOAD_wait_active = FALSE;
             }
-            byte = fgetc(BINLOAD_bin_file);
-            if (byte == EOF) {
-                fclose(BINLOAD_bin_file);
-                BINLOAD_bin_file = NULL;
-                CPU_regPC = dGetWord(0x2e0);
-                if (dGetByte(0x2e3) != 0xd7) {
-                    /* run INIT routine which RTSes directly to RUN routine */
-                    CPU_regPC--;
-                    dPutByte(0x0100 + CPU_regS--, CPU_regPC >> 8);      /* high */
-                    dPutByte(0x0100 + CPU_regS--, CPU_regPC & 0xff);    /* low */
-                    CPU_regPC = dGetWord(0x2e2);
-                }
+            if (xex_pos == xex_seg_end) {
+                loader_eof();
                 return;
             }
-            PutByte(from, (UBYTE) byte);
+            if (writemap[from >> 8] != NULL)
+                BINLOAD_segments[next_segment - 1].flags |= BINLOAD_SEG_HOOKED;
+            PutByte(from, xex_data[xex_pos++]);
             from++;
         } while (from != to);
         segfinished = TRUE;
@@ -200,12 +315,14 @@ int BINLOAD_LoaderStart(UBYTE *buffer)
 int BINLOAD_Loader(const char *filename)
 {
     UBYTE buf[2];
+    long len;
     if (BINLOAD_bin_file != NULL) {     /* close previously open file */
         fclose(BINLOAD_bin_file);
         BINLOAD_bin_file = NULL;
         BINLOAD_loading_basic = 0;
     }
-    BINLOAD_bin_file = fopen(filename, "rb");
+    free_xex();
+    BINLOAD_bin_file = GZ_fopen(filename, "rb");
     if (BINLOAD_bin_file == NULL) { /* open */
         return FALSE;
     }
@@ -214,6 +331,22 @@ int BINLOAD_Loader(const char *filename)
         SIO_DisableDrive(1);
     if (fread(buf, 1, 2, BINLOAD_bin_file) == 2) {
         if (buf[0] == 0xff && buf[1] == 0xff) {
+            /* Read it all now - one pass over the card rather than a call per byte as it loads */
+            fseek(BINLOAD_bin_file, 0, SEEK_END);
+            len = ftell(BINLOAD_bin_file);
+            fseek(BINLOAD_bin_file, 0, SEEK_SET);
+            xex_data = (len > 0) ? (UBYTE *) malloc(len) : NULL;
+            if (xex_data == NULL || fread(xex_data, 1, len, BINLOAD_bin_file) != (size_t) len) {
+                free_xex();
+                fclose(BINLOAD_bin_file);
+                BINLOAD_bin_file = NULL;
+                return FALSE;
+            }
+            xex_len = len;
+            fclose(BINLOAD_bin_file);
+            BINLOAD_bin_file = NULL;
+            BINLOAD_ScanSegments(xex_data, xex_len);
+            next_segment = 0;
             BINLOAD_start_binloading = TRUE; /* force SIO to call BINLOAD_LoaderStart at boot */
             Atari800_Coldstart();             /* reboot */
             return TRUE;
@@ -55,6 +55,29 @@
 
 extern FILE *BINLOAD_bin_file;
 
+/* One segment of an executable, as found by BINLOAD_ScanSegments() */
+typedef struct {
+    UWORD start;
+    UWORD end;
+    ULONG offset;       /* of its first data byte in the file */
+    ULONG length;       /* data bytes - fewer than end - start + 1 if the file is cut short */
+    int flags;
+} BINLOAD_Segment;
+
+#define BINLOAD_SEG_HEADER  0x01    /* came after a $FFFF marker */
+#define BINLOAD_SEG_INIT    0x02    /* writes INITAD ($02E2-$02E3) */
+#define BINLOAD_SEG_RUN     0x04    /* writes RUNAD ($02E0-$02E1) */
+#define BINLOAD_SEG_WRAPS   0x08    /* end is below start - loads round through $FFFF */
+#define BINLOAD_SEG_SHORT   0x10    /* the file ends part way through its data */
+#define BINLOAD_SEG_HOOKED  0x20    /* loaded - and some went through a writemap[] hook */
+
+/* The segment table of the last executable loaded - kept after it has loaded */
+extern BINLOAD_Segment *BINLOAD_segments;
+extern int BINLOAD_segment_count;
+extern int BINLOAD_trailing_bytes;
+
+int BINLOAD_ScanSegments(const UBYTE *data, ULONG len);
+
 int BINLOAD_Loader(const char *filename);
 extern int BINLOAD_start_binloading;
 extern int BINLOAD_loading_basic;
@@ -62,6 +85,10 @@ extern int BINLOAD_loading_basic;
 /* Set to TRUE to enable loading of XEX with approximate disk speed */
 extern int BINLOAD_slow_xex_loading;
 
+/* Set to FALSE to load segments a byte at a time through PutByte() rather than
+   copying them straight into RAM pages - for checking one against the other */
+extern int BINLOAD_bulk_loading;
+
 /* Indicates that a DOS file is being currently slowly loaded. */
 extern int BINLOAD_wait_active;
 
@@ -60,6 +60,8 @@
 #include "atari.h"
 #include "binload.h"
 #include "cartridge.h"
+#include "cpu.h"
+#include "gzfile.h"
 #include "memory.h"
 #include "rtime.h"
 #include "altirra_basic.h"
@@ -68,6 +70,7 @@ extern UBYTE ROM_basic[];
 
 UBYTE cart_image[CART_MAX_SIZE];    // Big enough to hold the largest carts we support ... 1MB
 UBYTE cart_header[16];
+ULONG cart_image_size = 0;          // Of the whole image in the file (less the .CAR header) - even past CART_MAX_SIZE
 static int bank __attribute__((section(".dtcm")));
 
 /* DB_32, XEGS_32, XEGS_64, XEGS_128, XEGS_256, XEGS_512, XEGS_1024 */
@@ -332,6 +335,7 @@ static void access_BountyBob1(UWORD addr)
         if (new_state != last_bb1_bank) 
         {
             CopyROM(base_addr, base_addr + 0x0fff, cart_image + addr * 0x1000);
+            CPU_FlushBlockCache();
             last_bb1_bank = new_state;
         }
     }
@@ -349,6 +353,7 @@ static void access_BountyBob2(UWORD addr)
         if (new_state != last_bb2_bank) 
         {
             CopyROM(base_addr, base_addr + 0x0fff, cart_image + 0x4000 + addr * 0x1000);
+            CPU_FlushBlockCache();
             last_bb2_bank = new_state;
         }
     }
@@ -390,27 +395,32 @@ void BountyBob2PutByte(UWORD addr, UBYTE value)
 int CART_Insert(int enabled, int file_type, const char *filename) 
 {
     memset(cart_image, 0x00, sizeof(cart_image));
+    cart_image_size = 0;
     bank = 0;
 
     CART_Remove();
     
     if (file_type == AFILE_CART)
     {
-        FILE * fp = fopen(filename, "rb");
+        FILE * fp = GZ_fopen(filename, "rb");
         if (fp != NULL)
         {
             fread(cart_header, 1, 16, fp);
             fread(cart_image, 1, CART_MAX_SIZE, fp);
+            fseek(fp, 0, SEEK_END);
+            cart_image_size = ftell(fp) - 16;
             fclose(fp);
             myConfig.cart_type = cart_header[7];
         }
     }
     if (file_type == AFILE_ROM)
     {
-        FILE * fp = fopen(filename, "rb");
+        FILE * fp = GZ_fopen(filename, "rb");
         if (fp != NULL)
         {
             int size = fread(cart_image, 1, CART_MAX_SIZE, fp);
+            fseek(fp, 0, SEEK_END);
+            cart_image_size = ftell(fp);
             fclose(fp);
             size = size / 1024;
             // If configuration hasn't been set for a Cartridge Type, guess at the type...
@@ -816,6 +826,8 @@ void CART_Access(UWORD addr)
 // -----------------------------------------------------------------
 UBYTE CART_GetByte(UWORD addr)
 {
+    CPU_BreakBlock();   // Bank may switch under the code we are running
+    
     if (addr == 0xd5b8 || addr == 0xd5b9)
     {
         return RTIME_GetByte();
@@ -843,6 +855,8 @@ UBYTE CART_GetByte(UWORD addr)
 // -----------------------------------------------------------------
 void CART_PutByte(UWORD addr, UBYTE byte)
 {
+    CPU_BreakBlock();   // Bank may switch under the code we are running
+    
     if (addr == 0xd5b8 || addr == 0xd5b9) 
     {
         RTIME_PutByte(byte);
@@ -120,6 +120,7 @@
 
 extern UBYTE *cart_mem_ptr;
 extern UBYTE cart_image[];
+extern ULONG cart_image_size;
 
 int CART_Insert(int enabled, int type, const char *filename);
 void CART_Remove(void);
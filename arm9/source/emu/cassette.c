@@ -0,0 +1,364 @@
+/*
+ * CASSETTE.C contains the cassette emulation - .CAS tape images for the many
+ * games that only ever came out on tape.
+ *
+ * A .CAS file is a run of chunks: a "FUJI" description, "baud" for the rate the
+ * records after it were recorded at, and a "data" chunk for each record on the
+ * tape with the gap before it (in milliseconds) in its aux field. The whole
+ * image is read in (through GZ_fopen() so a .CAS.GZ works too) and the records
+ * listed once - the tape is never written, like a gzip compressed disk.
+ *
+ * There are two ways the tape can be read, the same two the disk drives have:
+ *
+ * With the SIO patch (DISK SPEEDUP on) the OS's calls to SIOV for the cassette
+ * are answered from the image a whole record at a time - the next record is
+ * checked and copied straight to memory, with no leader, no gaps and no 600 baud
+ * - so a tape that takes minutes on the real thing loads in a second or two.
+ * The C: handler's wait for the leader is patched too (ESC_COPENLOAD/COPENSAVE
+ * on the Atari OS, the one wait routine Altirra OS has) so that is skipped.
+ *
+ * Without it the tape plays in real time through POKEY's serial port: turning the
+ * motor on with PACTL starts it, each byte turns up in SERIN after its 10 bits at
+ * the record's baud rate - with the gaps between records - and SKSTAT's serial
+ * input bit follows each bit as it goes by, which is what the OS times to work
+ * out the baud rate from the two $55 sync bytes (a POKEY reset then loses the byte
+ * coming in, as on the real thing). Everything is kept in CPU cycles
+ * against cpu_clock, so the tape keeps time however POKEY is polled. It is as
+ * slow as the real thing, but it also loads tapes with their own loaders that
+ * read POKEY themselves rather than going through SIOV.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atari.h"
+#include "cassette.h"
+#include "cpu.h"
+#include "gzfile.h"
+#include "memory.h"
+#include "sio.h"
+
+#define CAS_DEFAULT_BAUD    600
+
+typedef struct
+{
+    ULONG offset;                       // Of the record's bytes in the image
+    int   length;
+    ULONG gap_ms;                       // Silence on the tape before it
+    int   baud;
+} cas_record_t;
+
+int CASSETTE_hold_start_on_reboot = 0;
+int CASSETTE_hold_start = 0;
+int CASSETTE_press_space = 0;
+
+int  CASSETTE_record_count = 0;
+int  CASSETTE_current_record = 0;
+ULONG CASSETTE_records_read = 0;
+ULONG CASSETTE_bytes_read = 0;
+
+static UBYTE *tape = NULL;              // The whole image file
+static cas_record_t *records = NULL;
+static int byte_index = 0;              // Next byte of the current record to come in
+static int motor = 0;
+static unsigned int due = 0;            // cpu_clock when that byte is in - while the motor runs
+static unsigned int remaining = 0;      // Cycles still to go for it - while it is stopped
+
+// ---------------------------------------------------------------------------
+// Tape time is kept in CPU cycles.
+// ---------------------------------------------------------------------------
+static unsigned int cycles_per_second(void)
+{
+    return (myConfig.tv_type == TV_PAL) ? 1773447 : 1789790;
+}
+
+// A byte is a start bit, 8 data bits and a stop bit
+static unsigned int byte_cycles(int rec)
+{
+    return 10 * cycles_per_second() / records[rec].baud;
+}
+
+static unsigned int gap_cycles(int rec)
+{
+    return records[rec].gap_ms * (cycles_per_second() / 1000);
+}
+
+// The first byte of a record is in after the gap before it and its own 10 bits
+static void start_record(int rec)
+{
+    CASSETTE_current_record = rec;
+    byte_index = 0;
+    remaining = (rec < CASSETTE_record_count) ? gap_cycles(rec) + byte_cycles(rec) : 0;
+    if (motor) due = cpu_clock + remaining;
+}
+
+static int playing(void)
+{
+    return motor && CASSETTE_current_record < CASSETTE_record_count;
+}
+
+// The tape is moving - SKSTAT's serial input bit can change at any cycle
+int CASSETTE_IsPlaying(void)
+{
+    return playing();
+}
+
+void CASSETTE_Remove(void)
+{
+    free(tape);
+    free(records);
+    tape = NULL;
+    records = NULL;
+    CASSETTE_record_count = 0;
+    CASSETTE_current_record = 0;
+    byte_index = 0;
+    motor = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Read a .CAS image in and list its records. Chunks other than "baud" and
+// "data" (the description, and the "fsk " and "pwm" chunks of turbo tapes
+// that don't use POKEY's serial port at all) are passed over, and an empty
+// "data" chunk just adds its gap to the next record's.
+// ---------------------------------------------------------------------------
+int CASSETTE_Insert(const char *filename)
+{
+    FILE *fp;
+    long len;
+    ULONG pos = 0, pending_gap = 0;
+    int baud = CAS_DEFAULT_BAUD, max = 0;
+
+    CASSETTE_Remove();
+    fp = GZ_fopen(filename, "rb");
+    if (fp == NULL) return FALSE;
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    tape = (len >= 8) ? (UBYTE *) malloc(len) : NULL;
+    if (tape == NULL || fread(tape, 1, len, fp) != (size_t) len || memcmp(tape, "FUJI", 4) != 0)
+    {
+        fclose(fp);
+        CASSETTE_Remove();
+        return FALSE;
+    }
+    fclose(fp);
+
+    while (pos + 8 <= (ULONG) len)
+    {
+        const UBYTE *chunk = tape + pos;
+        ULONG length = chunk[4] | (chunk[5] << 8);
+        ULONG aux = chunk[6] | (chunk[7] << 8);
+
+        if (pos + 8 + length > (ULONG) len) break;     // Cut short - play what there is
+        if (memcmp(chunk, "baud", 4) == 0)
+        {
+            baud = aux ? (int) aux : CAS_DEFAULT_BAUD;
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            if (length == 0)
+            {
+                pending_gap += aux;
+            }
+            else
+            {
+                if (CASSETTE_record_count == max)
+                {
+                    cas_record_t *grown = (cas_record_t *) realloc(records, (max ? max * 2 : 64) * sizeof(cas_record_t));
+                    if (grown == NULL) break;
+                    records = grown;
+                    max = max ? max * 2 : 64;
+                }
+                cas_record_t *rec = &records[CASSETTE_record_count++];
+                rec->offset = pos + 8;
+                rec->length = (int) length;
+                rec->gap_ms = aux + pending_gap;
+                rec->baud = baud;
+                pending_gap = 0;
+            }
+        }
+        pos += 8 + length;
+    }
+
+    if (CASSETTE_record_count == 0)
+    {
+        CASSETTE_Remove();
+        return FALSE;
+    }
+    start_record(0);
+    return TRUE;
+}
+
+// ---------------------------------------------------------------------------
+// The SIO patch. The OS reads a record as the two $55 sync bytes, the control
+// byte and 128 data bytes into CASBUF and expects the checksum after them.
+// ---------------------------------------------------------------------------
+int CASSETTE_ReadToMemory(UWORD dest_addr, int length)
+{
+    const cas_record_t *rec;
+    int n;
+
+    if (CASSETTE_current_record >= CASSETTE_record_count) return 0;
+    rec = &records[CASSETTE_current_record];
+    start_record(CASSETTE_current_record + 1);
+
+    n = (rec->length < length) ? rec->length : length;
+    CopyToMem(tape + rec->offset, dest_addr, n);
+    CASSETTE_records_read++;
+    if (rec->length != length + 1) return -1;
+    return (SIO_ChkSum(tape + rec->offset, length) == tape[rec->offset + length]) ? 1 : -1;
+}
+
+// ---------------------------------------------------------------------------
+// The C: handler's OPEN for reading and for writing set the third system
+// timer for the leader with A=3 and X/Y for SETVBV - make it a tenth of a
+// second. Writing goes nowhere: the tape is read only.
+// ---------------------------------------------------------------------------
+void CASSETTE_LeaderLoad(void)
+{
+    CPU_regA = 3;
+    CPU_regX = 0;
+    CPU_regY = 5;
+}
+
+void CASSETTE_LeaderSave(void)
+{
+    CPU_regA = 3;
+    CPU_regX = 0;
+    CPU_regY = 5;
+}
+
+// Altirra OS's wait - A=1 for its timer and X:Y frames (over 9 seconds for the leader)
+void CASSETTE_LeaderWait(void)
+{
+    CPU_regA = 1;
+    CPU_regX = 0;
+    CPU_regY = 5;
+}
+
+int CASSETTE_IsSaveFile(void)
+{
+    return FALSE;
+}
+
+void CASSETTE_PutByte(int byte)
+{
+}
+
+// ---------------------------------------------------------------------------
+// The tape only moves while the motor runs - stopping it part way through a
+// gap or a byte picks up from the same place when it starts again.
+// ---------------------------------------------------------------------------
+void CASSETTE_TapeMotor(int onoff)
+{
+    if (onoff && !motor)
+    {
+        due = cpu_clock + remaining;
+    }
+    else if (!onoff && motor)
+    {
+        int left = (int) (due - cpu_clock);
+        remaining = (left > 0) ? left : 0;
+    }
+    motor = onoff;
+}
+
+// On to the next byte on the tape - across the gap if that was the record's last
+static void advance(void)
+{
+    if (++byte_index < records[CASSETTE_current_record].length)
+    {
+        due += byte_cycles(CASSETTE_current_record);
+    }
+    else if (++CASSETTE_current_record < CASSETTE_record_count)
+    {
+        byte_index = 0;
+        due += gap_cycles(CASSETTE_current_record) + byte_cycles(CASSETTE_current_record);
+    }
+}
+
+// Bytes that went by with no one listening (POKEY reset, or the serial IRQ
+// off and not yet turned back on) are gone - as they are on the real thing
+static void catch_up(void)
+{
+    while (playing() && (int) (cpu_clock - due) >= (int) byte_cycles(CASSETTE_current_record))
+    {
+        advance();
+    }
+}
+
+// The byte that has just come in - and the tape moves on to the next one
+int CASSETTE_GetByte(void)
+{
+    int byte;
+
+    catch_up();
+    if (!playing()) return 0;
+    byte = tape[records[CASSETTE_current_record].offset + byte_index];
+    CASSETTE_bytes_read++;
+    advance();
+    return byte;
+}
+
+// Scanlines until the next byte is in (POKEY then calls SIO_GetByte()) - 0 for never
+int CASSETTE_GetInputIRQDelay(void)
+{
+    int left;
+
+    catch_up();
+    if (!playing()) return 0;
+    left = (int) (due - cpu_clock);
+    return (left <= 0) ? 1 : (left + LINE_C - 1) / LINE_C;
+}
+
+// A POKEY reset (SKCTL) loses the byte coming in - the OS does it at the end
+// of the second $55 sync byte once it has the baud rate, so that one is never read
+void CASSETTE_ResetPOKEY(void)
+{
+    int left;
+
+    if (!playing()) return;
+    left = (int) (due - cpu_clock);
+    if (left > 0 && left < (int) byte_cycles(CASSETTE_current_record))
+    {
+        advance();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// The level on the serial input line for SKSTAT - the mark tone (1) in a gap
+// and with the motor stopped, otherwise the bit of the byte going by: the
+// start bit (0), the data bits lowest first and the stop bit (1).
+// ---------------------------------------------------------------------------
+int CASSETTE_IOLineStatus(void)
+{
+    const cas_record_t *rec;
+    unsigned int frame, into;
+    int left, bit;
+
+    if (!playing()) return 1;
+    rec = &records[CASSETTE_current_record];
+    frame = byte_cycles(CASSETTE_current_record);
+    left = (int) (due - cpu_clock);
+    if (left <= 0 || (unsigned int) left >= frame) return 1;
+    into = frame - left;
+    bit = into * 10 / frame;
+    if (bit == 0) return 0;
+    if (bit >= 9) return 1;
+    return (tape[rec->offset + byte_index] >> (bit - 1)) & 1;
+}
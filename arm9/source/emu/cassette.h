@@ -0,0 +1,59 @@
+/*
+ * CASSETTE.H contains the cassette (CAS tape image) emulation. See cassette.c.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _CASSETTE_H_
+#define _CASSETTE_H_
+
+#include "atari.h"
+
+extern int CASSETTE_hold_start_on_reboot;
+extern int CASSETTE_hold_start;
+extern int CASSETTE_press_space;         // Frames until Space is pressed for a cassette boot
+
+#define CASSETTE_SPACE_DELAY    60      // After START is seen - the OS's beep is over by then
+
+extern int  CASSETTE_record_count;      // Records on the tape inserted - 0 if there is none
+extern int  CASSETTE_current_record;    // The next one to be read
+extern ULONG CASSETTE_records_read;     // Handed over whole by the SIO patch
+extern ULONG CASSETTE_bytes_read;       // Handed over a byte at a time through POKEY
+
+extern int  CASSETTE_Insert(const char *filename);
+extern void CASSETTE_Remove(void);
+
+// The SIO patch - a whole record straight into memory. 1 if it was read and its
+// checksum is good, -1 if it was read but is bad and 0 at the end of the tape.
+extern int  CASSETTE_ReadToMemory(UWORD dest_addr, int length);
+
+// The C: handler's OPEN patches (ESC_COPENLOAD / ESC_COPENSAVE) - and the one
+// wait routine Altirra OS uses for the leader instead
+extern void CASSETTE_LeaderLoad(void);
+extern void CASSETTE_LeaderSave(void);
+extern void CASSETTE_LeaderWait(void);
+
+// The serial port - the motor is turned on with PACTL and the tape plays at its
+// own baud rate, a byte into SERIN whenever one has come in
+extern void CASSETTE_TapeMotor(int onoff);
+extern int  CASSETTE_GetByte(void);
+extern int  CASSETTE_GetInputIRQDelay(void);
+extern int  CASSETTE_IOLineStatus(void);
+extern int  CASSETTE_IsPlaying(void);
+extern void CASSETTE_ResetPOKEY(void);
+extern int  CASSETTE_IsSaveFile(void);
+extern void CASSETTE_PutByte(int byte);
+
+#endif // _CASSETTE_H_
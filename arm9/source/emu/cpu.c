@@ -81,8 +81,14 @@
 #include "cpu.h"
 #include "antic.h"
 #include "atari.h"
+#include "cassette.h"
 #include "memory.h"
 #include "esc.h"
+#include "gtia.h"
+#include "pia.h"
+#include "pokey.h"
+#include "profile.h"
+#include "sched.h"
 
 /* Windows headers define it */
 #undef ABSOLUTE
@@ -100,9 +106,16 @@
 #define GET_PC()            PC
 #define SET_PC(newpc)       (PC = (newpc))
 #define PHPC                PHW(PC)
+#ifdef CPU_BLOCK_CACHE
+/* Operand bytes come predecoded in 'operand' - PC is still stepped exactly as before */
+#define GET_CODE_BYTE()     (PC++, (UBYTE) operand)
+#define PEEK_CODE_BYTE()    ((UBYTE) operand)
+#define PEEK_CODE_WORD()    ((UWORD) operand)
+#else
 #define GET_CODE_BYTE()     dGetByte(PC++)
 #define PEEK_CODE_BYTE()    dGetByte(PC)
 #define PEEK_CODE_WORD()    dGetWord(PC)
+#endif
 
 /* Don't emulate the first write */
 #define RMW_GetByte(x, addr) x = GetByte(addr);
@@ -202,6 +215,7 @@ UBYTE cim_encountered = FALSE;
         int addr = (int) (SBYTE) IMMEDIATE; \
         addr += GET_PC(); \
         if ((addr ^ GET_PC()) & 0xff00) xpos++; \
+        if (addr < GET_PC() && myConfig.idle_skip) IDLE_CHECK(addr); \
         SET_PC(addr); \
         DONE \
     } \
@@ -265,6 +279,400 @@ static UBYTE cycles[256] __attribute__((section(".dtcm"))) =
     3, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7      /* Fx */
 };
 
+#ifdef CPU_STATS
+cpu_stats_t cpu_stats;
+#define STAT(x)     x
+#else
+#define STAT(x)
+#endif
+
+#ifdef CPU_PROFILE
+#define PROFILE(pc, insn)   PROFILE_Count(pc, insn)
+#else
+#define PROFILE(pc, insn)
+#endif
+
+#ifdef CPU_BLOCK_CACHE
+// -------------------------------------------------------------------------------------
+// Predecoded basic-block cache. Straight-line runs of 6502 code are decoded once into
+// an array of words (opcode in the low byte, operand bytes above it) so that GO() no
+// longer has to go through mem_map[] for the opcode and again for each operand byte.
+// A block is keyed by its start PC and the mem_map[] bank it was decoded from, so XE
+// and cartridge bank swaps simply miss instead of needing a flush. CPU writes to RAM
+// pages holding cached code go through a writemap[] hook which bumps the generation
+// of the 64 byte line written - so a variable sitting next to some code only costs
+// the blocks on its own line. Lines that keep getting written (self-modifying loops)
+// are handed back to the plain fetch.
+// -------------------------------------------------------------------------------------
+#define BB_MAX_OPS      16          // Instructions per block - at most 48 bytes so a block never spans more than 2 lines
+#define BB_ENTRIES      512         // Direct mapped on the start PC
+#define BB_LINE_SHIFT   6           // 64 byte lines for write tracking
+#define BB_LINES        (0x10000 >> BB_LINE_SHIFT)
+#define BB_SMC_LIMIT    16          // Writes over cached code before we stop caching that line
+#define BB_HASH(pc)     (((pc) ^ ((pc) >> 9)) & (BB_ENTRIES-1))
+
+#define E   0x80                    // Instruction ends a block (control flow, I flag changes, ESC/CIM)
+
+/*  0    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F */
+static const UBYTE oplen[256] =
+{
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   2,   1,   2,   3,   3,   3,   3,    /* 0x */
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* 1x */
+    E|3,   2, E|1,   2,   2,   2,   2,   2, E|1,   2,   1,   2,   3,   3,   3,   3,    /* 2x */
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* 3x */
+
+    E|1,   2, E|1,   2,   2,   2,   2,   2,   1,   2,   1,   2, E|3,   3,   3,   3,    /* 4x */
+    E|2,   2, E|1,   2,   2,   2,   2,   2, E|1,   3,   1,   3,   3,   3,   3,   3,    /* 5x */
+    E|1,   2, E|1,   2,   2,   2,   2,   2,   1,   2,   1,   2, E|3,   3,   3,   3,    /* 6x */
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* 7x */
+
+      2,   2,   2,   2,   2,   2,   2,   2,   1,   2,   1,   2,   3,   3,   3,   3,    /* 8x */
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* 9x */
+      2,   2,   2,   2,   2,   2,   2,   2,   1,   2,   1,   2,   3,   3,   3,   3,    /* Ax */
+    E|2,   2, E|1,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* Bx */
+
+      2,   2,   2,   2,   2,   2,   2,   2,   1,   2,   1,   2,   3,   3,   3,   3,    /* Cx */
+    E|2,   2, E|2,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3,    /* Dx */
+      2,   2,   2,   2,   2,   2,   2,   2,   1,   2,   1,   2,   3,   3,   3,   3,    /* Ex */
+    E|2,   2, E|2,   2,   2,   2,   2,   2,   1,   3,   1,   3,   3,   3,   3,   3     /* Fx */
+};
+#undef E
+
+typedef struct cpu_block
+{
+    UBYTE *bank;                    // mem_map[] entry the block was decoded from
+    ULONG gen[2];                   // line_gen[] of the first and last line when decoded
+    UWORD pc;                       // 6502 address of the first instruction
+    UWORD last_line;                // Line holding the last byte of the block
+    UBYTE count;                    // Number of predecoded instructions
+    ULONG link_epoch;               // The links below are only good while this matches bb_epoch
+    struct cpu_block *link[2];      // The last two blocks we went on to (taken and not-taken branch)
+    ULONG op[BB_MAX_OPS];           // Opcode in bits 0-7, operand bytes in bits 8-23
+} cpu_block_t;
+
+static cpu_block_t bb_cache[BB_ENTRIES];
+static ULONG line_gen[BB_LINES];    // Bumped whenever a line holding cached code may have changed
+static UBYTE line_code[BB_LINES];   // Non-zero if some block was decoded from this line since it was last written
+static UBYTE line_smc[BB_LINES];    // How many times cached code on this line was written over
+static UBYTE bb_nocache[BB_LINES];  // Lines we never decode from (zero page, stack, hardware hooks, busy self-modifying code)
+
+UBYTE bb_break __attribute__((section(".dtcm"))) = 0;          // Set by anything that may have changed the code under the running block
+ULONG bb_epoch __attribute__((section(".dtcm"))) = 1;          // Bumped on every invalidation or bank switch - drops all block links at once
+
+// Only the hooked (device) accesses can land us in code that flushes, swaps banks or
+// writes over cached code - so that is the only place GO() needs to look at bb_break.
+#define BB_CHECK_BREAK      if (bb_break) { bb_break = 0; bb_end = bb_op; }
+#undef GetByte
+#undef PutByte
+#define GetByte(addr)       (readmap[(addr) >> 8] ? ({ UBYTE _b = (*readmap[(addr) >> 8])(addr); BB_CHECK_BREAK; _b; }) : dGetByte(addr))
+#define PutByte(addr,byte)  do { if (writemap[(addr) >> 8]) { (*writemap[(addr) >> 8])(addr, byte); BB_CHECK_BREAK; } else dPutByte(addr, byte); } while (0)
+
+// -------------------------------------------------------------------------------------
+// Installed in writemap[] for every RAM page we have decoded code from. Plain data
+// writes just pay for the call - a write over a line with cached code invalidates
+// the blocks decoded from it.
+// -------------------------------------------------------------------------------------
+static void CodePage_PutByte(UWORD addr, UBYTE byte)
+{
+    UWORD line = addr >> BB_LINE_SHIFT;
+
+    if (line_code[line])
+    {
+        line_code[line] = 0;
+        line_gen[line]++;
+        if (++line_smc[line] >= BB_SMC_LIMIT) bb_nocache[line] = 1;
+        CPU_BreakBlock();           // We may have just written over what the current block is about to run
+        STAT(cpu_stats.block_smc++);
+    }
+    dPutByte(addr, byte);
+}
+
+static inline int CodeLine_Cacheable(UWORD line)
+{
+    UBYTE page = line >> (8 - BB_LINE_SHIFT);
+
+    if (bb_nocache[line]) return 0;
+    if (writemap[page] == NULL || writemap[page] == CodePage_PutByte || writemap[page] == ROM_PutByte) return 1;
+    bb_nocache[line] = 1;           // Some other device owns writes here - leave it to the plain fetch
+    return 0;
+}
+
+static inline void CodeLine_Watch(UWORD line)
+{
+    UBYTE page = line >> (8 - BB_LINE_SHIFT);
+
+    line_code[line] = 1;
+    if (writemap[page] == NULL) writemap[page] = CodePage_PutByte;  // ROM pages can't be written by the CPU so need no hook
+}
+
+// -------------------------------------------------------------------------------------
+// Decode the run of instructions starting at pc into its cache slot. Returns NULL if
+// nothing here can be cached and the caller should fetch the instruction directly.
+// -------------------------------------------------------------------------------------
+static cpu_block_t *CPU_DecodeBlock(UWORD pc)
+{
+    cpu_block_t *bb = &bb_cache[BB_HASH(pc)];
+    UWORD first = pc >> BB_LINE_SHIFT;
+    UWORD last = first;
+    UWORD addr = pc;
+    int count = 0;
+
+    if (!CodeLine_Cacheable(first)) return NULL;
+
+    while (count < BB_MAX_OPS)
+    {
+        UBYTE insn = dGetByte(addr);
+        UBYTE len = oplen[insn] & 3;
+        UWORD end = addr + len - 1;
+
+        if ((end ^ pc) & 0xF000) break;     // The bank key only covers the 4K the block starts in (this also stops 64K wraps)
+        if ((end >> BB_LINE_SHIFT) != last)
+        {
+            if (!CodeLine_Cacheable(end >> BB_LINE_SHIFT)) break;
+            last = end >> BB_LINE_SHIFT;
+        }
+
+        ULONG op = insn;
+        if (len > 1) op |= dGetByte(addr + 1) << 8;
+        if (len > 2) op |= dGetByte(addr + 2) << 16;
+        bb->op[count++] = op;
+
+        addr += len;
+        if (oplen[insn] & 0x80) break;
+    }
+
+    if (count == 0) return NULL;    // First instruction straddles a 4K boundary - very rare
+
+    CodeLine_Watch(first);
+    CodeLine_Watch(last);
+    bb->bank = mem_map[pc >> 12];
+    bb->pc = pc;
+    bb->count = count;
+    bb->last_line = last;
+    bb->link_epoch = 0;
+    bb->gen[0] = line_gen[first];
+    bb->gen[1] = line_gen[last];
+    STAT(cpu_stats.block_decodes++);
+
+    return bb;
+}
+
+static inline cpu_block_t *CPU_FindBlock(UWORD pc)
+{
+    cpu_block_t *bb = &bb_cache[BB_HASH(pc)];
+
+    if (bb->pc == pc && bb->bank == mem_map[pc >> 12] && bb->gen[0] == line_gen[pc >> BB_LINE_SHIFT] && bb->gen[1] == line_gen[bb->last_line])
+    {
+        STAT(cpu_stats.block_hits++);
+        return bb;
+    }
+    return CPU_DecodeBlock(pc);
+}
+
+// -------------------------------------------------------------------------------------
+// Find the block to run after 'from' has finished at pc. Most blocks end in a branch
+// so remembering the last two successors saves nearly all of the hash lookups.
+// -------------------------------------------------------------------------------------
+static inline cpu_block_t *CPU_NextBlock(cpu_block_t *from, UWORD pc)
+{
+    cpu_block_t *bb;
+
+    if (from && from->link_epoch == bb_epoch)
+    {
+        STAT(cpu_stats.block_links++);
+        if (from->link[0]->pc == pc) return from->link[0];
+        if (from->link[1] && from->link[1]->pc == pc) return from->link[1];
+        STAT(cpu_stats.block_links--);
+    }
+
+    if (bb_nocache[pc >> BB_LINE_SHIFT]) return NULL;
+
+    bb = CPU_FindBlock(pc);
+    if (bb && from)
+    {
+        if (from->link_epoch == bb_epoch) from->link[1] = from->link[0];
+        else from->link[1] = NULL;
+        from->link[0] = bb;
+        from->link_epoch = bb_epoch;
+    }
+    return bb;
+}
+
+// -------------------------------------------------------------------------------------
+// Throw everything away. Called whenever memory changes behind the CPU's back: the
+// RAM/ROM layout (SetRAM/SetROM), OS patching, ESC handlers (SIO, binary loader),
+// reset and state restore.
+// -------------------------------------------------------------------------------------
+void CPU_FlushBlockCache(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        if (writemap[i] == CodePage_PutByte) writemap[i] = NULL;
+    }
+    for (int i = 0; i < BB_LINES; i++)
+    {
+        line_gen[i]++;
+        line_code[i] = 0;
+        line_smc[i] = 0;
+        bb_nocache[i] = (i < (0x200 >> BB_LINE_SHIFT)); // Zero page and stack are written with dPutByte() which we can't watch
+    }
+    CPU_BreakBlock();
+    STAT(cpu_stats.block_flushes++);
+}
+#endif /* CPU_BLOCK_CACHE */
+
+// -------------------------------------------------------------------------------------
+// Idle-loop skipping. Lots of games wait for the vertical blank with something like
+// LDA VCOUNT / CMP #n / BNE or LDA RTCLOK / CMP / BEQ and burn the rest of every
+// scanline going round it. Each time a short backward branch is taken we remember
+// the registers, flags and xpos. If the same branch comes round again with exactly
+// the same state, and the loop body only reads (RAM or hardware registers that
+// cannot change until GO() returns), then every further trip round is identical
+// until the next scheduled event - so we move xpos forward by as many whole trips
+// as fit before sched_limit, the point where the next NMI, IRQ or other event is
+// due and GO() returns to let it in. The result is cycle for cycle what the
+// interpreter would have produced. Turned off per game with IDLE SKIP.
+// -------------------------------------------------------------------------------------
+#define IDLE_MAX_BYTES  32          // Longest loop body (target up to and including the branch) we look at
+
+static UWORD idle_pc    __attribute__((section(".dtcm"))) = 0;         // PC just past the branch we last took backwards
+static UWORD idle_bad   __attribute__((section(".dtcm"))) = 0;         // Last loop we found we can't skip (this GO() call only)
+static UWORD idle_good  __attribute__((section(".dtcm"))) = 0;         // Last loop we found we can skip (this GO() call only)...
+static UBYTE idle_vcount __attribute__((section(".dtcm"))) = 0;        // ...and whether it reads VCOUNT
+static ULONG idle_regs  __attribute__((section(".dtcm"))) = 0;         // A, X, Y and S at that time
+static ULONG idle_flags __attribute__((section(".dtcm"))) = 0;         // N, Z, C and P at that time
+static int   idle_xpos  __attribute__((section(".dtcm"))) = 0;         // xpos at that time
+
+ULONG idle_cycles_skipped = 0;
+ULONG idle_loops_skipped = 0;
+
+#define IDLE_CHECK(target) \
+    { \
+        ULONG regs = A | (X << 8) | (Y << 16) | (S << 24); \
+        ULONG flags = N | (Z << 8) | (C << 16) | (regP << 24); \
+        if (GET_PC() == idle_pc && regs == idle_regs && flags == idle_flags) CPU_IdleSkip(target); \
+        idle_pc = GET_PC(); idle_regs = regs; idle_flags = flags; idle_xpos = xpos; \
+    }
+
+// Can an absolute read from here be repeated without changing anything? Sets *vcount
+// if it is the one hardware register whose value moves part way through a scanline.
+static int CPU_IdleRead(UWORD addr, int *vcount)
+{
+    rdfunc dev = readmap[addr >> 8];
+
+    if (dev == NULL) return 1;                                      // Plain RAM or ROM
+    if (dev == ANTIC_GetByte)
+    {
+        if ((addr & 0x0f) == 0x0b) *vcount = 1;                     // VCOUNT
+        return 1;
+    }
+    if (dev == GTIA_GetByte)                                        // Collisions, triggers, PAL - but not CONSOL
+    {
+        return ((addr & 0x1f) < 0x08) || ((addr & 0x1f) >= 0x10 && (addr & 0x1f) != 0x1f);
+    }
+    if (dev == POKEY_GetByte)                                       // Anything but RANDOM - or SKSTAT while
+    {                                                               // a tape is playing into its serial input bit
+        if ((addr & 0x0f) == 0x0f) return !CASSETTE_IsPlaying();
+        return (addr & 0x0f) != 0x0a;
+    }
+    if (dev == PIA_GetByte) return 1;
+    return 0;
+}
+
+// Walk the loop body from the branch target to the branch. Only loads, compares,
+// logic ops, register transfers and branches that stay inside the body are allowed.
+static int CPU_IdleBody(UWORD start, UWORD end, int *vcount)
+{
+    UWORD addr = start;
+    ULONG insns = 0, dests = 0;     // Bit n set: an instruction starts / a branch lands at start+n
+
+    if ((UWORD) (end - start) > IDLE_MAX_BYTES) return 0;
+
+    while (addr < end)
+    {
+        UBYTE insn = dGetByte(addr);
+        insns |= 1u << (addr - start);
+        switch (insn)
+        {
+            case 0x18: case 0x38: case 0xb8: case 0xea:                                 // CLC SEC CLV NOP
+            case 0xaa: case 0xa8: case 0x8a: case 0x98:                                 // TAX TAY TXA TYA
+            case 0x0a: case 0x4a: case 0x2a: case 0x6a:                                 // ASL LSR ROL ROR A
+                addr += 1;
+                break;
+
+            case 0xa9: case 0xa2: case 0xa0: case 0xc9: case 0xe0: case 0xc0:           // Immediate
+            case 0x29: case 0x09: case 0x49:
+            case 0xa5: case 0xa6: case 0xa4: case 0xc5: case 0xe4: case 0xc4:           // Zero page
+            case 0x25: case 0x05: case 0x45: case 0x24:
+            case 0xb5: case 0xb6: case 0xb4: case 0xd5: case 0x35: case 0x15: case 0x55: // Zero page indexed
+                addr += 2;
+                break;
+
+            case 0xad: case 0xae: case 0xac: case 0xcd: case 0xec: case 0xcc:           // Absolute
+            case 0x2d: case 0x0d: case 0x4d: case 0x2c:
+                if (!CPU_IdleRead(dGetWord((UWORD) (addr + 1)), vcount)) return 0;
+                addr += 3;
+                break;
+
+            case 0xbd: case 0xb9: case 0xbe: case 0xbc: case 0xdd: case 0xd9:           // Absolute indexed - RAM only
+            case 0x3d: case 0x39: case 0x1d: case 0x19: case 0x5d: case 0x59:
+                {
+                    UWORD base = dGetWord((UWORD) (addr + 1));
+                    if (readmap[base >> 8] || readmap[(UWORD) (base + 0xff) >> 8]) return 0;
+                }
+                addr += 3;
+                break;
+
+            case 0x10: case 0x30: case 0x50: case 0x70:                                 // Branches
+            case 0x90: case 0xb0: case 0xd0: case 0xf0:
+                {
+                    UWORD dest = addr + 2 + (SBYTE) dGetByte((UWORD) (addr + 1));
+                    if (dest < start || dest > end - 2) return 0;
+                    dests |= 1u << (dest - start);
+                }
+                addr += 2;
+                break;
+
+            default:
+                return 0;
+        }
+    }
+    return (addr == end) && !(dests & ~insns);
+}
+
+// The branch has come round with the same registers and flags it had last time -
+// see how many more trips round we can account for in one go.
+static void __attribute__((noinline)) CPU_IdleSkip(UWORD target)
+{
+    int period = xpos - idle_xpos;
+
+    if (period <= 0 || GET_PC() == idle_bad) return;
+    if (GET_PC() != idle_good)
+    {
+        int vcount = 0;
+        if (!CPU_IdleBody(target, GET_PC(), &vcount))
+        {
+            idle_bad = GET_PC();
+            return;
+        }
+        idle_good = GET_PC();
+        idle_vcount = vcount;
+    }
+
+    // Every instruction of a trip that ends at or before the horizon starts below it, so
+    // the interpreter would have run all of them. VCOUNT changes value at LINE_C.
+    int horizon = sched_limit;
+    if (idle_vcount && xpos < LINE_C && LINE_C < horizon) horizon = LINE_C;
+
+    int trips = (horizon - xpos) / period;
+    if (trips > 0)
+    {
+        xpos += trips * period;
+        idle_cycles_skipped += trips * period;
+        idle_loops_skipped++;
+    }
+}
+
 int __attribute__((noinline))  CPU_Go_Startup(int limit)
 {
     if (wsync_halt) {
@@ -274,6 +682,8 @@ int __attribute__((noinline))  CPU_Go_Startup(int limit)
         wsync_halt = 0;
     }
     xpos_limit = limit;         /* needed for WSYNC store inside ANTIC */
+    SCHED_Run();                /* fire anything already due and set sched_limit */
+    idle_pc = idle_bad = idle_good = 0; /* idle loops are only tracked within one call */
     return 0;
 }
 
@@ -369,6 +779,9 @@ ITCM_CODE void GO(int limit)
     UWORD addr;
     UBYTE data;
     UBYTE S;
+#ifdef CPU_BLOCK_CACHE
+    ULONG operand;
+#endif
 #define insn data
 
 /*
@@ -384,14 +797,45 @@ ITCM_CODE void GO(int limit)
 
     UPDATE_LOCAL_REGS;
 
+#ifdef CPU_BLOCK_CACHE
+    const ULONG *bb_op = NULL;      // Next predecoded instruction to run...
+    const ULONG *bb_end = NULL;     // ...and one past the last in this block
+    cpu_block_t *bb_cur = NULL;     // The block they belong to
+    bb_break = 0;
+#endif
+
     CPUCHECKIRQ;
 
 // A jump to the next instruction will land us here just before the test on xpos
 next:
     
-    if (xpos < xpos_limit) 
+    if (xpos < sched_limit) 
     {
+        STAT(cpu_stats.insns++);
+#ifdef CPU_BLOCK_CACHE
+        if (bb_op == bb_end)
+        {
+            bb_cur = CPU_NextBlock(bb_cur, PC);
+            if (bb_cur == NULL)
+            {
+                // Not cacheable - fetch straight from memory as the plain interpreter would
+                STAT(cpu_stats.uncached++);
+                insn = dGetByte(PC);
+                operand = dGetWord((UWORD) (PC + 1));
+                goto fetched;
+            }
+            bb_op = bb_cur->op;
+            bb_end = bb_cur->op + bb_cur->count;
+        }
+        operand = *bb_op++;
+        insn = (UBYTE) operand;
+        operand >>= 8;
+    fetched:
+        PC++;
+#else
         insn = GET_CODE_BYTE();
+#endif
+        PROFILE((UWORD) (PC - 1), insn);
         xpos += cycles[insn];
         goto *opcode[insn];
         
@@ -1762,6 +2206,7 @@ next:
         UPDATE_GLOBAL_REGS;
         CPU_GetStatus();
         ESC_Run(data);
+        CPU_FlushBlockCache();      /* ESC handlers (SIO, loaders) write memory directly */
         CPU_PutStatus();
         UPDATE_LOCAL_REGS;
         data = PL;
@@ -1774,6 +2219,7 @@ next:
         UPDATE_GLOBAL_REGS;
         CPU_GetStatus();
         ESC_Run(data);
+        CPU_FlushBlockCache();      /* ESC handlers (SIO, loaders) write memory directly */
         CPU_PutStatus();
         UPDATE_LOCAL_REGS;
         DONE
@@ -1904,6 +2350,31 @@ next:
         DONE
     }
 
+    // Stopped short of xpos_limit because a scheduled event (POKEY timer...) is due - fire it and carry on.
+    // An IRQ taken here can come back to a wait loop with the same registers and flags, so track idle
+    // loops afresh - otherwise the next trip's period would take in the IRQ's cycles.
+    if (xpos < xpos_limit)
+    {
+        SCHED_Run();
+        CPUCHECKIRQ;
+        idle_pc = idle_bad = idle_good = 0;
+#ifdef CPU_BLOCK_CACHE
+        bb_end = bb_op;             // An IRQ may have moved PC - refetch the block
+#endif
+        goto next;
+    }
+
+    // Got to xpos_limit on a visible line - ANTIC runs the stage due there and sets the next
+    // limit (see ANTIC_SliceNext), and we carry on as a new call would.
+    if (antic_slicing && ANTIC_SliceNext())
+    {
+        CPUCHECKIRQ;
+#ifdef CPU_BLOCK_CACHE
+        bb_end = bb_op;             // An IRQ may have moved PC - refetch the block
+#endif
+        goto next;
+    }
+
     UPDATE_GLOBAL_REGS;
 }
 
@@ -1913,6 +2384,8 @@ void CPU_Initialise(void)
 
 void CPU_Reset(void)
 {
+    CPU_FlushBlockCache();
+
     IRQ = 0;
 
     regP = 0x34;        /* The unused bit is always 1, I flag set! */
@@ -29,6 +29,14 @@
 
 #include "atari.h"
 
+// ------------------------------------------------------------------------------
+// The predecoded basic-block cache is off unless CPU_BLOCK_CACHE is defined -
+// it costs BSS and a writemap hook, it has not been timed on the DS and on the
+// host it runs a little slower than the plain fetch-decode interpreter (make
+// bench-cpu builds both to time them, make compare-cpu checks they give the
+// same hashes). Define CPU_STATS to count instructions and cache activity.
+// ------------------------------------------------------------------------------
+
 #define N_FLAG 0x80
 #define V_FLAG 0x40
 #define B_FLAG 0x10
@@ -43,6 +51,7 @@ void CPU_PutStatus(void);
 void CPU_Reset(void);
 void NMI(void);
 void GO(int limit);
+int CPU_Go_Startup(int limit);
 #define GenerateIRQ() (IRQ = 1)
 
 extern UWORD regPC;
@@ -97,4 +106,31 @@ extern UBYTE cim_encountered;
 
 #define CPU_cim_encountered cim_encountered
 
+#ifdef CPU_BLOCK_CACHE
+extern UBYTE bb_break;
+extern ULONG bb_epoch;
+void CPU_FlushBlockCache(void);
+#define CPU_BreakBlock()        (bb_break = 1, bb_epoch++)  /* Stop running the current block - the next instruction is looked up again */
+#else
+#define CPU_FlushBlockCache()
+#define CPU_BreakBlock()
+#endif
+
+extern ULONG idle_cycles_skipped;      /* 6502 cycles fast-forwarded over by the idle-loop detector */
+extern ULONG idle_loops_skipped;       /* ...and how many times it kicked in */
+
+#ifdef CPU_STATS
+typedef struct
+{
+    unsigned long long insns;   /* 6502 instructions executed */
+    ULONG block_hits;           /* Blocks found in the cache */
+    ULONG block_links;          /* ...of which found by following the previous block's link */
+    ULONG block_decodes;        /* Blocks (re)decoded from memory */
+    ULONG block_smc;            /* Writes that landed on a page holding cached code */
+    ULONG block_flushes;        /* Full cache flushes (bank/ROM changes, ESC, reset) */
+    ULONG uncached;             /* Instructions fetched without the cache */
+} cpu_stats_t;
+extern cpu_stats_t cpu_stats;
+#endif
+
 #endif /* _CPU_H_ */
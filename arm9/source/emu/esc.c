@@ -50,6 +50,7 @@
 */
 
 #include "atari.h"
+#include "cassette.h"
 #include "cpu.h"
 #include "esc.h"
 #include "memory.h"
@@ -69,20 +70,6 @@
 static UWORD esc_address[256];
 static ESC_FunctionType esc_function[256];
 
-int CASSETTE_hold_start_on_reboot = 0;
-int CASSETTE_hold_start = 0;
-int CASSETTE_press_space = 0;
-
-void CASSETTE_LeaderLoad(void){}
-void CASSETTE_LeaderSave(void){}
-int CASSETTE_GetByte(void){return 0;}
-int CASSETTE_IOLineStatus(void){return 0;}
-int CASSETTE_GetInputIRQDelay(void){return 0;}
-int CASSETTE_IsSaveFile(void){return 0;}
-void CASSETTE_PutByte(int byte){}
-void CASSETTE_TapeMotor(int onoff){}
-
-
 void ESC_ClearAll(void)
 {
     int i;
@@ -96,6 +83,7 @@ void ESC_Add(UWORD address, UBYTE esc_code, ESC_FunctionType function)
     esc_function[esc_code] = function;
     dPutByte(address, 0xf2);            /* ESC */
     dPutByte(address + 1, esc_code);    /* ESC CODE */
+    CPU_FlushBlockCache();
 }
 
 void ESC_AddEscRts(UWORD address, UBYTE esc_code, ESC_FunctionType function)
@@ -105,6 +93,7 @@ void ESC_AddEscRts(UWORD address, UBYTE esc_code, ESC_FunctionType function)
     dPutByte(address, 0xf2);            /* ESC */
     dPutByte(address + 1, esc_code);    /* ESC CODE */
     dPutByte(address + 2, 0x60);        /* RTS */
+    CPU_FlushBlockCache();
 }
 
 /* 0xd2 is ESCRTS, which works same as pair of ESC and RTS (I think so...).
@@ -119,6 +108,7 @@ void ESC_AddEscRts2(UWORD address, UBYTE esc_code, ESC_FunctionType function)
     esc_function[esc_code] = function;
     dPutByte(address, 0xd2);            /* ESCRTS */
     dPutByte(address + 1, esc_code);    /* ESC CODE */
+    CPU_FlushBlockCache();
 }
 
 void ESC_Remove(UBYTE esc_code)
@@ -150,7 +140,7 @@ void ESC_PatchOS(void)
         case Atari800_MACHINE_OSA:
         case Atari800_MACHINE_OSB:
             if (myConfig.os_type == OS_ALTIRRA_800)
-                addr_l = 0xef91; /* Altirra Cassettle Handler*/
+                addr_l = 0xef9d; /* Altirra Cassette Handler - its wait routine */
             else
                 addr_l = 0xef74; /* Atari */                
             addr_s = 0xefbc;
@@ -160,7 +150,7 @@ void ESC_PatchOS(void)
         case Atari800_MACHINE_XLXE:
             if (myConfig.os_type == OS_ALTIRRA_XL)
             {
-                addr_l = 0xee4a;
+                addr_l = 0xee69; /* Altirra Cassette Handler - its wait routine */
             }
             else
             {
@@ -184,6 +174,13 @@ void ESC_PatchOS(void)
             ESC_Add(addr_l, ESC_COPENLOAD, CASSETTE_LeaderLoad);
             ESC_Add(addr_s, ESC_COPENSAVE, CASSETTE_LeaderSave);
         }
+        /* Altirra OS times the leader, and its other cassette delays, in one
+           routine (LDA #$01 STA $0317 and then its SETVBV) - patch that instead */
+        else if (dGetByte(addr_l)     == 0xa9 && dGetByte(addr_l + 1) == 0x01
+              && dGetByte(addr_l + 2) == 0x8d && dGetByte(addr_l + 3) == 0x17
+              && dGetByte(addr_l + 4) == 0x03) {
+            ESC_Add(addr_l, ESC_COPENLOAD, CASSETTE_LeaderWait);
+        }
         ESC_AddEscRts(0xe459, ESC_SIOV, SIO_Handler);
         patched = TRUE;
     }
@@ -203,6 +200,7 @@ void ESC_PatchOS(void)
         //dPutByte(0xc319, 0x8e);
         //dPutByte(0xc31a, 0xff);
     }
+    CPU_FlushBlockCache();  /* Callers have usually just copied a fresh OS into place */
 }
 
 void ESC_UpdatePatches(void)
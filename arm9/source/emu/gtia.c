@@ -51,6 +51,7 @@
 #include "atari.h"
 #include <string.h>
 #include "antic.h"
+#include "cassette.h"
 #include "esc.h"
 #include "gtia.h"
 #include "input.h"
@@ -117,14 +118,6 @@ void set_prior(UBYTE byte);         /* in antic.c */
 #define collisions_mask_missile_player     0x0f
 #define collisions_mask_player_player      0x0f
 
-#define P1PL_T P1PL
-#define P2PL_T P2PL
-#define P3PL_T P3PL
-#define M0PL_T M0PL
-#define M1PL_T M1PL
-#define M2PL_T M2PL
-#define M3PL_T M3PL
-
 extern UBYTE player_dma_enabled;
 extern UBYTE missile_dma_enabled;
 extern UBYTE player_gra_enabled;
@@ -136,7 +129,7 @@ UBYTE *hposp_ptr[4] __attribute__((section(".dtcm")));
 UBYTE *hposm_ptr[4] __attribute__((section(".dtcm")));
 ULONG hposp_mask[4] __attribute__((section(".dtcm")));
 
-ULONG *grafp_lookup = (ULONG*)0x068A0000;   // Using 4K here for lookup table... ULONG[4][256]
+ULONG *grafp_lookup = (ULONG*)VRAM_I;        // Using 4K here for lookup table... ULONG[4][256]
 
 ULONG *grafp_ptr[4] __attribute__((section(".dtcm")));
 int global_sizem[4] __attribute__((section(".dtcm")));
@@ -157,6 +150,15 @@ bit 7 - Missile 3
 UBYTE pm_scanline[ATARI_WIDTH / 2 + 8] __attribute__((section(".dtcm")));   /* there's a byte for every *pair* of pixels */
 UBYTE pm_dirty  __attribute__((section(".dtcm"))) = TRUE;
 
+/* pm_scanline[pm_span_lo..pm_span_hi) holds every player and missile pixel on
+   the line - empty when pm_span_lo >= pm_span_hi. Clearing the line touches
+   only that much, and the playfield kernels draw what lies either side of it
+   without looking at pm_scanline at all. Starts out as the whole line. */
+UWORD pm_span_lo __attribute__((section(".dtcm"))) = 0;
+UWORD pm_span_hi __attribute__((section(".dtcm"))) = ATARI_WIDTH / 2;
+ULONG pm_span_lines = 0;        /* lines with a player or missile shown... */
+ULONG pm_span_bytes = 0;        /* ...and the total width of their spans */
+
 #define C_PM0   0x01
 #define C_PM1   0x02
 #define C_PM01  0x03
@@ -233,15 +235,86 @@ void GTIA_Initialise(void) {
   POTENA=0;
 }
 
-#define update_partial_pmpl_colls()
+/* Player/missile collisions ----------------------------------------------
+
+   The playfield collisions (PF0PM..PF3PM) come for free out of the draw
+   kernels, but the player-player and missile-player ones used to be OR-ed
+   in pixel by pixel while pm_scanline was built - on every scanline, for
+   registers most games read a few times a frame if at all. Now
+   new_pm_scanline() only notes, for the lines where a player and some
+   other object are both shown, each object's pixels as a 32-bit mask and
+   its offset into pm_scanline. Two objects touch if one mask shifted onto
+   the other has a bit in common, so update_partial_pmpl_colls() works the
+   registers out from that log when M0PL..P3PL are read (or the log fills)
+   with no per-pixel work at all. HITCLR throws the log away along with the
+   registers. With the per-game COLLISIONS option off nothing is logged and
+   all 16 collision registers read as zero. */
+
+#define PMPL_LOG_LINES  64
+
+typedef struct {
+    ULONG mask[8];              /* players 0-3 then missiles 0-3 */
+    SWORD pos[8];               /* offset of bit 0 into pm_scanline */
+    UBYTE shown;                /* bit per object, as in pm_scanline */
+} pmpl_line_t;
+
+static pmpl_line_t pmpl_log[PMPL_LOG_LINES];
+static int pmpl_lines = 0;
+
+static inline int pm_overlap(const pmpl_line_t *line, int a, int b)
+{
+    int d = line->pos[b] - line->pos[a];
+    if (d >= 0)
+        return d < 32 && (line->mask[a] & (line->mask[b] << d));
+    return d > -32 && ((line->mask[a] << -d) & line->mask[b]);
+}
+
+void update_partial_pmpl_colls(void)
+{
+    UBYTE ppl[4] = {0, 0, 0, 0};
+    UBYTE mpl[4] = {0, 0, 0, 0};
+    int i;
+
+    for (i = 0; i < pmpl_lines; i++) {
+        const pmpl_line_t *line = &pmpl_log[i];
+        int a;
+        int b;
+        for (b = 1; b < 4; b++)
+            if (line->shown & (1 << b))
+                for (a = 0; a < b; a++)
+                    if ((line->shown & (1 << a)) && pm_overlap(line, a, b))
+                        ppl[b] |= 1 << a;
+        for (b = 4; b < 8; b++)
+            if (line->shown & (1 << b))
+                for (a = 0; a < 4; a++)
+                    if ((line->shown & (1 << a)) && pm_overlap(line, a, b))
+                        mpl[b - 4] |= 1 << a;
+    }
+    pmpl_lines = 0;
+
+    /* PnPL holds the lower numbered players n hit - see GTIA_GetByte() */
+    P1PL |= ppl[1];
+    P2PL |= ppl[2];
+    P3PL |= ppl[3];
+    M0PL |= mpl[0];
+    M1PL |= mpl[1];
+    M2PL |= mpl[2];
+    M3PL |= mpl[3];
+}
 
 /* Prepare PMG scanline ---------------------------------------------------- */
 
 ITCM_CODE void new_pm_scanline(void)
 {
-/* Clear if necessary */
+    pmpl_line_t *line = &pmpl_log[pmpl_lines];     /* kept only if two objects can touch */
+    UBYTE shown = 0;
+    int lo = ATARI_WIDTH / 2;
+    int hi = 0;
+
+/* Clear if necessary - only the span the last line used */
     if (pm_dirty) {
-        memset(pm_scanline, 0, ATARI_WIDTH / 2);
+        if (pm_span_lo < pm_span_hi)
+            memset(pm_scanline + pm_span_lo, 0, pm_span_hi - pm_span_lo);
         pm_dirty = FALSE;
     }
 
@@ -252,27 +325,38 @@ ITCM_CODE void new_pm_scanline(void)
     if (grafp) {                                            \
         UBYTE *ptr = hposp_ptr[n];                          \
         pm_dirty = TRUE;                                    \
+        shown |= 1 << n;                                    \
+        line->mask[n] = grafp;                              \
+        line->pos[n] = ptr - pm_scanline;                   \
+        if (line->pos[n] < lo)                              \
+            lo = line->pos[n];                              \
         do {                                                \
             if (grafp & 1)                                  \
-                P##n##PL_T |= *ptr |= 1 << n;               \
+                *ptr |= 1 << n;                             \
             ptr++;                                          \
             grafp >>= 1;                                    \
         } while (grafp);                                    \
+        if (ptr - pm_scanline > hi)                         \
+            hi = ptr - pm_scanline;                         \
     }                                                       \
 }
 
-    /* optimized DO_PLAYER(0): pm_scanline is clear and P0PL is unused */
+    /* optimized DO_PLAYER(0): pm_scanline is clear */
     if (GRAFP0) {
         ULONG grafp = grafp_ptr[0][GRAFP0] & hposp_mask[0];
         if (grafp) {
             UBYTE *ptr = hposp_ptr[0];
             pm_dirty = TRUE;
+            shown = 1;
+            line->mask[0] = grafp;
+            line->pos[0] = lo = ptr - pm_scanline;
             do {
                 if (grafp & 1)
                     *ptr = 1;
                 ptr++;
                 grafp >>= 1;
             } while (grafp);
+            hi = ptr - pm_scanline;
         }
     }
 
@@ -297,10 +381,18 @@ ITCM_CODE void new_pm_scanline(void)
     }                                               \
     else if (ptr + j > pm_scanline + ATARI_WIDTH / 2 - 2)   \
         j = pm_scanline + ATARI_WIDTH / 2 - 2 - ptr;        \
-    if (j > 0)                                      \
+    if (j > 0) {                                    \
+        shown |= p;                                 \
+        line->mask[4 + n] = (1 << j) - 1;           \
+        line->pos[4 + n] = ptr - pm_scanline;       \
+        if (line->pos[4 + n] < lo)                  \
+            lo = line->pos[4 + n];                  \
         do                                          \
-            M##n##PL_T |= *ptr++ |= p;              \
+            *ptr++ |= p;                            \
         while (--j);                                \
+        if (ptr - pm_scanline > hi)                 \
+            hi = ptr - pm_scanline;                 \
+    }                                               \
 }
 
     if (GRAFM) {
@@ -310,6 +402,24 @@ ITCM_CODE void new_pm_scanline(void)
         DO_MISSILE(1, 0x20, 0x0c, 0x08, 0x04)
         DO_MISSILE(0, 0x10, 0x03, 0x02, 0x01)
     }
+
+/* A player moved off the left edge starts before pm_scanline, with its bits
+   there masked off - see DO_HPOSP */
+    if (lo < 0)
+        lo = 0;
+    pm_span_lo = lo;
+    pm_span_hi = hi;
+    if (lo < hi) {
+        pm_span_lines++;
+        pm_span_bytes += hi - lo;
+    }
+
+/* Log the line if a player and another object were shown on it */
+    if ((shown & 0x0f) && (shown & (shown - 1)) && !myConfig.collision_disable) {
+        line->shown = shown;
+        if (++pmpl_lines == PMPL_LOG_LINES)
+            update_partial_pmpl_colls();
+    }
 }
 
 /* GTIA registers ---------------------------------------------------------- */
@@ -330,6 +440,9 @@ void GTIA_Frame(void) {
 
 UBYTE GTIA_GetByte(UWORD addr)
 {
+    if (myConfig.collision_disable && (addr & 0x1f) <= _P3PL)
+        return 0;
+
     switch (addr & 0x1f) {
     case _M0PF:
         return (((PF0PM & 0x10) >> 4)
@@ -419,9 +532,10 @@ UBYTE GTIA_GetByte(UWORD addr)
             UBYTE byte = consol_table[consol_index] & consol_mask;
             if (consol_index > 0) {
                 consol_index--;
-                if (consol_index == 0 && CASSETTE_hold_start) {
-                    /* press Space after Start to start cassette boot */
-                    CASSETTE_press_space = 1;
+                if (CASSETTE_hold_start) {
+                    /* press Space after Start to start cassette boot
+                       (the first read - Altirra's 800 OS only reads it once) */
+                    CASSETTE_press_space = CASSETTE_SPACE_DELAY;
                     CASSETTE_hold_start = CASSETTE_hold_start_on_reboot;
                 }
             }
@@ -632,6 +746,7 @@ void GTIA_PutByte(UWORD addr, UBYTE byte)
     DO_GRAFP(3)
 
     case _HITCLR:
+        pmpl_lines = 0;
         M0PL = M1PL = M2PL = M3PL = 0;
         P0PL = P1PL = P2PL = P3PL = 0;
         PF0PM = PF1PM = PF2PM = PF3PM = 0;
@@ -168,6 +168,7 @@ extern UBYTE PM_Width[4];
 void GTIA_Initialise(void);
 void GTIA_Frame(void);
 void new_pm_scanline(void);
+void update_partial_pmpl_colls(void);
 UBYTE GTIA_GetByte(UWORD addr);
 void GTIA_PutByte(UWORD addr, UBYTE byte);
 
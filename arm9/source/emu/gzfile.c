@@ -0,0 +1,669 @@
+/*
+ * GZFILE.C contains the gzip image layer. Disk, executable and cartridge
+ * images compressed with gzip take a fraction of the room on the SD card and
+ * a fraction of the reading - which is most of the time it takes to start a
+ * game. GZ_fopen() hands back a FILE like fopen() does, so SIO_Mount(),
+ * BINLOAD_Loader() and CART_Insert() need no changes beyond calling it: for a
+ * gzip file the FILE is a read-only stream of the uncompressed image that a
+ * small built-in inflater (RFC 1951/1952 - no zlib on the DS) fills in as it
+ * is read.
+ *
+ * Reading straight through - a cartridge, a XEX, a disk image going into the
+ * SIO RAM cache - just inflates as it goes. Seeking forward inflates and
+ * throws away what is skipped. Seeking back has to start again from somewhere
+ * the inflater can pick up from: the start of the stream, or one of the
+ * checkpoints taken every GZ_SPACING bytes once a stream has seeked back
+ * somewhere past the first of them - the input position and bit buffer, the
+ * block being decoded and its Huffman codes, and the 32K window that back
+ * references may reach into. They fall between any two symbols rather than
+ * only on block boundaries, as gzip -9 can make a block of a well compressed
+ * disk image hundreds of K long. So a disk image too big for the SIO cache
+ * only inflates from the checkpoint before the sector it wants.
+ *
+ * The CRC in the gzip trailer is checked the first time a stream is read
+ * through to its end, and a damaged stream reads as an error rather than
+ * handing bad data to the emulation.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#define _GNU_SOURCE                     // fopencookie()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "gzfile.h"
+
+#define GZ_WINDOW       32768           // Furthest a deflate back reference reaches
+#define GZ_WINDOW_MASK  (GZ_WINDOW - 1)
+#define GZ_INBUF        4096            // Compressed bytes read from the card at a time
+#define GZ_SPACING      (64 * 1024)     // Uncompressed bytes between checkpoints
+#define GZ_MAX_POINTS   16              // Checkpoints per stream - a 1MB image's worth
+#define GZ_FAST_BITS    9               // Huffman codes up to this long decode with one table lookup
+
+// fopencookie() takes a 64-bit offset where the C library has large file support
+#if defined(__NEWLIB__) && !defined(__LARGE64_FILES)
+#define GZ_OFF_T        off_t
+#elif defined(__NEWLIB__)
+#define GZ_OFF_T        _off64_t
+#else
+#define GZ_OFF_T        off64_t
+#endif
+
+#define MODE_HEADER     0               // Next up is a block header
+#define MODE_STORED     1               // In an uncompressed block
+#define MODE_CODES      2               // In a Huffman coded block
+#define MODE_DONE       3
+#define MODE_ERROR      4
+
+ULONG GZ_bytes_inflated = 0;
+ULONG GZ_restarts = 0;
+ULONG GZ_checkpoints = 0;
+
+typedef struct
+{
+    short count[16];                    // Codes of each length
+    short symbol[288];                  // Symbols in canonical code order
+    unsigned short fast[1 << GZ_FAST_BITS]; // Symbol << 4 | length for each short code, bit reversed - 0 for longer ones
+} huff_t;
+
+typedef struct
+{
+    ULONG in_pos;                       // File offset of the first byte not yet in bitbuf
+    unsigned int bitbuf;
+    int bitcnt;
+    ULONG out;
+    int mode, last;
+    int stored_left;
+    huff_t *codes;                      // Copy of a dynamic block's lencode and distcode - NULL otherwise
+    UBYTE *window;
+} gz_point_t;
+
+typedef struct
+{
+    FILE *f;
+    ULONG data_start;                   // File offset of the deflate stream
+    ULONG size;                         // Uncompressed size, from the gzip trailer
+    ULONG crc_want;
+    unsigned int crc;
+    int crc_on;                         // Inflating from the very start - the CRC will mean something
+    ULONG pos;                          // Where the reader is in the uncompressed image
+
+    UBYTE inbuf[GZ_INBUF];
+    int in_len, in_idx;
+    ULONG in_pos;                       // File offset just past inbuf[in_len - 1]
+    unsigned int bitbuf;
+    int bitcnt;
+    int mode, last;
+    int stored_left;
+    int copy_len, copy_dist;            // Back reference still to copy
+    const huff_t *lcode, *dcode;
+    ULONG out;                          // Bytes inflated so far
+    huff_t lencode, distcode;
+    UBYTE window[GZ_WINDOW];
+
+    int indexing;
+    ULONG next_point;                   // Where the next checkpoint is due
+    int npoints;
+    gz_point_t point[GZ_MAX_POINTS];
+} gz_t;
+
+static const short lbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const short lext[29]  = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const short dbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const short dext[30]  = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const short order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static huff_t fixed_len, fixed_dist;
+static unsigned int crc_table[256];
+static int tables_ready = 0;
+
+// ---------------------------------------------------------------------------
+// Build the canonical Huffman code for a set of code lengths. Returns 0 for a
+// complete code, more than 0 for an incomplete one and less than 0 for one
+// with more codes than there is room for.
+// ---------------------------------------------------------------------------
+static int construct(huff_t *h, const short *length, int n)
+{
+    short offs[16];
+    int left = 1, code = 0, index = 0;
+
+    memset(h->count, 0, sizeof(h->count));
+    for (int sym = 0; sym < n; sym++) h->count[length[sym]]++;
+    memset(h->fast, 0, sizeof(h->fast));
+    if (h->count[0] == n) return 0;
+
+    for (int len = 1; len < 16; len++)
+    {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) return left;
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h->count[len];
+    for (int sym = 0; sym < n; sym++)
+        if (length[sym] != 0) h->symbol[offs[length[sym]]++] = sym;
+
+    // Deflate sends codes first bit first, so the lookup is by the bits reversed
+    for (int len = 1; len <= GZ_FAST_BITS; len++)
+    {
+        for (int i = 0; i < h->count[len]; i++)
+        {
+            int rev = 0;
+            for (int b = 0; b < len; b++) rev |= ((code + i) >> b & 1) << (len - 1 - b);
+            for (int fill = rev; fill < (1 << GZ_FAST_BITS); fill += 1 << len)
+                h->fast[fill] = (h->symbol[index + i] << 4) | len;
+        }
+        code = (code + h->count[len]) << 1;
+        index += h->count[len];
+    }
+    return left;
+}
+
+static void init_tables(void)
+{
+    short lengths[288];
+    int i;
+
+    for (i = 0; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+    construct(&fixed_len, lengths, 288);
+    for (i = 0; i < 30; i++) lengths[i] = 5;
+    construct(&fixed_dist, lengths, 30);
+
+    for (i = 0; i < 256; i++)
+    {
+        unsigned int c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+    tables_ready = 1;
+}
+
+// ---------------------------------------------------------------------------
+// Bits come out of the compressed stream lowest first.
+// ---------------------------------------------------------------------------
+static void fill(gz_t *z)
+{
+    while (z->bitcnt <= 24)
+    {
+        if (z->in_idx == z->in_len)
+        {
+            z->in_len = fread(z->inbuf, 1, GZ_INBUF, z->f);
+            z->in_idx = 0;
+            if (z->in_len <= 0) { z->in_len = 0; return; }
+            z->in_pos += z->in_len;
+        }
+        z->bitbuf |= (unsigned int) z->inbuf[z->in_idx++] << z->bitcnt;
+        z->bitcnt += 8;
+    }
+}
+
+// Take n bits (n <= 16) - or -1 if the stream ends first
+static int getbits(gz_t *z, int n)
+{
+    int v;
+    if (z->bitcnt < n)
+    {
+        fill(z);
+        if (z->bitcnt < n) return -1;
+    }
+    v = z->bitbuf & ((1u << n) - 1);
+    z->bitbuf >>= n;
+    z->bitcnt -= n;
+    return v;
+}
+
+static int decode(gz_t *z, const huff_t *h)
+{
+    int e, code = 0, first = 0, index = 0;
+
+    if (z->bitcnt < GZ_FAST_BITS) fill(z);
+    e = h->fast[z->bitbuf & ((1 << GZ_FAST_BITS) - 1)];
+    if (e != 0 && (e & 15) <= z->bitcnt)
+    {
+        z->bitbuf >>= e & 15;
+        z->bitcnt -= e & 15;
+        return e >> 4;
+    }
+
+    // A longer code, or the end of the stream is near - a bit at a time
+    for (int len = 1; len < 16; len++)
+    {
+        if (z->bitcnt == 0)
+        {
+            fill(z);
+            if (z->bitcnt == 0) return -1;
+        }
+        code |= z->bitbuf & 1;
+        z->bitbuf >>= 1;
+        z->bitcnt--;
+        int count = h->count[len];
+        if (code - count < first) return h->symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Read the code length codes and then the literal/length and distance codes
+// of a dynamic block into lencode and distcode.
+// ---------------------------------------------------------------------------
+static int dynamic(gz_t *z)
+{
+    short lengths[320];
+    int nlen, ndist, ncode, index, err;
+
+    nlen = getbits(z, 5);
+    ndist = getbits(z, 5);
+    ncode = getbits(z, 4);
+    if (nlen < 0 || ndist < 0 || ncode < 0) return -1;
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > 286 || ndist > 30) return -1;
+
+    for (index = 0; index < ncode; index++)
+    {
+        int len = getbits(z, 3);
+        if (len < 0) return -1;
+        lengths[order[index]] = len;
+    }
+    for (; index < 19; index++) lengths[order[index]] = 0;
+    if (construct(&z->lencode, lengths, 19) != 0) return -1;
+
+    index = 0;
+    while (index < nlen + ndist)
+    {
+        int sym = decode(z, &z->lencode), len = 0, rep;
+        if (sym < 0) return -1;
+        if (sym < 16)
+        {
+            lengths[index++] = sym;
+            continue;
+        }
+        if (sym == 16)
+        {
+            if (index == 0) return -1;
+            len = lengths[index - 1];
+            rep = getbits(z, 2);
+            if (rep >= 0) rep += 3;
+        }
+        else if (sym == 17)
+        {
+            rep = getbits(z, 3);
+            if (rep >= 0) rep += 3;
+        }
+        else
+        {
+            rep = getbits(z, 7);
+            if (rep >= 0) rep += 11;
+        }
+        if (rep < 0 || index + rep > nlen + ndist) return -1;
+        while (rep--) lengths[index++] = len;
+    }
+    if (lengths[256] == 0) return -1;
+
+    // An incomplete code is only allowed when it is a single code
+    err = construct(&z->lencode, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - z->lencode.count[0] != 1)) return -1;
+    err = construct(&z->distcode, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - z->distcode.count[0] != 1)) return -1;
+    return 0;
+}
+
+static void next_point(gz_t *z)
+{
+    ULONG last = z->npoints ? z->point[z->npoints - 1].out : 0;
+    z->next_point = (z->npoints == GZ_MAX_POINTS) ? 0xffffffffu : last + GZ_SPACING;
+}
+
+// ---------------------------------------------------------------------------
+// Remember where the inflater is - between two symbols, with no back
+// reference part copied - so a seek back can start from here rather than
+// from the top.
+// ---------------------------------------------------------------------------
+static void checkpoint(gz_t *z)
+{
+    gz_point_t *p = &z->point[z->npoints];
+    int dynamic_codes = (z->mode == MODE_CODES && z->lcode == &z->lencode);
+
+    p->window = (UBYTE *) malloc(GZ_WINDOW);
+    p->codes = dynamic_codes ? (huff_t *) malloc(2 * sizeof(huff_t)) : NULL;
+    if (p->window == NULL || (dynamic_codes && p->codes == NULL))
+    {
+        free(p->window);                                // Just means longer seeks
+        z->next_point = 0xffffffffu;
+        return;
+    }
+    memcpy(p->window, z->window, GZ_WINDOW);
+    if (dynamic_codes)
+    {
+        p->codes[0] = z->lencode;
+        p->codes[1] = z->distcode;
+    }
+    p->in_pos = z->in_pos - (z->in_len - z->in_idx);
+    p->bitbuf = z->bitbuf;
+    p->bitcnt = z->bitcnt;
+    p->out = z->out;
+    p->mode = z->mode;
+    p->last = z->last;
+    p->stored_left = z->stored_left;
+    z->npoints++;
+    GZ_checkpoints++;
+    next_point(z);
+}
+
+// Pick the inflater up from a checkpoint - or from the start if p is NULL
+static void restore(gz_t *z, const gz_point_t *p)
+{
+    z->in_pos = p ? p->in_pos : z->data_start;
+    fseek(z->f, z->in_pos, SEEK_SET);
+    z->in_len = z->in_idx = 0;
+    z->bitbuf = p ? p->bitbuf : 0;
+    z->bitcnt = p ? p->bitcnt : 0;
+    z->out = p ? p->out : 0;
+    if (p) memcpy(z->window, p->window, GZ_WINDOW);
+    z->mode = p ? p->mode : MODE_HEADER;
+    z->last = p ? p->last : 0;
+    z->stored_left = p ? p->stored_left : 0;
+    z->copy_len = 0;
+    z->lcode = &fixed_len;
+    z->dcode = &fixed_dist;
+    if (p && p->codes)
+    {
+        z->lencode = p->codes[0];
+        z->distcode = p->codes[1];
+        z->lcode = &z->lencode;
+        z->dcode = &z->distcode;
+    }
+    next_point(z);
+    z->crc_on = (p == NULL);
+    z->crc = 0xffffffffu;
+}
+
+#define PUT(b)  { UBYTE _b = (b); z->window[z->out++ & GZ_WINDOW_MASK] = _b; if (dest) dest[done] = _b; done++; }
+
+// ---------------------------------------------------------------------------
+// Inflate up to want bytes (no more than the window) into dest, or nowhere if
+// dest is NULL. Returns how many - 0 at the end of the stream, -1 on an error.
+// ---------------------------------------------------------------------------
+static int inflate_some(gz_t *z, UBYTE *dest, int want)
+{
+    int done = 0, sym, len, dist;
+
+    while (done < want)
+    {
+        if (z->indexing && z->out >= z->next_point && z->copy_len == 0 && z->mode <= MODE_CODES) checkpoint(z);
+        if (z->copy_len)
+        {
+            int n = want - done;
+            if (n > z->copy_len) n = z->copy_len;
+            z->copy_len -= n;
+            ULONG from = z->out - z->copy_dist;
+            while (n--) PUT(z->window[from++ & GZ_WINDOW_MASK]);
+            continue;
+        }
+        switch (z->mode)
+        {
+        case MODE_HEADER:
+            if (z->last)
+            {
+                z->mode = MODE_DONE;
+                break;
+            }
+            z->last = getbits(z, 1);
+            switch (getbits(z, 2))
+            {
+            case 0:
+                z->bitbuf >>= z->bitcnt & 7;                // Stored blocks start on a byte
+                z->bitcnt -= z->bitcnt & 7;
+                len = getbits(z, 16);
+                dist = getbits(z, 16);
+                if (len < 0 || dist < 0 || len != (~dist & 0xffff)) { z->mode = MODE_ERROR; break; }
+                z->stored_left = len;
+                z->mode = MODE_STORED;
+                break;
+            case 1:
+                z->lcode = &fixed_len;
+                z->dcode = &fixed_dist;
+                z->mode = MODE_CODES;
+                break;
+            case 2:
+                if (dynamic(z) < 0) { z->mode = MODE_ERROR; break; }
+                z->lcode = &z->lencode;
+                z->dcode = &z->distcode;
+                z->mode = MODE_CODES;
+                break;
+            default:
+                z->mode = MODE_ERROR;
+            }
+            if (z->last < 0) z->mode = MODE_ERROR;
+            break;
+        case MODE_STORED:
+            while (z->stored_left && done < want)
+            {
+                if ((sym = getbits(z, 8)) < 0) { z->mode = MODE_ERROR; break; }
+                PUT(sym);
+                z->stored_left--;
+            }
+            if (z->mode == MODE_STORED && z->stored_left == 0) z->mode = MODE_HEADER;
+            break;
+        case MODE_CODES:
+            sym = decode(z, z->lcode);
+            if (sym < 256)
+            {
+                if (sym < 0) { z->mode = MODE_ERROR; break; }
+                PUT(sym);
+                break;
+            }
+            if (sym == 256)
+            {
+                z->mode = MODE_HEADER;
+                break;
+            }
+            sym -= 257;
+            if (sym >= 29 || (len = getbits(z, lext[sym])) < 0) { z->mode = MODE_ERROR; break; }
+            len += lbase[sym];
+            sym = decode(z, z->dcode);
+            if (sym < 0 || sym >= 30 || (dist = getbits(z, dext[sym])) < 0) { z->mode = MODE_ERROR; break; }
+            dist += dbase[sym];
+            if ((ULONG) dist > z->out) { z->mode = MODE_ERROR; break; }
+            z->copy_len = len;
+            z->copy_dist = dist;
+            break;
+        case MODE_DONE:
+            return done;
+        default:
+            return -1;
+        }
+    }
+    return done;
+}
+
+// ---------------------------------------------------------------------------
+// inflate_some() plus the CRC of what came out - over the window, where all
+// of it still is - checked against the trailer once the stream ends.
+// ---------------------------------------------------------------------------
+static int inflate_chunk(gz_t *z, UBYTE *dest, int want)
+{
+    ULONG start = z->out;
+    int done = inflate_some(z, dest, want);
+
+    if (done < 0) return -1;
+    GZ_bytes_inflated += done;
+    if (z->crc_on)
+    {
+        unsigned int crc = z->crc;
+        for (ULONG i = start; i < z->out; i++)
+            crc = crc_table[(crc ^ z->window[i & GZ_WINDOW_MASK]) & 0xff] ^ (crc >> 8);
+        z->crc = crc;
+        if (z->mode == MODE_DONE && (~crc != z->crc_want || z->out != z->size))
+        {
+            z->mode = MODE_ERROR;
+            return -1;
+        }
+    }
+    return done;
+}
+
+// ---------------------------------------------------------------------------
+// The FILE side - reads land wherever the last seek left the reader.
+// ---------------------------------------------------------------------------
+static ssize_t gz_read(void *cookie, char *buf, size_t size)
+{
+    gz_t *z = (gz_t *) cookie;
+    size_t done = 0;
+
+    if (z->pos >= z->size) return 0;
+    if (size > z->size - z->pos) size = z->size - z->pos;
+
+    if (z->pos != z->out)
+    {
+        const gz_point_t *best = NULL;
+        for (int i = 0; i < z->npoints && z->point[i].out <= z->pos; i++) best = &z->point[i];
+        if (z->pos < z->out)
+        {
+            // Back - from the checkpoint before, and keep checkpoints from now on if it was a long way in
+            if (z->pos >= GZ_SPACING) z->indexing = 1;
+            restore(z, best);
+            GZ_restarts++;
+        }
+        else if (best != NULL && best->out > z->out)
+        {
+            restore(z, best);
+        }
+        while (z->out < z->pos)
+        {
+            ULONG skip = z->pos - z->out;
+            int n = inflate_chunk(z, NULL, skip > GZ_WINDOW ? GZ_WINDOW : (int) skip);
+            if (n <= 0) return -1;
+        }
+    }
+
+    while (done < size)
+    {
+        size_t want = size - done;
+        int n = inflate_chunk(z, (UBYTE *) buf + done, want > GZ_WINDOW ? GZ_WINDOW : (int) want);
+        if (n < 0) return -1;
+        if (n == 0) break;
+        done += n;
+    }
+    z->pos += done;
+    return done;
+}
+
+static int gz_seek(void *cookie, GZ_OFF_T *offset, int whence)
+{
+    gz_t *z = (gz_t *) cookie;
+    long target = (long) *offset;
+
+    if (whence == SEEK_CUR) target += z->pos;
+    else if (whence == SEEK_END) target += z->size;
+    if (target < 0) return -1;
+    z->pos = target;
+    *offset = target;
+    return 0;
+}
+
+static int gz_close(void *cookie)
+{
+    gz_t *z = (gz_t *) cookie;
+    for (int i = 0; i < z->npoints; i++)
+    {
+        free(z->point[i].window);
+        free(z->point[i].codes);
+    }
+    GZ_checkpoints -= z->npoints;
+    fclose(z->f);
+    free(z);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Read past the gzip header (RFC 1952) and the 8 byte trailer's CRC and size.
+// ---------------------------------------------------------------------------
+static FILE *gz_open(FILE *f)
+{
+    UBYTE hdr[10], trailer[8];
+    cookie_io_functions_t io = {gz_read, NULL, gz_seek, gz_close};
+    gz_t *z;
+    FILE *fp;
+    int c;
+
+    fseek(f, 0, SEEK_SET);
+    if (fread(hdr, 1, 10, f) != 10 || hdr[2] != 8 || (hdr[3] & 0xe0)) return NULL;
+    if (hdr[3] & 4)                                             // FEXTRA
+    {
+        int xlen = fgetc(f);
+        xlen |= fgetc(f) << 8;
+        fseek(f, xlen, SEEK_CUR);
+    }
+    if (hdr[3] & 8) while ((c = fgetc(f)) > 0);                 // FNAME
+    if (hdr[3] & 16) while ((c = fgetc(f)) > 0);                // FCOMMENT
+    if (hdr[3] & 2) fseek(f, 2, SEEK_CUR);                      // FHCRC
+    if (feof(f)) return NULL;
+
+    z = (gz_t *) calloc(1, sizeof(gz_t));
+    if (z == NULL) return NULL;
+    z->f = f;
+    z->data_start = ftell(f);
+    if (fseek(f, -8, SEEK_END) != 0 || fread(trailer, 1, 8, f) != 8 || (ULONG) ftell(f) < z->data_start + 8)
+    {
+        free(z);
+        return NULL;
+    }
+    z->crc_want = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((ULONG) trailer[3] << 24);
+    z->size = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | ((ULONG) trailer[7] << 24);
+
+    if (!tables_ready) init_tables();
+    restore(z, NULL);
+    fp = fopencookie(z, "rb", io);
+    if (fp == NULL) free(z);
+    return fp;
+}
+
+int GZ_IsCompressed(const char *filename)
+{
+    UBYTE magic[2];
+    FILE *f = fopen(filename, "rb");
+    int gz;
+
+    if (f == NULL) return 0;
+    gz = (fread(magic, 1, 2, f) == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+    fclose(f);
+    return gz;
+}
+
+FILE *GZ_fopen(const char *filename, const char *mode)
+{
+    FILE *f, *fp;
+
+    if (!GZ_IsCompressed(filename)) return fopen(filename, mode);
+    if (strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+')) return NULL;
+
+    f = fopen(filename, "rb");
+    if (f == NULL) return NULL;
+    fp = gz_open(f);
+    if (fp == NULL) fclose(f);
+    return fp;
+}
@@ -0,0 +1,39 @@
+/*
+ * GZFILE.H contains the gzip image layer - .ATR/.ATX/.XEX/.CAR/.ROM images
+ * compressed with gzip (.gz, .atz) opened as an ordinary read-only FILE that
+ * inflates as it is read. See gzfile.c.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _GZFILE_H_
+#define _GZFILE_H_
+
+#include <stdio.h>
+#include "atari.h"
+
+// ------------------------------------------------------------------------------
+// Opens a file the way fopen() does - unless it is gzip compressed, in which case
+// it comes back as a read-only stream of the uncompressed image (and asking for
+// write access gets NULL, so callers fall back to "rb" and treat it as locked).
+// ------------------------------------------------------------------------------
+extern FILE *GZ_fopen(const char *filename, const char *mode);
+extern int   GZ_IsCompressed(const char *filename);
+
+extern ULONG GZ_bytes_inflated;         // Everything inflated - including what a seek skipped over
+extern ULONG GZ_restarts;               // Seeks back that restarted from a checkpoint or the start
+extern ULONG GZ_checkpoints;            // Checkpoints held across all open streams
+
+#endif // _GZFILE_H_
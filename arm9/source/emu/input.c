@@ -49,6 +49,7 @@
 #include "atari.h"
 #include "esc.h"
 #include "cartridge.h"
+#include "cassette.h"
 #include "cpu.h"
 #include "gtia.h"
 #include "input.h"
@@ -96,10 +97,10 @@ void INPUT_Frame(void)
 
     if (key_code < 0) 
     {
-        if (CASSETTE_press_space) 
+        /* the OS beeps first - and may flush the keyboard - so count down to the press */
+        if (CASSETTE_press_space && --CASSETTE_press_space == 0) 
         {
             key_code = AKEY_SPACE;
-            CASSETTE_press_space = 0;
         }
         else 
         {
@@ -65,7 +65,7 @@
 #include "util.h"
 
 UBYTE memory[0x10000] __attribute__ ((aligned (0x1000)));               // This is the main Atari 8-bit memory which is 64K in length and we align to a 4K boundary
-UBYTE *under_atarixl_os = (UBYTE *)(0x06898000+0x0000);                 // We use 16K of VRAM here as it's a little faster but also to free up normal RAM resources
+UBYTE *under_atarixl_os = (UBYTE *)VRAM_H;                               // We use 16K of VRAM here as it's a little faster but also to free up normal RAM resources
 
 UBYTE fast_page[0x1000] __attribute__((section(".dtcm")));              // Fast memory which we will map to a common 4K of main memory (zero page)
 
@@ -324,6 +324,7 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
             mem_map[0x5] = memory_bank;
             mem_map[0x6] = memory_bank;
             mem_map[0x7] = memory_bank;
+            CPU_BreakBlock();   // We may be running code in the window we just swapped out
             
             xe_bank = bank;
         }
@@ -380,6 +381,7 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
             {
                 dFillMem(0xc000, 0xff, 0x1000);
                 dFillMem(0xd800, 0xff, 0x2800);
+                CPU_FlushBlockCache();
             }
             /* When OS ROM is disabled we also have to disable Self Test - Jindroush */
             if (selftest_enabled) 
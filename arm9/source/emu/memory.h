@@ -48,6 +48,7 @@
 #include <string.h> /* memcpy, memset */
 
 #include "atari.h"
+#include "cpu.h"
 
 #define dGetWord(x)                     (dGetByte(x) | (dGetByte((x) + 1) << 8))
 #define dPutWord(x, y)                  (dPutByte(x,(UBYTE)y), dPutByte(x+1, (UBYTE) ((y) >> 8)))
@@ -125,6 +126,7 @@ void ROM_PutByte(UWORD addr, UBYTE byte);
             readmap[i] = NULL; \
             writemap[i] = NULL; \
         } \
+        CPU_FlushBlockCache(); \
     } while (0)
 #define SetROM(addr1, addr2) do { \
         int i; \
@@ -132,6 +134,7 @@ void ROM_PutByte(UWORD addr, UBYTE byte);
             readmap[i] = NULL; \
             writemap[i] = ROM_PutByte; \
         } \
+        CPU_FlushBlockCache(); \
     } while (0)
 
 
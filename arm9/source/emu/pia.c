@@ -48,6 +48,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <nds.h>
 #include "atari.h"
 #include "cpu.h"
 #include "memory.h"
@@ -64,7 +65,7 @@ UBYTE PORT_input[2] __attribute__((section(".dtcm")));
 int xe_bank __attribute__((section(".dtcm")))= 0;
 int selftest_enabled = 0;
 
-UBYTE *atari_os = (UBYTE *)(0x06898000+0x4000);
+UBYTE *atari_os = (UBYTE *)VRAM_H + 0x4000;
 
 UBYTE PORTA_mask __attribute__((section(".dtcm")));
 UBYTE PORTB_mask __attribute__((section(".dtcm")));
@@ -58,10 +58,36 @@
 #include "input.h"
 #include "pokeysnd.h"
 #include "antic.h"
+#include "cassette.h"
 #include "esc.h"
+#include "sched.h"
 
 unsigned short pokeyBufIdx __attribute__((section(".dtcm")))= 0;
-char pokey_buffer[SNDLENGTH] __attribute__((section(".dtcm")));
+char pokey_buffer[SNDLENGTH] __attribute__((aligned(4)));     /* too big for DTCM once stereo doubles it */
+
+/* Sound is rendered pokey_batch_lines scanlines' worth of samples at a time
+   rather than at the end of every line. An audio register write made while
+   samples are owed is logged with the sample it lands before and replayed
+   in between them, so the output is the same as rendering each line's
+   samples as it ends. A line owes pokey_line_halves/2 samples - 1 at the
+   classic 15.7K rate, 1.5 and 2 at the higher rates. */
+#define POKEY_LOG_SIZE  64
+typedef struct
+{
+    UWORD sample;               /* samples owed when the write was made */
+    UBYTE addr;
+    UBYTE byte;
+} pokey_write_t;
+
+static pokey_write_t pokey_log[POKEY_LOG_SIZE];
+static int pokey_log_len __attribute__((section(".dtcm"))) = 0;
+static int pokey_owed __attribute__((section(".dtcm"))) = 0;
+static int pokey_lines __attribute__((section(".dtcm"))) = 0;
+static int pokey_half __attribute__((section(".dtcm"))) = 0;
+static int pokey_line_halves __attribute__((section(".dtcm"))) = 2;
+UBYTE pokey_batch_lines __attribute__((section(".dtcm"))) = POKEY_BATCH_LINES;
+ULONG pokey_batches = 0;
+ULONG pokey_writes_logged = 0;
 
 UBYTE KBCODE __attribute__((section(".dtcm")));
 UBYTE SERIN __attribute__((section(".dtcm")));
@@ -77,7 +103,7 @@ int DELAYED_XMTDONE_IRQ;
 UBYTE AUDF[4 * MAXPOKEYS] __attribute__((section(".dtcm")));  /* AUDFx (D200, D202, D204, D206) */
 UBYTE AUDC[4 * MAXPOKEYS] __attribute__((section(".dtcm")));  /* AUDCx (D201, D203, D205, D207) */
 UBYTE AUDCTL[MAXPOKEYS] __attribute__((section(".dtcm")));    /* AUDCTL (D208) */
-int DivNIRQ[4] __attribute__((section(".dtcm")));
+int DivNIRQ[4] __attribute__((section(".dtcm")));                 /* only used to carry the timer countdowns in and out of a save state */
 int DivNMax[4] __attribute__((section(".dtcm")));
 int Base_mult[MAXPOKEYS] __attribute__((section(".dtcm")));       /* selects either 64Khz or 15Khz clock mult */
 
@@ -105,6 +131,9 @@ ITCM_CODE UBYTE POKEY_GetByte(UWORD addr)
 {
     UBYTE byte = 0xff;
 
+    /* nothing to read from the second chip - as Atari800 has it */
+    if ((addr & _POKEY2) && Num_pokeys > 1)
+        return 0;
     addr &= 0x0f;
     switch (addr) {
     case _POT0:
@@ -179,25 +208,149 @@ static int POKEY_siocheck(void)
 #define SOUND_GAIN 4
 #endif
 
+/* n samples into the ring buffer, in two goes if it wraps. In stereo each
+   sample is a left and right byte pair, so an odd index left over from mono
+   play is first rounded up to the next pair. */
+static void POKEY_Render(int n)
+{
+    int shift = Num_pokeys - 1;
+
+    pokeyBufIdx = (pokeyBufIdx + shift) & (SNDLENGTH - 1 - shift);
+    while (n) {
+        int run = (SNDLENGTH - pokeyBufIdx) >> shift;
+        if (run > n)
+            run = n;
+        Pokey_process_ptr(&pokey_buffer[pokeyBufIdx], run);
+        pokeyBufIdx = (pokeyBufIdx + (run << shift)) & (SNDLENGTH - 1);
+        n -= run;
+    }
+}
+
+/* Render the samples owed, replaying the logged writes between them */
+ITCM_CODE void POKEY_RenderSound(void)
+{
+    int done = 0;
+    int i;
+
+    if (pokey_owed == 0)
+        return;
+    for (i = 0; i < pokey_log_len; i++) {
+        POKEY_Render(pokey_log[i].sample - done);
+        done = pokey_log[i].sample;
+        Update_pokey_sound(pokey_log[i].addr & 0x0f, pokey_log[i].byte, pokey_log[i].addr >> 4, SOUND_GAIN);
+    }
+    POKEY_Render(pokey_owed - done);
+    pokey_owed = pokey_lines = 0;
+    pokey_log_len = 0;
+    pokey_batches++;
+}
+
+/* A write with no samples owed goes straight to the sound core. addr has
+   _POKEY2 set for the second chip. */
+static void POKEY_SoundWrite(UBYTE addr, UBYTE byte)
+{
+    if (pokey_owed) {
+        if (pokey_log_len == POKEY_LOG_SIZE)
+            POKEY_RenderSound();
+        else {
+            pokey_log[pokey_log_len].sample = pokey_owed;
+            pokey_log[pokey_log_len].addr = addr;
+            pokey_log[pokey_log_len].byte = byte;
+            pokey_log_len++;
+            pokey_writes_logged++;
+            return;
+        }
+    }
+    Update_pokey_sound(addr & 0x0f, byte, addr >> 4, SOUND_GAIN);
+}
+
+/* The second POKEY of a stereo machine, at $D210-$D21F. Only its sound is
+   emulated - nothing here uses its timers, keyboard or serial port - but
+   its STIMER and SKCTL go to the sound core just as the first chip's do. */
+static void POKEY_PutByte2(UWORD addr, UBYTE byte)
+{
+    switch (addr) {
+    case _AUDF1:
+    case _AUDF2:
+    case _AUDF3:
+    case _AUDF4:
+        AUDF[CHIP2 + (addr >> 1)] = byte;
+        break;
+    case _AUDC1:
+    case _AUDC2:
+    case _AUDC3:
+    case _AUDC4:
+        AUDC[CHIP2 + (addr >> 1)] = byte;
+        break;
+    case _AUDCTL:
+        AUDCTL[1] = byte;
+        Base_mult[1] = (byte & CLOCK_15) ? DIV_15 : DIV_64;
+        break;
+    case _STIMER:
+    case _SKCTLS:
+        break;
+    default:
+        return;
+    }
+    POKEY_SoundWrite(addr | _POKEY2, byte);
+}
+
+/* POKEY timers 1, 2 and 4 underflow on their exact CPU cycle through the event
+   scheduler - but only while their IRQ is enabled, as that is all anyone can see
+   of them. Timer_base keeps the phase (a cycle on which the timer underflowed)
+   so a timer that is re-enabled picks up where the hardware would be. */
+#define TIMER_PERIOD(chan)  (DivNMax[chan] ? DivNMax[chan] : LINE_C)
+
+static const UBYTE timer_chan[SCHED_EVENTS] = {CHAN1, CHAN2, CHAN4};
+static const UBYTE timer_event[4] = {SCHED_TIMER1, SCHED_TIMER2, 0, SCHED_TIMER4};
+static const UBYTE timer_irq[4] = {0x01, 0x02, 0x00, 0x04};
+static unsigned int timer_base[4];
+
+static void POKEY_TimerEvent(int event)
+{
+    int chan = timer_chan[event];
+
+    IRQST &= ~timer_irq[chan];
+    GenerateIRQ();
+    timer_base[chan] = SCHED_When(event);
+    SCHED_Set(event, timer_base[chan] + TIMER_PERIOD(chan));
+}
+
+/* Schedule the next underflow of a timer from its phase - or drop it if its IRQ is off */
+static void POKEY_TimerArm(int chan)
+{
+    if (IRQEN & timer_irq[chan]) {
+        unsigned int now = cpu_clock;
+        unsigned int period = TIMER_PERIOD(chan);
+        SCHED_Set(timer_event[chan], now + period - (now - timer_base[chan]) % period);
+    }
+    else
+        SCHED_Cancel(timer_event[chan]);
+}
+
 ITCM_CODE void POKEY_PutByte(UWORD addr, UBYTE byte)
 {
+    if ((addr & _POKEY2) && Num_pokeys > 1) {
+        POKEY_PutByte2(addr & 0x0f, byte);
+        return;
+    }
     addr &= 0x0f;
     switch (addr) {
     case _AUDC1:
         AUDC[CHAN1] = byte;
-        Update_pokey_sound(_AUDC1, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDC1, byte);
         break;
     case _AUDC2:
         AUDC[CHAN2] = byte;
-        Update_pokey_sound(_AUDC2, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDC2, byte);
         break;
     case _AUDC3:
         AUDC[CHAN3] = byte;
-        Update_pokey_sound(_AUDC3, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDC3, byte);
         break;
     case _AUDC4:
         AUDC[CHAN4] = byte;
-        Update_pokey_sound(_AUDC4, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDC4, byte);
         break;
     case _AUDCTL:
         AUDCTL[0] = byte;
@@ -209,29 +362,36 @@ ITCM_CODE void POKEY_PutByte(UWORD addr, UBYTE byte)
             Base_mult[0] = DIV_64;
 
         Update_Counter((1 << CHAN1) | (1 << CHAN2) | (1 << CHAN3) | (1 << CHAN4));
-        Update_pokey_sound(_AUDCTL, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDCTL, byte);
         break;
     case _AUDF1:
         AUDF[CHAN1] = byte;
         Update_Counter((AUDCTL[0] & CH1_CH2) ? ((1 << CHAN2) | (1 << CHAN1)) : (1 << CHAN1));
-        Update_pokey_sound(_AUDF1, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDF1, byte);
         break;
     case _AUDF2:
         AUDF[CHAN2] = byte;
         Update_Counter(1 << CHAN2);
-        Update_pokey_sound(_AUDF2, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDF2, byte);
         break;
     case _AUDF3:
         AUDF[CHAN3] = byte;
         Update_Counter((AUDCTL[0] & CH3_CH4) ? ((1 << CHAN4) | (1 << CHAN3)) : (1 << CHAN3));
-        Update_pokey_sound(_AUDF3, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDF3, byte);
         break;
     case _AUDF4:
         AUDF[CHAN4] = byte;
         Update_Counter(1 << CHAN4);
-        Update_pokey_sound(_AUDF4, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_AUDF4, byte);
         break;
     case _IRQEN:
+        if ((IRQEN ^ byte) & 0x07) {
+            UBYTE changed = IRQEN ^ byte;
+            IRQEN = byte;
+            if (changed & 0x01) POKEY_TimerArm(CHAN1);
+            if (changed & 0x02) POKEY_TimerArm(CHAN2);
+            if (changed & 0x04) POKEY_TimerArm(CHAN4);
+        }
         IRQEN = byte;
         IRQST |= ~byte & 0xf7;  /* Reset disabled IRQs except XMTDONE */
         if (IRQEN & 0x20) {
@@ -282,14 +442,15 @@ ITCM_CODE void POKEY_PutByte(UWORD addr, UBYTE byte)
         };
         break;
     case _STIMER:
-        DivNIRQ[CHAN1] = DivNMax[CHAN1];
-        DivNIRQ[CHAN2] = DivNMax[CHAN2];
-        DivNIRQ[CHAN4] = DivNMax[CHAN4];
-        Update_pokey_sound(_STIMER, byte, 0, SOUND_GAIN);
+        timer_base[CHAN1] = timer_base[CHAN2] = timer_base[CHAN4] = cpu_clock;
+        POKEY_TimerArm(CHAN1);
+        POKEY_TimerArm(CHAN2);
+        POKEY_TimerArm(CHAN4);
+        POKEY_SoundWrite(_STIMER, byte);
         break;
     case _SKCTLS:
         SKCTLS = byte;
-        Update_pokey_sound(_SKCTLS, byte, 0, SOUND_GAIN);
+        POKEY_SoundWrite(_SKCTLS, byte);
         if (byte & 4)
             pot_scanline = 228; /* fast pot mode - return results immediately */
         if ((byte & 0x03) == 0) 
@@ -299,7 +460,7 @@ ITCM_CODE void POKEY_PutByte(UWORD addr, UBYTE byte)
             DELAYED_SERIN_IRQ = 0;
             DELAYED_SEROUT_IRQ = 0;
             DELAYED_XMTDONE_IRQ = 0;
-            //CASSETTE_ResetPOKEY();
+            CASSETTE_ResetPOKEY();
             /* TODO other registers should also be reset. */
         }
             
@@ -334,10 +495,18 @@ void POKEY_Initialise(void)
         Base_mult[i] = DIV_64;
     }
 
-    for (i = 0; i < 4; i++)
+    for (i = 0; i < 4; i++) {
         DivNIRQ[i] = DivNMax[i] = 0;
+        timer_base[i] = 0;
+    }
+    for (i = 0; i < SCHED_EVENTS; i++) {
+        SCHED_SetHandler(i, POKEY_TimerEvent);
+        SCHED_Cancel(i);
+    }
 
     pot_scanline = 0;
+    pokey_owed = pokey_lines = pokey_half = pokey_log_len = 0;
+    pokey_line_halves = SOUND_LINE_HALVES;
 
     /* initialise poly9_lookup */
     reg = 0x1ff;
@@ -357,18 +526,23 @@ void POKEY_Initialise(void)
 
 void POKEY_Frame(void) 
 {
+    POKEY_RenderSound();
     random_scanline_counter %= (AUDCTL[0] & POLY9) ? POLY9_SIZE : POLY17_SIZE;
 }
 
 /***************************************************************************
- ** Generate POKEY Timer IRQs if required                                 **
- ** called on a per-scanline basis, not very precise, but good enough     **
- ** for most applications                                                 **
+ ** Owe the scanline's sound sample, advance the pots and the random     **
+ ** counter and count down the serial port delays (in scanlines, as SIO   **
+ ** and the cassette code set them). The timer IRQs are scheduled events. **
  ***************************************************************************/
 ITCM_CODE void POKEY_Scanline(void) 
 {
-    Pokey_process(&pokey_buffer[pokeyBufIdx], 1);   // Each scanline, compute 1 output samples. This corresponds to a 15720Khz output sample rate if running at 60FPS (good enough)
-    pokeyBufIdx = (pokeyBufIdx+1) & (SNDLENGTH-1);
+    // One sample per scanline - a 15720Hz output sample rate at 60FPS (good enough) - or 1.5 or 2 at the higher rates, rendered a batch at a time
+    pokey_half += pokey_line_halves;
+    pokey_owed += pokey_half >> 1;
+    pokey_half &= 1;
+    if (++pokey_lines >= pokey_batch_lines)
+        POKEY_RenderSound();
 
     if (pot_scanline < 228)
         pot_scanline++;
@@ -377,6 +551,9 @@ ITCM_CODE void POKEY_Scanline(void)
 
     random_scanline_counter += LINE_C;
     
+    if (!(DELAYED_SERIN_IRQ | DELAYED_SEROUT_IRQ | DELAYED_XMTDONE_IRQ))
+        return;
+
     if (DELAYED_SERIN_IRQ > 0) 
     {
         if (--DELAYED_SERIN_IRQ == 0) 
@@ -422,30 +599,6 @@ ITCM_CODE void POKEY_Scanline(void)
 
         }
     }
-    
-    if ((DivNIRQ[CHAN1] -= LINE_C) < 0 ) {
-        DivNIRQ[CHAN1] += DivNMax[CHAN1];
-        if (IRQEN & 0x01) {
-            IRQST &= 0xfe;
-            GenerateIRQ();
-        }
-    }
-
-    if ((DivNIRQ[CHAN2] -= LINE_C) < 0 ) {
-        DivNIRQ[CHAN2] += DivNMax[CHAN2];
-        if (IRQEN & 0x02) {
-            IRQST &= 0xfd;
-            GenerateIRQ();
-        }
-    }
-
-    if ((DivNIRQ[CHAN4] -= LINE_C) < 0 ) {
-        DivNIRQ[CHAN4] += DivNMax[CHAN4];
-        if (IRQEN & 0x04) {
-            IRQST &= 0xfb;
-            GenerateIRQ();
-        }
-    }
 }
 
 /*****************************************************************************/
@@ -520,10 +673,31 @@ ITCM_CODE void Update_Counter(int chan_mask)
     }
 }
 
+/* Save states carry each timer as the number of cycles to its next underflow */
 void POKEYStateSave(void)
 {
+    unsigned int now = cpu_clock;
+
+    for (int event = 0; event < SCHED_EVENTS; event++) {
+        int chan = timer_chan[event];
+        unsigned int period = TIMER_PERIOD(chan);
+        if (sched_pending & (1 << event))
+            DivNIRQ[chan] = SCHED_When(event) - now;
+        else
+            DivNIRQ[chan] = period - (now - timer_base[chan]) % period;
+    }
 }
 
 void POKEYStateRead(void)
 {
+    unsigned int now = cpu_clock;
+
+    for (int event = 0; event < SCHED_EVENTS; event++) {
+        int chan = timer_chan[event];
+        int countdown = DivNIRQ[chan];
+        if (countdown <= 0 || countdown > TIMER_PERIOD(chan))
+            countdown = TIMER_PERIOD(chan);
+        timer_base[chan] = now + countdown - TIMER_PERIOD(chan);
+        POKEY_TimerArm(chan);
+    }
 }
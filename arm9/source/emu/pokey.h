@@ -106,6 +106,9 @@ void POKEY_PutByte(UWORD addr, UBYTE byte);
 void POKEY_Initialise(void);
 void POKEY_Frame(void);
 void POKEY_Scanline(void);
+void POKEY_RenderSound(void);
+void POKEYStateSave(void);
+void POKEYStateRead(void);
 
 #endif
 
@@ -139,6 +142,8 @@ void POKEY_Scanline(void);
 #define POLY9_SIZE  0x01ff
 #define POLY17_SIZE 0x0001ffff
 
+#define POKEY_BATCH_LINES 32 /* scanlines of sound rendered in one go - see POKEY_RenderSound() */
+
 #define MAXPOKEYS    2      /* max number of emulated chips - we support 2 for STEREO sound */
 
 /* channel/chip definitions */
@@ -154,6 +159,9 @@ void POKEY_Scanline(void);
 
 extern unsigned short pokeyBufIdx;
 extern char pokey_buffer[SNDLENGTH];
+extern UBYTE pokey_batch_lines;
+extern ULONG pokey_batches;
+extern ULONG pokey_writes_logged;
 extern UBYTE KBCODE;
 extern UBYTE SERIN;
 extern UBYTE IRQST;
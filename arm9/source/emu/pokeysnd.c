@@ -48,6 +48,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 #include <nds.h>
+#include <string.h>
 
 #include "atari.h"
 #include "pokeysnd.h"
@@ -71,6 +72,15 @@ uint8 AUDV[4 * MAXPOKEYS] __attribute__((section(".dtcm"))); /* Channel volume -
 uint8 Outbit[4 * MAXPOKEYS] __attribute__((section(".dtcm")));       /* current state of the output (high or low) */
 uint8 Outvol[4 * MAXPOKEYS] __attribute__((section(".dtcm")));       /* last output volume for each channel */
 
+/* The sound core's own copy of the audio registers. POKEY_PutByte() may log a
+   write to be replayed when the samples before it are rendered (see
+   POKEY_RenderSound()), so the synthesis can't look at AUDF, AUDC and AUDCTL
+   - those already hold the value after the write. */
+uint8 snd_AUDF[4 * MAXPOKEYS] __attribute__((section(".dtcm")));
+uint8 snd_AUDC[4 * MAXPOKEYS] __attribute__((section(".dtcm")));
+uint8 snd_AUDCTL[MAXPOKEYS] __attribute__((section(".dtcm")));
+int snd_Base_mult[MAXPOKEYS] __attribute__((section(".dtcm")));
+
 /* Initialze the bit patterns for the polynomials. */
 
 /* The 4bit and 5bit patterns are the identical ones used in the pokey chip. */
@@ -102,6 +112,90 @@ int32 snd_playback_freq = 22050;
 uint8 snd_num_pokeys = 1;
 static int snd_flags = 0;
 
+/* Band-limited step synthesis (SND_BLEP). Rather than taking whatever level
+   the channels hold at the instant of each sample, every change in the output
+   level is placed where it really happened between two samples and smeared
+   over BLEP_TAPS samples by a windowed-sinc impulse, one of BLEP_PHASES
+   copies each shifted by a fraction of a sample. The impulses are added into
+   a small ring and summed into the output as it is played, so a step costs
+   BLEP_TAPS multiply-adds and tones well above what the output rate can
+   carry no longer alias down into the audible range. The kernel is a
+   Blackman-windowed sinc cut off at 0.42 of the output rate, delaying the
+   sound by half its length; each phase sums to exactly 1 << 15 so the level
+   the steps add up to never drifts. 1K - small enough to keep in DTCM.
+   The output sits BLEP_BIAS above the classic level, as silence is the bottom
+   of the sample range and the ringing below a step would otherwise clip. */
+#define BLEP_PHASES 32
+#define BLEP_TAPS   16
+#define BLEP_BIAS   16
+
+static short blep_table[BLEP_PHASES][BLEP_TAPS] __attribute__((section(".dtcm"))) =
+{
+    {     0,    -9,   -10,   202,  -796,  1951, -3534,  5156, 27518,  4283, -3275,  1896,  -807,   219,   -19,    -7},
+    {     0,   -12,     0,   182,  -779,  1993, -3780,  6056, 27453,  3438, -3005,  1831,  -811,   234,   -27,    -5},
+    {     0,   -14,    10,   159,  -755,  2023, -4009,  6979, 27319,  2626, -2726,  1755,  -808,   246,   -34,    -3},
+    {     0,   -17,    22,   133,  -724,  2038, -4221,  7921, 27125,  1847, -2440,  1670,  -800,   255,   -40,    -1},
+    {     0,   -20,    34,   105,  -685,  2039, -4411,  8881, 26865,  1104, -2150,  1576,  -786,   262,   -46,     0},
+    {     1,   -23,    46,    74,  -639,  2024, -4578,  9853, 26543,   400, -1858,  1476,  -768,   266,   -50,     1},
+    {     1,   -26,    60,    40,  -586,  1994, -4719, 10835, 26158,  -264, -1566,  1369,  -744,   268,   -54,     2},
+    {     1,   -30,    73,     4,  -526,  1947, -4833, 11823, 25717,  -887, -1277,  1258,  -716,   268,   -57,     3},
+    {     1,   -33,    88,   -34,  -459,  1884, -4916, 12812, 25214, -1466,  -991,  1142,  -684,   265,   -59,     4},
+    {     2,   -36,   102,   -74,  -384,  1803, -4968, 13799, 24658, -2003,  -711,  1024,  -649,   261,   -60,     4},
+    {     2,   -40,   117,  -116,  -303,  1705, -4985, 14780, 24051, -2494,  -439,   903,  -611,   255,   -61,     4},
+    {     2,   -43,   132,  -159,  -215,  1590, -4966, 15751, 23391, -2941,  -176,   782,  -570,   247,   -61,     4},
+    {     3,   -46,   147,  -204,  -121,  1457, -4909, 16708, 22683, -3342,    77,   660,  -527,   238,   -61,     5},
+    {     3,   -49,   162,  -250,   -22,  1307, -4813, 17647, 21934, -3698,   318,   540,  -483,   228,   -60,     4},
+    {     3,   -52,   176,  -297,    83,  1141, -4676, 18564, 21144, -4009,   545,   421,  -437,   216,   -58,     4},
+    {     4,   -54,   190,  -344,   192,   958, -4497, 19455, 20316, -4275,   759,   305,  -391,   203,   -57,     4},
+    {     4,   -57,   203,  -391,   305,   759, -4275, 20316, 19455, -4497,   958,   192,  -344,   190,   -54,     4},
+    {     4,   -58,   216,  -437,   421,   545, -4009, 21144, 18564, -4676,  1141,    83,  -297,   176,   -52,     3},
+    {     4,   -60,   228,  -483,   540,   318, -3698, 21934, 17647, -4813,  1307,   -22,  -250,   162,   -49,     3},
+    {     5,   -61,   238,  -527,   660,    77, -3342, 22683, 16708, -4909,  1457,  -121,  -204,   147,   -46,     3},
+    {     4,   -61,   247,  -570,   782,  -176, -2941, 23391, 15751, -4966,  1590,  -215,  -159,   132,   -43,     2},
+    {     4,   -61,   255,  -611,   903,  -439, -2494, 24051, 14780, -4985,  1705,  -303,  -116,   117,   -40,     2},
+    {     4,   -60,   261,  -649,  1024,  -711, -2003, 24658, 13799, -4968,  1803,  -384,   -74,   102,   -36,     2},
+    {     4,   -59,   265,  -684,  1142,  -991, -1466, 25214, 12812, -4916,  1884,  -459,   -34,    88,   -33,     1},
+    {     3,   -57,   268,  -716,  1258, -1277,  -887, 25717, 11823, -4833,  1947,  -526,     4,    73,   -30,     1},
+    {     2,   -54,   268,  -744,  1369, -1566,  -264, 26158, 10835, -4719,  1994,  -586,    40,    60,   -26,     1},
+    {     1,   -50,   266,  -768,  1476, -1858,   400, 26543,  9853, -4578,  2024,  -639,    74,    46,   -23,     1},
+    {     0,   -46,   262,  -786,  1576, -2150,  1104, 26865,  8881, -4411,  2039,  -685,   105,    34,   -20,     0},
+    {    -1,   -40,   255,  -800,  1670, -2440,  1847, 27125,  7921, -4221,  2038,  -724,   133,    22,   -17,     0},
+    {    -3,   -34,   246,  -808,  1755, -2726,  2626, 27319,  6979, -4009,  2023,  -755,   159,    10,   -14,     0},
+    {    -5,   -27,   234,  -811,  1831, -3005,  3438, 27453,  6056, -3780,  1993,  -779,   182,     0,   -12,     0},
+    {    -7,   -19,   219,  -807,  1896, -3275,  4283, 27518,  5156, -3534,  1951,  -796,   202,   -10,    -9,     0},
+};
+
+static int blep_buf[MAXPOKEYS][BLEP_TAPS] __attribute__((section(".dtcm")));   /* impulse sums still to be played, per chip */
+static int blep_acc[MAXPOKEYS] __attribute__((section(".dtcm")));              /* output level << 15 */
+static int blep_level[MAXPOKEYS] __attribute__((section(".dtcm")));            /* level the steps so far add up to */
+static int blep_pos __attribute__((section(".dtcm")));                         /* blep_buf slot of the next sample */
+static uint32 blep_phase_mult __attribute__((section(".dtcm")));    /* Samp_n_cnt to phase, 16.16 */
+static int blep_settled __attribute__((section(".dtcm")));          /* samples played with no step, up to BLEP_TAPS */
+
+/* Steady state. Update_pokey_sound_rf() parks a channel that is silent or
+   volume only by setting its divider to 0x7fffffff - further off than the
+   whole part of the sample counter can ever get, as that is 24 bits and
+   wraps in Samp_n_cnt[0]. Once every channel is parked the event loop will
+   only ever find sample events and write the same level, so snd_steady is
+   worked out after each register write (and each pass) and while it holds
+   the engines just fill the buffer. The result is exactly the same - only
+   the sample counter moves. snd_samples_bypassed counts the samples done
+   that way for the debug overlay. */
+#define SAMP_WHOLE_MAX  0x00ffffff
+static uint8 snd_steady __attribute__((section(".dtcm")));
+uint32 snd_samples_bypassed = 0;
+
+static void Pokey_check_steady(void)
+{
+    uint8 chan;
+
+    snd_steady = ((Samp_n_cnt[1] & 0xff) == 0);     /* whole part within 24 bits */
+    for (chan = 0; chan < (Num_pokeys * 4); chan++) {
+        if (Div_n_cnt[chan] <= SAMP_WHOLE_MAX)
+            snd_steady = 0;
+    }
+}
+
 /* multiple sound engine interface */
 static void null_pokey_process(void *sndbuffer, unsigned int sndn) {}
 void (*Pokey_process_ptr)(void *sndbuffer, unsigned int sndn) = null_pokey_process;
@@ -158,6 +252,10 @@ static int Pokey_sound_init_rf(uint32 freq17, uint16 playback_freq, uint8 num_po
     uint8 chan;
 
     Update_pokey_sound = Update_pokey_sound_rf;
+    if (flags & SND_STEREO)
+        Pokey_process_ptr = (flags & SND_BLEP) ? Pokey_process_stereo_blep : Pokey_process_stereo;
+    else
+        Pokey_process_ptr = (flags & SND_BLEP) ? Pokey_process_blep : Pokey_process;
 
     /* start all of the polynomial counters at zero */
     P4 = 0;
@@ -171,16 +269,32 @@ static int Pokey_sound_init_rf(uint32 freq17, uint16 playback_freq, uint8 num_po
     Samp_n_cnt[0] = 0;          /* initialize all bits of the sample */
     Samp_n_cnt[1] = 0;          /* 'divide by N' counter */
 
+    blep_phase_mult = ((uint32) BLEP_PHASES << 16) / Samp_n_max;
+    memset(blep_buf, 0, sizeof(blep_buf));
+    blep_pos = 0;
+    blep_settled = 0;
+    for (chan = 0; chan < MAXPOKEYS; chan++) {
+        blep_level[chan] = 0;
+        blep_acc[chan] = BLEP_BIAS << 15;
+    }
+
     for (chan = 0; chan < (MAXPOKEYS * 4); chan++) {
         Outvol[chan] = 0;
         Outbit[chan] = 0;
         Div_n_cnt[chan] = 0;
         Div_n_max[chan] = 0x7fffffffL;
         AUDV[chan] = 0;
+        snd_AUDF[chan] = 0;
+        snd_AUDC[chan] = 0;
+    }
+    for (chan = 0; chan < MAXPOKEYS; chan++) {
+        snd_AUDCTL[chan] = 0;
+        snd_Base_mult[chan] = DIV_64;
     }
 
     /* set the number of pokey chips currently emulated */
     Num_pokeys = num_pokeys;
+    snd_steady = 0;             /* the counters all start at 0 - due at once */
 
     return 0; /* OK */
 }
@@ -190,6 +304,16 @@ int Pokey_DoInit(void)
     return Pokey_sound_init_rf(snd_freq17, (uint16) snd_playback_freq, snd_num_pokeys, snd_flags);
 }
 
+/* Take the registers as they stand - after a save state is loaded */
+void Pokey_sound_sync_regs(void)
+{
+    memcpy(snd_AUDF, AUDF, sizeof(snd_AUDF));
+    memcpy(snd_AUDC, AUDC, sizeof(snd_AUDC));
+    memcpy(snd_AUDCTL, AUDCTL, sizeof(snd_AUDCTL));
+    memcpy(snd_Base_mult, Base_mult, sizeof(snd_Base_mult));
+    Pokey_check_steady();
+}
+
 int  Pokey_sound_init(uint32 freq17, uint16 playback_freq, uint8 num_pokeys, unsigned int flags)
 {
     snd_freq17 = freq17;
@@ -224,42 +348,53 @@ static void Update_pokey_sound_rf(uint16 addr, uint8 val, uint8 chip, uint8 gain
     uint32 new_val = 0;
     uint8 chan;
     uint8 chan_mask;
+    uint8 chip_offs = chip << 2;     /* first channel of this chip */
     
     /* determine which address was changed */
     switch (addr & 0x0f) {
     case _AUDF1:
+        snd_AUDF[CHAN1 + chip_offs] = val;
         chan_mask = 1 << CHAN1;
-        if (AUDCTL[0] & CH1_CH2)        /* if ch 1&2 tied together */
+        if (snd_AUDCTL[chip] & CH1_CH2)    /* if ch 1&2 tied together */
             chan_mask |= 1 << CHAN2;    /* then also change on ch2 */
         break;
     case _AUDC1:
-        AUDV[CHAN1] = (val & VOLUME_MASK) * gain;
+        snd_AUDC[CHAN1 + chip_offs] = val;
+        AUDV[CHAN1 + chip_offs] = (val & VOLUME_MASK) * gain;
         chan_mask = 1 << CHAN1;
         break;
     case _AUDF2:
+        snd_AUDF[CHAN2 + chip_offs] = val;
         chan_mask = 1 << CHAN2;
         break;
     case _AUDC2:
-        AUDV[CHAN2] = (val & VOLUME_MASK) * gain;
+        snd_AUDC[CHAN2 + chip_offs] = val;
+        AUDV[CHAN2 + chip_offs] = (val & VOLUME_MASK) * gain;
         chan_mask = 1 << CHAN2;
         break;
     case _AUDF3:
+        snd_AUDF[CHAN3 + chip_offs] = val;
         chan_mask = 1 << CHAN3;
-        if (AUDCTL[0] & CH3_CH4)        /* if ch 3&4 tied together */
+        if (snd_AUDCTL[chip] & CH3_CH4)    /* if ch 3&4 tied together */
             chan_mask |= 1 << CHAN4;    /* then also change on ch4 */
         break;
     case _AUDC3:
-        AUDV[CHAN3] = (val & VOLUME_MASK) * gain;
+        snd_AUDC[CHAN3 + chip_offs] = val;
+        AUDV[CHAN3 + chip_offs] = (val & VOLUME_MASK) * gain;
         chan_mask = 1 << CHAN3;
         break;
     case _AUDF4:
+        snd_AUDF[CHAN4 + chip_offs] = val;
         chan_mask = 1 << CHAN4;
         break;
     case _AUDC4:
-        AUDV[CHAN4] = (val & VOLUME_MASK) * gain;
+        snd_AUDC[CHAN4 + chip_offs] = val;
+        AUDV[CHAN4 + chip_offs] = (val & VOLUME_MASK) * gain;
         chan_mask = 1 << CHAN4;
         break;
     case _AUDCTL:
+        snd_AUDCTL[chip] = val;
+        snd_Base_mult[chip] = (val & CLOCK_15) ? DIV_15 : DIV_64;
         chan_mask = 15;         /* all channels */
         break;
     default:
@@ -279,76 +414,76 @@ static void Update_pokey_sound_rf(uint16 addr, uint8 val, uint8 chip, uint8 gain
 
     if (chan_mask & (1 << CHAN1)) {
         /* process channel 1 frequency */
-        if (AUDCTL[0] & CH1_179)
-            new_val = AUDF[CHAN1] + 4;
+        if (snd_AUDCTL[chip] & CH1_179)
+            new_val = snd_AUDF[CHAN1 + chip_offs] + 4;
         else
-            new_val = (AUDF[CHAN1] + 1) * Base_mult[0];
+            new_val = (snd_AUDF[CHAN1 + chip_offs] + 1) * snd_Base_mult[chip];
 
-        if (new_val != Div_n_max[CHAN1]) {
-            Div_n_max[CHAN1] = new_val;
+        if (new_val != Div_n_max[CHAN1 + chip_offs]) {
+            Div_n_max[CHAN1 + chip_offs] = new_val;
 
-            if (Div_n_cnt[CHAN1] > new_val) {
-                Div_n_cnt[CHAN1] = new_val;
+            if (Div_n_cnt[CHAN1 + chip_offs] > new_val) {
+                Div_n_cnt[CHAN1 + chip_offs] = new_val;
             }
         }
     }
 
     if (chan_mask & (1 << CHAN2)) {
         /* process channel 2 frequency */
-        if (AUDCTL[0] & CH1_CH2) {
-            if (AUDCTL[0] & CH1_179)
-                new_val = AUDF[CHAN2] * 256 +
-                    AUDF[CHAN1] + 7;
+        if (snd_AUDCTL[chip] & CH1_CH2) {
+            if (snd_AUDCTL[chip] & CH1_179)
+                new_val = snd_AUDF[CHAN2 + chip_offs] * 256 +
+                    snd_AUDF[CHAN1 + chip_offs] + 7;
             else
-                new_val = (AUDF[CHAN2] * 256 +
-                           AUDF[CHAN1] + 1) * Base_mult[0];
+                new_val = (snd_AUDF[CHAN2 + chip_offs] * 256 +
+                           snd_AUDF[CHAN1 + chip_offs] + 1) * snd_Base_mult[chip];
         }
         else
-            new_val = (AUDF[CHAN2] + 1) * Base_mult[0];
+            new_val = (snd_AUDF[CHAN2 + chip_offs] + 1) * snd_Base_mult[chip];
 
-        if (new_val != Div_n_max[CHAN2]) {
-            Div_n_max[CHAN2] = new_val;
+        if (new_val != Div_n_max[CHAN2 + chip_offs]) {
+            Div_n_max[CHAN2 + chip_offs] = new_val;
 
-            if (Div_n_cnt[CHAN2] > new_val) {
-                Div_n_cnt[CHAN2] = new_val;
+            if (Div_n_cnt[CHAN2 + chip_offs] > new_val) {
+                Div_n_cnt[CHAN2 + chip_offs] = new_val;
             }
         }
     }
 
     if (chan_mask & (1 << CHAN3)) {
         /* process channel 3 frequency */
-        if (AUDCTL[0] & CH3_179)
-            new_val = AUDF[CHAN3] + 4;
+        if (snd_AUDCTL[chip] & CH3_179)
+            new_val = snd_AUDF[CHAN3 + chip_offs] + 4;
         else
-            new_val = (AUDF[CHAN3] + 1) * Base_mult[0];
+            new_val = (snd_AUDF[CHAN3 + chip_offs] + 1) * snd_Base_mult[chip];
 
-        if (new_val != Div_n_max[CHAN3]) {
-            Div_n_max[CHAN3] = new_val;
+        if (new_val != Div_n_max[CHAN3 + chip_offs]) {
+            Div_n_max[CHAN3 + chip_offs] = new_val;
 
-            if (Div_n_cnt[CHAN3] > new_val) {
-                Div_n_cnt[CHAN3] = new_val;
+            if (Div_n_cnt[CHAN3 + chip_offs] > new_val) {
+                Div_n_cnt[CHAN3 + chip_offs] = new_val;
             }
         }
     }
 
     if (chan_mask & (1 << CHAN4)) {
         /* process channel 4 frequency */
-        if (AUDCTL[0] & CH3_CH4) {
-            if (AUDCTL[0] & CH3_179)
-                new_val = AUDF[CHAN4] * 256 +
-                    AUDF[CHAN3] + 7;
+        if (snd_AUDCTL[chip] & CH3_CH4) {
+            if (snd_AUDCTL[chip] & CH3_179)
+                new_val = snd_AUDF[CHAN4 + chip_offs] * 256 +
+                    snd_AUDF[CHAN3 + chip_offs] + 7;
             else
-                new_val = (AUDF[CHAN4] * 256 +
-                           AUDF[CHAN3] + 1) * Base_mult[0];
+                new_val = (snd_AUDF[CHAN4 + chip_offs] * 256 +
+                           snd_AUDF[CHAN3 + chip_offs] + 1) * snd_Base_mult[chip];
         }
         else
-            new_val = (AUDF[CHAN4] + 1) * Base_mult[0];
+            new_val = (snd_AUDF[CHAN4 + chip_offs] + 1) * snd_Base_mult[chip];
 
-        if (new_val != Div_n_max[CHAN4]) {
-            Div_n_max[CHAN4] = new_val;
+        if (new_val != Div_n_max[CHAN4 + chip_offs]) {
+            Div_n_max[CHAN4 + chip_offs] = new_val;
 
-            if (Div_n_cnt[CHAN4] > new_val) {
-                Div_n_cnt[CHAN4] = new_val;
+            if (Div_n_cnt[CHAN4 + chip_offs] > new_val) {
+                Div_n_cnt[CHAN4 + chip_offs] = new_val;
             }
         }
     }
@@ -362,16 +497,18 @@ static void Update_pokey_sound_rf(uint16 addr, uint8 val, uint8 chip, uint8 gain
                frequency.  There isn't much point in processing frequencies
                that the hardware can't reproduce.  I've also disabled
                processing if the volume is zero. */
-            if ((AUDC[chan] & VOL_ONLY) || ((AUDC[chan] & VOLUME_MASK) == 0) || (Div_n_max[chan] < (Samp_n_max >> 8)))
+            if ((snd_AUDC[chan + chip_offs] & VOL_ONLY) || ((snd_AUDC[chan + chip_offs] & VOLUME_MASK) == 0) || (Div_n_max[chan + chip_offs] < (Samp_n_max >> 8)))
             {
                 /* indicate the channel is 'on' */
-                Outvol[chan] = 1;
+                Outvol[chan + chip_offs] = 1;
                 /* and set channel freq to max to reduce processing */
-                Div_n_max[chan] = 0x7fffffffL;
-                Div_n_cnt[chan] = 0x7fffffffL;
+                Div_n_max[chan + chip_offs] = 0x7fffffffL;
+                Div_n_cnt[chan + chip_offs] = 0x7fffffffL;
             }
         }
     }
+
+    Pokey_check_steady();
 }
 
 
@@ -390,7 +527,44 @@ static void Update_pokey_sound_rf(uint16 addr, uint8 val, uint8 chip, uint8 gain
 /* Outputs: the buffer will be filled with n bytes of audio - no return val  */
 /*                                                                           */
 /*****************************************************************************/
-ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
+
+/* Add a step of delta to a chip's band-limited output, at the point between
+   the last sample and the next that the sample counter has reached */
+static inline void blep_step(int chip, int delta)
+{
+    uint32 phase = (Samp_n_cnt[0] * blep_phase_mult) >> 16;
+    const short *h;
+    int j;
+
+    if (phase >= BLEP_PHASES)
+        phase = BLEP_PHASES - 1;
+    h = blep_table[phase];
+    for (j = 0; j < BLEP_TAPS; j++)
+        blep_buf[chip][(blep_pos + j) & (BLEP_TAPS - 1)] += delta * h[j];
+}
+
+/* The next band-limited sample of a chip's output */
+static inline int blep_sample(int chip)
+{
+    int iout;
+
+    blep_acc[chip] += blep_buf[chip][blep_pos];
+    blep_buf[chip][blep_pos] = 0;
+    iout = (blep_acc[chip] + (1 << 14)) >> 15;
+    if (iout < SAMP_MIN)
+        iout = SAMP_MIN;
+    else if (iout > SAMP_MAX)
+        iout = SAMP_MAX;
+    return iout;
+}
+
+/* Every engine is this one loop, inlined with blep and stereo constants -
+   the classic mono one is exactly what it always was. In stereo the second
+   chip's four channels join the same event search and sample counter, and
+   each sample is written as a left (chip 1) and right (chip 2) byte pair, so
+   a second POKEY costs its own channel events but no more per sample than
+   the second byte. */
+static inline __attribute__((always_inline)) void Pokey_process_engine(void *sndbuffer, unsigned sndn, const int blep, const int stereo)
 {
     register char *buffer = (char  *) sndbuffer;
     register uint16 n = sndn;
@@ -400,6 +574,8 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
     register uint32 event_min;
     register uint8 next_event;
     register unsigned char cur_val;     /* otherwise we'll simplify as 8-bit unsigned */
+    register unsigned char cur_r = SAMP_MIN;    /* the second chip's, in stereo */
+    register int step;
     register uint8 *out_ptr;
     register uint8 audc;
     register uint8 toggle;
@@ -428,6 +604,66 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
     if (*out_ptr++) cur_val += *vol_ptr;
     vol_ptr++;
 
+    if (stereo) {
+        if (*out_ptr++) cur_r += *vol_ptr;
+        vol_ptr++;
+
+        if (*out_ptr++) cur_r += *vol_ptr;
+        vol_ptr++;
+
+        if (*out_ptr++) cur_r += *vol_ptr;
+        vol_ptr++;
+
+        if (*out_ptr++) cur_r += *vol_ptr;
+        vol_ptr++;
+    }
+
+    /* anything written since the last call took effect just after its last sample */
+    if (blep) {
+        if (cur_val != blep_level[0]) {
+            blep_step(0, cur_val - blep_level[0]);
+            blep_settled = 0;
+        }
+        if (stereo && cur_r != blep_level[1]) {
+            blep_step(1, cur_r - blep_level[1]);
+            blep_settled = 0;
+        }
+    }
+
+    /* nothing can change before the next register write - see snd_steady */
+    if (snd_steady) {
+        snd_samples_bypassed += n;
+        *Samp_n_cnt += n * Samp_n_max;      /* as n sample events would have */
+        if (blep) {
+            blep_level[0] = cur_val;
+            blep_level[1] = cur_r;
+            /* play out the steps still in the ring, then it holds the level */
+            while (n && blep_settled < BLEP_TAPS) {
+                *buffer++ = (char) blep_sample(0) + 128;
+                if (stereo)
+                    *buffer++ = (char) blep_sample(1) + 128;
+                blep_pos = (blep_pos + 1) & (BLEP_TAPS - 1);
+                blep_settled++;
+                n--;
+            }
+            if (n) {
+                cur_val = blep_sample(0);
+                if (stereo)
+                    cur_r = blep_sample(1);
+                blep_pos = (blep_pos + n) & (BLEP_TAPS - 1);
+            }
+        }
+        if (stereo) {
+            while (n--) {
+                *buffer++ = (char) cur_val + 128;
+                *buffer++ = (char) cur_r + 128;
+            }
+        }
+        else
+            memset(buffer, (char) cur_val + 128, n);
+        return;
+    }
+
     /* loop until the buffer is filled */
     while (n) 
     {
@@ -437,7 +673,7 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
         /* I've optimized by finding the smallest count and then */
         /* 'accelerated' time by adjusting all pointers by that amount. */
 
-        /* find next smallest event (either sample or chan 1-4) */
+        /* find next smallest event (either sample or chan 1-4, or 1-8 in stereo) */
         next_event = SAMPLE;
         event_min = READ_U32(samp_cnt_w_ptr);
 
@@ -464,6 +700,28 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
         next_event = CHAN4;
     }
     div_n_ptr++;
+    if (stereo) {
+        if (*div_n_ptr <= event_min) {
+            event_min = *div_n_ptr;
+            next_event = CHAN1 + CHIP2;
+        }
+        div_n_ptr++;
+        if (*div_n_ptr <= event_min) {
+            event_min = *div_n_ptr;
+            next_event = CHAN2 + CHIP2;
+        }
+        div_n_ptr++;
+        if (*div_n_ptr <= event_min) {
+            event_min = *div_n_ptr;
+            next_event = CHAN3 + CHIP2;
+        }
+        div_n_ptr++;
+        if (*div_n_ptr <= event_min) {
+            event_min = *div_n_ptr;
+            next_event = CHAN4 + CHIP2;
+        }
+        div_n_ptr++;
+    }
 
         /* if the next event is a channel change */
         if (next_event != SAMPLE) {
@@ -471,6 +729,16 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
 
       /* decrement all counters by the smallest count found */
       /* again, no loop for efficiency */
+      if (stereo) {
+          div_n_ptr--;
+          *div_n_ptr -= event_min;
+          div_n_ptr--;
+          *div_n_ptr -= event_min;
+          div_n_ptr--;
+          *div_n_ptr -= event_min;
+          div_n_ptr--;
+          *div_n_ptr -= event_min;
+      }
       div_n_ptr--;
       *div_n_ptr -= event_min;
       div_n_ptr--;
@@ -496,13 +764,14 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
             Div_n_cnt[next_event] += Div_n_max[next_event];
 
             /* get the current AUDC into a register (for optimization) */
-            audc = AUDC[next_event];
+            audc = snd_AUDC[next_event];
 
             /* set a pointer to the current output (for opt...) */
             out_ptr = &Outvol[next_event];
 
             /* assume no changes to the output */
             toggle = FALSE;
+            step = 0;
 
             /* From here, a good understanding of the hardware is required */
             /* to understand what is happening.  I won't be able to provide */
@@ -525,7 +794,7 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
                     }
                     else {
                         /* if 9-bit poly is selected on this chip */
-                        if (AUDCTL[next_event >> 2] & POLY9) {
+                        if (snd_AUDCTL[next_event >> 2] & POLY9) {
                             /* compare to the poly9 bit */
                             toggle = ((poly9_lookup[P9] & 1) == !(*out_ptr));
                         }
@@ -538,27 +807,27 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
             }
 
             /* check channel 1 filter (clocked by channel 3) */
-            if ( AUDCTL[next_event >> 2] & CH1_FILTER) {
+            if ( snd_AUDCTL[next_event >> 2] & CH1_FILTER) {
                 /* if we're processing channel 3 */
                 if ((next_event & 0x03) == CHAN3) {
                     /* check output of channel 1 on same chip */
                     if (Outvol[next_event & 0xfd]) {
                         /* if on, turn it off */
                         Outvol[next_event & 0xfd] = 0;
-                        cur_val -= AUDV[next_event & 0xfd];
+                        step -= AUDV[next_event & 0xfd];
                     }
                 }
             }
 
             /* check channel 2 filter (clocked by channel 4) */
-            if ( AUDCTL[next_event >> 2] & CH2_FILTER) {
+            if ( snd_AUDCTL[next_event >> 2] & CH2_FILTER) {
                 /* if we're processing channel 4 */
                 if ((next_event & 0x03) == CHAN4) {
                     /* check output of channel 2 on same chip */
                     if (Outvol[next_event & 0xfd]) {
                         /* if on, turn it off */
                         Outvol[next_event & 0xfd] = 0;
-                        cur_val -= AUDV[next_event & 0xfd];
+                        step -= AUDV[next_event & 0xfd];
                     }
                 }
             }
@@ -567,7 +836,7 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
             if (toggle) {
                 if (*out_ptr) {
                     /* remove this channel from the signal */
-                    cur_val -= AUDV[next_event];
+                    step -= AUDV[next_event];
 
                     /* and turn the output off */
                     *out_ptr = 0;
@@ -577,7 +846,21 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
                     *out_ptr = 1;
 
                     /* and add it to the output signal */
-                    cur_val += AUDV[next_event];
+                    step += AUDV[next_event];
+                }
+            }
+
+            /* and take it to the chip's output */
+            if (step) {
+                if (stereo && (next_event & CHIP2)) {
+                    cur_r += step;
+                    if (blep)
+                        blep_step(1, step);
+                }
+                else {
+                    cur_val += step;
+                    if (blep)
+                        blep_step(0, step);
                 }
             }
         }
@@ -585,12 +868,50 @@ ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
             /* adjust the sample counter - note we're using the 24.8 integer
                which includes an 8 bit fraction for accuracy */
       int iout;
-      iout = cur_val;
+      if (blep)
+          iout = blep_sample(0);
+      else
+          iout = cur_val;
       *buffer++ = (char) ((iout))+128;
+      if (stereo) {
+          iout = blep ? blep_sample(1) : cur_r;
+          *buffer++ = (char) ((iout))+128;
+      }
+      if (blep)
+          blep_pos = (blep_pos + 1) & (BLEP_TAPS - 1);
       *Samp_n_cnt += Samp_n_max;
       /* and indicate one less byte in the buffer */
       n--;
         }    
     }
+
+    if (blep) {
+        blep_level[0] = cur_val;
+        blep_level[1] = cur_r;
+        blep_settled = 0;
+    }
+    Pokey_check_steady();
+}
+
+ITCM_CODE void Pokey_process(void *sndbuffer, unsigned sndn)
+{
+    Pokey_process_engine(sndbuffer, sndn, 0, 0);
+}
+
+ITCM_CODE void Pokey_process_blep(void *sndbuffer, unsigned sndn)
+{
+    Pokey_process_engine(sndbuffer, sndn, 1, 0);
+}
+
+/* The stereo engines stay out of ITCM - there is little room left there and
+   only games set up for a second POKEY use them */
+void Pokey_process_stereo(void *sndbuffer, unsigned sndn)
+{
+    Pokey_process_engine(sndbuffer, sndn, 0, 1);
+}
+
+void Pokey_process_stereo_blep(void *sndbuffer, unsigned sndn)
+{
+    Pokey_process_engine(sndbuffer, sndn, 1, 1);
 }
 
@@ -101,9 +101,11 @@ extern "C" {
 /* init flags */
 #define SND_BIT16   1
 #define SND_STEREO  2
+#define SND_BLEP    4           /* band-limited steps - Pokey_process_blep() */
 
 extern int32 snd_playback_freq;
 extern uint8 snd_num_pokeys;
+extern uint32 snd_samples_bypassed;    /* samples filled in with nothing sounding - see snd_steady */
 
 extern uint8 Num_pokeys;
 extern uint8 AUDV[4 * MAXPOKEYS];
@@ -117,6 +119,10 @@ extern uint32 Div_n_cnt[4 * MAXPOKEYS];
 extern uint32 Div_n_max[4 * MAXPOKEYS];
 extern uint32 Samp_n_max;
 extern uint32 Samp_n_cnt[2];    
+extern uint8 snd_AUDF[4 * MAXPOKEYS];
+extern uint8 snd_AUDC[4 * MAXPOKEYS];
+extern uint8 snd_AUDCTL[MAXPOKEYS];
+extern int snd_Base_mult[MAXPOKEYS];
 
 extern void (*Pokey_process_ptr)(void *sndbuffer, unsigned int sndn);
 extern void (*Update_pokey_sound)(uint16 addr, uint8 val, uint8 /*chip*/, uint8 gain);
@@ -128,7 +134,11 @@ int Pokey_sound_init(uint32 freq17, uint16 playback_freq, uint8 num_pokeys,
                      unsigned int flags
                      );
 void Pokey_process(void *sndbuffer, unsigned int sndn);
+void Pokey_process_blep(void *sndbuffer, unsigned int sndn);
+void Pokey_process_stereo(void *sndbuffer, unsigned int sndn);
+void Pokey_process_stereo_blep(void *sndbuffer, unsigned int sndn);
 int Pokey_DoInit(void);
+void Pokey_sound_sync_regs(void);
 void Pokey_set_mzquality(int quality);
 
 #ifdef __cplusplus
@@ -0,0 +1,243 @@
+/*
+ * PROFILE.C contains the optional per-PC execution profiler for the 6502 core.
+ * Build with CPU_PROFILE defined and GO() counts every instruction it runs by
+ * address, by opcode and by the XE/cartridge bank it ran from. PROFILE_Dump()
+ * then writes out a plain text hot-spot report - the busiest opcodes, the top
+ * addresses and the loops they live in - so we can tell whether a slow game is
+ * CPU-bound and where. Without CPU_PROFILE this file compiles to nothing.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "profile.h"
+
+#ifdef CPU_PROFILE
+
+#define PROFILE_TOP_PC      40          // Hottest addresses listed
+#define PROFILE_TOP_LOOPS   20          // Hottest loops listed
+#define PROFILE_MAX_LOOP    256         // Longest backward branch/jump we call a loop
+
+ULONG profile_pc[0x10000];
+UWORD profile_tag[0x10000];
+ULONG profile_op[256];
+ULONG profile_bank[PROFILE_TAGS];
+
+static ULONG idle_cycles_at_reset = 0;
+
+// Opcode names in the same notation as the comments in cpu.c
+static const char *mnemonic[256] =
+{
+    "BRK",         "ORA (ab,x)",  "CIM",         "ASO (ab,x)",  "NOP ab",      "ORA ab",      "ASL ab",      "ASO ab",       /* 0x */
+    "PHP",         "ORA #ab",     "ASL",         "ANC #ab",     "NOP abcd",    "ORA abcd",    "ASL abcd",    "ASO abcd",
+    "BPL",         "ORA (ab),y",  "CIM",         "ASO (ab),y",  "NOP ab,x",    "ORA ab,x",    "ASL ab,x",    "ASO ab,x",     /* 1x */
+    "CLC",         "ORA abcd,y",  "NOP",         "ASO abcd,y",  "NOP abcd,x",  "ORA abcd,x",  "ASL abcd,x",  "ASO abcd,x",
+    "JSR abcd",    "AND (ab,x)",  "CIM",         "RLA (ab,x)",  "BIT ab",      "AND ab",      "ROL ab",      "RLA ab",       /* 2x */
+    "PLP",         "AND #ab",     "ROL",         "ANC #ab",     "BIT abcd",    "AND abcd",    "ROL abcd",    "RLA abcd",
+    "BMI",         "AND (ab),y",  "CIM",         "RLA (ab),y",  "NOP ab,x",    "AND ab,x",    "ROL ab,x",    "RLA ab,x",     /* 3x */
+    "SEC",         "AND abcd,y",  "NOP",         "RLA abcd,y",  "NOP abcd,x",  "AND abcd,x",  "ROL abcd,x",  "RLA abcd,x",
+    "RTI",         "EOR (ab,x)",  "CIM",         "LSE (ab,x)",  "NOP ab",      "EOR ab",      "LSR ab",      "LSE ab",       /* 4x */
+    "PHA",         "EOR #ab",     "LSR",         "ALR #ab",     "JMP abcd",    "EOR abcd",    "LSR abcd",    "LSE abcd",
+    "BVC",         "EOR (ab),y",  "CIM",         "LSE (ab),y",  "NOP ab,x",    "EOR ab,x",    "LSR ab,x",    "LSE ab,x",     /* 5x */
+    "CLI",         "EOR abcd,y",  "NOP",         "LSE abcd,y",  "NOP abcd,x",  "EOR abcd,x",  "LSR abcd,x",  "LSE abcd,x",
+    "RTS",         "ADC (ab,x)",  "CIM",         "RRA (ab,x)",  "NOP ab",      "ADC ab",      "ROR ab",      "RRA ab",       /* 6x */
+    "PLA",         "ADC #ab",     "ROR",         "ARR #ab",     "JMP (abcd)",  "ADC abcd",    "ROR abcd",    "RRA abcd",
+    "BVS",         "ADC (ab),y",  "CIM",         "RRA (ab),y",  "NOP ab,x",    "ADC ab,x",    "ROR ab,x",    "RRA ab,x",     /* 7x */
+    "SEI",         "ADC abcd,y",  "NOP",         "RRA abcd,y",  "NOP abcd,x",  "ADC abcd,x",  "ROR abcd,x",  "RRA abcd,x",
+    "NOP #ab",     "STA (ab,x)",  "NOP #ab",     "SAX (ab,x)",  "STY ab",      "STA ab",      "STX ab",      "SAX ab",       /* 8x */
+    "DEY",         "NOP #ab",     "TXA",         "ANE #ab",     "STY abcd",    "STA abcd",    "STX abcd",    "SAX abcd",
+    "BCC",         "STA (ab),y",  "CIM",         "SHA (ab),y",  "STY ab,x",    "STA ab,x",    "STX ab,y",    "SAX ab,y",     /* 9x */
+    "TYA",         "STA abcd,y",  "TXS",         "SHS abcd,y",  "SHY abcd,x",  "STA abcd,x",  "SHX abcd,y",  "SHA abcd,y",
+    "LDY #ab",     "LDA (ab,x)",  "LDX #ab",     "LAX (ab,x)",  "LDY ab",      "LDA ab",      "LDX ab",      "LAX ab",       /* Ax */
+    "TAY",         "LDA #ab",     "TAX",         "ANX #ab",     "LDY abcd",    "LDA abcd",    "LDX abcd",    "LAX abcd",
+    "BCS",         "LDA (ab),y",  "CIM",         "LAX (ab),y",  "LDY ab,x",    "LDA ab,x",    "LDX ab,y",    "LAX ab,y",     /* Bx */
+    "CLV",         "LDA abcd,y",  "TSX",         "LAS abcd,y",  "LDY abcd,x",  "LDA abcd,x",  "LDX abcd,y",  "LAX abcd,y",
+    "CPY #ab",     "CMP (ab,x)",  "NOP #ab",     "DCM (ab,x)",  "CPY ab",      "CMP ab",      "DEC ab",      "DCM ab",       /* Cx */
+    "INY",         "CMP #ab",     "DEX",         "SBX #ab",     "CPY abcd",    "CMP abcd",    "DEC abcd",    "DCM abcd",
+    "BNE",         "CMP (ab),y",  "ESCRTS #ab",  "DCM (ab),y",  "NOP ab,x",    "CMP ab,x",    "DEC ab,x",    "DCM ab,x",     /* Dx */
+    "CLD",         "CMP abcd,y",  "NOP",         "DCM abcd,y",  "NOP abcd,x",  "CMP abcd,x",  "DEC abcd,x",  "DCM abcd,x",
+    "CPX #ab",     "SBC (ab,x)",  "NOP #ab",     "INS (ab,x)",  "CPX ab",      "SBC ab",      "INC ab",      "INS ab",       /* Ex */
+    "INX",         "SBC #ab",     "NOP",         "SBC #ab",     "CPX abcd",    "SBC abcd",    "INC abcd",    "INS abcd",
+    "BEQ",         "SBC (ab),y",  "ESC #ab",     "INS (ab),y",  "NOP ab,x",    "SBC ab,x",    "INC ab,x",    "INS ab,x",     /* Fx */
+    "SED",         "SBC abcd,y",  "NOP",         "INS abcd,y",  "NOP abcd,x",  "SBC abcd,x",  "INC abcd,x",  "INS abcd,x",
+};
+
+typedef struct
+{
+    UWORD start;                        // First address of the loop (branch target)
+    UWORD end;                          // The branch or jump that closes it
+    unsigned long long cost;            // Instructions executed anywhere in start..end
+} profile_loop_t;
+
+void PROFILE_Reset(void)
+{
+    memset(profile_pc, 0x00, sizeof(profile_pc));
+    memset(profile_tag, 0x00, sizeof(profile_tag));
+    memset(profile_op, 0x00, sizeof(profile_op));
+    memset(profile_bank, 0x00, sizeof(profile_bank));
+    idle_cycles_at_reset = idle_cycles_skipped;
+}
+
+static const char *bank_name(UWORD tag)
+{
+    static char buf[12];
+    if (tag >= PROFILE_TAG_CART) sprintf(buf, "CART%03d", tag - PROFILE_TAG_CART);
+    else if (tag)               sprintf(buf, "XE%02d", tag);
+    else                        strcpy(buf, "-");
+    return buf;
+}
+
+// The standard CRC-32 - the one getFileCrc() uses for the game settings
+static ULONG image_crc(const UBYTE *data, ULONG len)
+{
+    ULONG crc = 0xFFFFFFFF;
+    while (len--)
+    {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static double percent(unsigned long long count, unsigned long long total)
+{
+    return total ? (100.0 * count / total) : 0.0;
+}
+
+// -----------------------------------------------------------------------------------
+// Keep a small array sorted by descending count - n is the number in use so far.
+// Returns the slot the new entry should go into (and makes room) or -1 if it does
+// not make the cut.
+// -----------------------------------------------------------------------------------
+static int insert_slot(unsigned long long *counts, int n, int max, unsigned long long count, void *base, int size)
+{
+    int i = (n < max) ? n : max - 1;
+    if (n == max && count <= counts[i]) return -1;
+    while (i > 0 && counts[i-1] < count)
+    {
+        counts[i] = counts[i-1];
+        memcpy((char *)base + i*size, (char *)base + (i-1)*size, size);
+        i--;
+    }
+    counts[i] = count;
+    return i;
+}
+
+// -----------------------------------------------------------------------------------
+// Write the report. Loops are found by looking at the code as it is mapped right now
+// for executed branches and JMPs that go backwards - good enough to point the finger.
+// -----------------------------------------------------------------------------------
+int PROFILE_Dump(const char *filename)
+{
+    unsigned long long total = 0;
+    unsigned long long top_count[PROFILE_TOP_PC];
+    UWORD top_pc[PROFILE_TOP_PC];
+    unsigned long long loop_count[PROFILE_TOP_LOOPS];
+    profile_loop_t loops[PROFILE_TOP_LOOPS];
+    int n_top = 0, n_loops = 0;
+    UBYTE ops[256];
+
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) return 0;
+
+    for (int op = 0; op < 256; op++) total += profile_op[op];
+
+    fprintf(fp, "A8DS 6502 PROFILE\n");
+    fprintf(fp, "=================\n\n");
+    fprintf(fp, "Instructions executed : %llu\n", total);
+    fprintf(fp, "Idle cycles skipped   : %u (trips round idle loops are not counted below)\n", idle_cycles_skipped - idle_cycles_at_reset);
+    if (cart_image_size)
+    {
+        ULONG loaded = (cart_image_size < CART_MAX_SIZE) ? cart_image_size : CART_MAX_SIZE;
+        fprintf(fp, "Cartridge image       : %u bytes, CRC %08X%s\n", cart_image_size, image_crc(cart_image, loaded),
+                (loaded < cart_image_size) ? " (only the first 1024K is loaded)" : "");
+    }
+    fprintf(fp, "\n");
+
+    // Opcodes, busiest first
+    for (int i = 0; i < 256; i++) ops[i] = i;
+    for (int i = 1; i < 256; i++)
+    {
+        UBYTE op = ops[i];
+        int j = i;
+        while (j > 0 && profile_op[ops[j-1]] < profile_op[op]) { ops[j] = ops[j-1]; j--; }
+        ops[j] = op;
+    }
+    fprintf(fp, "OPCODES\n");
+    for (int i = 0; i < 256 && profile_op[ops[i]]; i++)
+    {
+        fprintf(fp, "  $%02X  %-12s %12u  %5.1f%%\n", ops[i], mnemonic[ops[i]], profile_op[ops[i]], percent(profile_op[ops[i]], total));
+    }
+
+    // Hottest addresses
+    for (int pc = 0; pc < 0x10000; pc++)
+    {
+        if (profile_pc[pc] == 0) continue;
+        int slot = insert_slot(top_count, n_top, PROFILE_TOP_PC, profile_pc[pc], top_pc, sizeof(UWORD));
+        if (slot < 0) continue;
+        top_pc[slot] = pc;
+        if (n_top < PROFILE_TOP_PC) n_top++;
+    }
+    fprintf(fp, "\nHOT ADDRESSES\n");
+    for (int i = 0; i < n_top; i++)
+    {
+        UWORD pc = top_pc[i];
+        fprintf(fp, "  $%04X  %-7s %12llu  %5.1f%%   %s\n", pc, bank_name(profile_tag[pc]), top_count[i], percent(top_count[i], total), mnemonic[dGetByte(pc)]);
+    }
+
+    // Hottest loops
+    for (int pc = 0; pc < 0x10000; pc++)
+    {
+        if (profile_pc[pc] == 0) continue;
+        UBYTE op = dGetByte(pc);
+        int target;
+        if ((op & 0x1f) == 0x10)    target = (UWORD) (pc + 2 + (SBYTE) dGetByte((UWORD) (pc + 1)));   // Bxx
+        else if (op == 0x4c)        target = dGetWord((UWORD) (pc + 1));                              // JMP abcd
+        else continue;
+        // Wrapped like the 6502 does, so a branch back past $0000 lands up top and is passed over
+        if (target > pc || pc - target >= PROFILE_MAX_LOOP) continue;
+
+        profile_loop_t loop = {target, pc, 0};
+        for (int a = target; a <= pc; a++) loop.cost += profile_pc[a];
+        int slot = insert_slot(loop_count, n_loops, PROFILE_TOP_LOOPS, loop.cost, loops, sizeof(profile_loop_t));
+        if (slot < 0) continue;
+        loops[slot] = loop;
+        if (n_loops < PROFILE_TOP_LOOPS) n_loops++;
+    }
+    fprintf(fp, "\nHOT LOOPS\n");
+    for (int i = 0; i < n_loops; i++)
+    {
+        fprintf(fp, "  $%04X-$%04X  %-7s %12llu  %5.1f%%   closed by %s x %u\n", loops[i].start, loops[i].end, bank_name(profile_tag[loops[i].end]),
+                loops[i].cost, percent(loops[i].cost, total), mnemonic[dGetByte(loops[i].end)], profile_pc[loops[i].end]);
+    }
+
+    // Time spent in each bank of the XE window and the cartridge area
+    fprintf(fp, "\nBANKS ($4000-$BFFF)\n");
+    int n_banks = 0;
+    for (int tag = 0; tag < PROFILE_TAGS; tag++)
+    {
+        if (profile_bank[tag] == 0) continue;
+        fprintf(fp, "  %-7s %12u  %5.1f%%\n", tag ? bank_name(tag) : "MAIN", profile_bank[tag], percent(profile_bank[tag], total));
+        n_banks++;
+    }
+    if (n_banks == 0) fprintf(fp, "  (no code ran there)\n");
+
+    fclose(fp);
+    return 1;
+}
+
+#endif /* CPU_PROFILE */
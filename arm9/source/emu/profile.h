@@ -0,0 +1,75 @@
+/*
+ * PROFILE.H contains the optional per-PC execution profiler for the 6502 core.
+ * Only built when CPU_PROFILE is defined - otherwise nothing here costs a cycle.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include "atari.h"
+
+#ifdef CPU_PROFILE
+
+#include "memory.h"
+#include "cartridge.h"
+#include "pia.h"
+
+#define PROFILE_FILE        "/data/a8ds_profile.txt"
+
+// ------------------------------------------------------------------------------
+// Bank tags. Code in the 0x4000-0x7FFF XE window is tagged with the XE bank that
+// was switched in (1-64, 0 is plain main RAM) and code in 0x8000-0xBFFF running
+// out of the cartridge image with 0x100 + the 8K bank of the image it came from -
+// room for every bank of the largest image, so no two banks share a tag. The
+// report names the image by its size and CRC so the banks can be matched up.
+// ------------------------------------------------------------------------------
+#define PROFILE_TAG_CART    0x100
+#define PROFILE_TAGS        (PROFILE_TAG_CART + (CART_MAX_SIZE >> 13))
+
+extern ULONG profile_pc[0x10000];       // Instructions executed at each PC
+extern UWORD profile_tag[0x10000];      // Bank tag that was mapped in the last time we ran there
+extern ULONG profile_op[256];           // Instructions executed per opcode
+extern ULONG profile_bank[PROFILE_TAGS];// Instructions executed per bank tag
+
+extern void PROFILE_Reset(void);
+extern int  PROFILE_Dump(const char *filename);
+
+// Called from GO() for every instruction, with the address the opcode was fetched from
+static inline void PROFILE_Count(UWORD pc, UBYTE insn)
+{
+    profile_pc[pc]++;
+    profile_op[insn]++;
+    if ((UWORD) (pc - 0x4000) < 0x8000)
+    {
+        UWORD tag;
+        if (pc < 0x8000)
+        {
+            tag = xe_bank;
+        }
+        else
+        {
+            const UBYTE *ptr = mem_map[pc >> 12] + pc;
+            tag = (ptr >= cart_image && ptr < cart_image + CART_MAX_SIZE) ? (PROFILE_TAG_CART + ((ptr - cart_image) >> 13)) : 0;
+        }
+        profile_tag[pc] = tag;
+        profile_bank[tag]++;
+    }
+}
+
+#endif /* CPU_PROFILE */
+
+#endif /* _PROFILE_H_ */
@@ -0,0 +1,125 @@
+/*
+ * SCHED.C contains the cycle-timestamped event queue. Anything that needs to
+ * happen at a given CPU cycle - rather than at the start of whatever scanline
+ * it falls in - goes in here. GO() only runs the 6502 up to the next due event
+ * (see CPU_Go_Startup), fires it and carries on, so a line with nothing pending
+ * costs no more than it ever did and a POKEY timer IRQ lands on its own cycle.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <nds.h>
+#include "sched.h"
+
+UBYTE sched_pending __attribute__((section(".dtcm"))) = 0;
+unsigned int sched_next __attribute__((section(".dtcm"))) = 0;
+int sched_limit __attribute__((section(".dtcm"))) = 0;
+
+static unsigned int sched_when[SCHED_EVENTS];
+static sched_handler_t sched_handler[SCHED_EVENTS];
+
+// -----------------------------------------------------------------------------------
+// How far GO() may run before the next event. One that is already due gives a limit
+// at or below xpos - so GO() stops at once and fires it.
+// -----------------------------------------------------------------------------------
+static inline void SCHED_Limit(void)
+{
+    sched_limit = xpos_limit;
+    if (sched_pending)
+    {
+        int next = (int) (sched_next - screenline_cpu_clock);
+        if (next < sched_limit) sched_limit = next;
+    }
+}
+
+// Work out which pending event is due first
+static void SCHED_Update(void)
+{
+    int first = 1;
+    for (int i = 0; i < SCHED_EVENTS; i++)
+    {
+        if (sched_pending & (1 << i))
+        {
+            if (first || (int) (sched_when[i] - sched_next) < 0) sched_next = sched_when[i];
+            first = 0;
+        }
+    }
+
+    SCHED_Limit();
+}
+
+void SCHED_Initialise(void)
+{
+    sched_pending = 0;
+    for (int i = 0; i < SCHED_EVENTS; i++)
+    {
+        sched_when[i] = 0;
+        sched_handler[i] = NULL;
+    }
+    SCHED_Update();
+}
+
+void SCHED_SetHandler(int event, sched_handler_t handler)
+{
+    sched_handler[event] = handler;
+}
+
+void SCHED_Set(int event, unsigned int when)
+{
+    sched_when[event] = when;
+    sched_pending |= (1 << event);
+    SCHED_Update();
+}
+
+void SCHED_Cancel(int event)
+{
+    if (sched_pending & (1 << event))
+    {
+        sched_pending &= ~(1 << event);
+        SCHED_Update();
+    }
+}
+
+// The time an event is (or was last) due - kept after it fires or is cancelled
+unsigned int SCHED_When(int event)
+{
+    return sched_when[event];
+}
+
+// -----------------------------------------------------------------------------------
+// Fire everything that is due by now, in time order (handlers may set events again)
+// and work out the new limit. Called by GO() on entry - xpos_limit may have moved -
+// and whenever it reaches sched_limit short of xpos_limit.
+// -----------------------------------------------------------------------------------
+ITCM_CODE void SCHED_Run(void)
+{
+    unsigned int now = cpu_clock;
+
+    while (sched_pending && (int) (now - sched_next) >= 0)
+    {
+        for (int i = 0; i < SCHED_EVENTS; i++)
+        {
+            if ((sched_pending & (1 << i)) && sched_when[i] == sched_next)
+            {
+                sched_pending &= ~(1 << i);
+                SCHED_Update();
+                sched_handler[i](i);
+                break;
+            }
+        }
+    }
+
+    SCHED_Limit();
+}
@@ -0,0 +1,48 @@
+/*
+ * SCHED.H contains the cycle-timestamped event queue that lets chips ask for
+ * something to happen at an exact CPU cycle (POKEY timer IRQs for now).
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include "atari.h"
+
+// ------------------------------------------------------------------------------
+// One slot per kind of event - an event is either pending or not, and setting it
+// again simply moves it. Times are absolute cpu_clock values (they wrap, so only
+// ever compare them by subtracting).
+// ------------------------------------------------------------------------------
+#define SCHED_TIMER1        0       // POKEY channel 1 timer underflow
+#define SCHED_TIMER2        1       // POKEY channel 2 timer underflow
+#define SCHED_TIMER4        2       // POKEY channel 4 timer underflow
+#define SCHED_EVENTS        3
+
+typedef void (*sched_handler_t)(int event);
+
+extern UBYTE sched_pending;         // Bit per event that is waiting to fire
+extern unsigned int sched_next;     // When the earliest pending event is due
+extern int sched_limit;             // GO() runs up to here - xpos_limit or the xpos of the next event if sooner
+
+extern void SCHED_Initialise(void);
+extern void SCHED_SetHandler(int event, sched_handler_t handler);
+extern void SCHED_Set(int event, unsigned int when);
+extern void SCHED_Cancel(int event);
+extern unsigned int SCHED_When(int event);
+extern void SCHED_Run(void);
+
+#endif /* _SCHED_H_ */
@@ -56,8 +56,10 @@
 #include "antic.h"  /* ANTIC_ypos */
 #include "atari.h"
 #include "binload.h"
+#include "cassette.h"
 #include "cpu.h"
 #include "esc.h"
+#include "gzfile.h"
 #include "memory.h"
 #include "platform.h"
 #include "pokey.h"
@@ -99,6 +101,57 @@ static int SIO_format_sectorcount[SIO_MAX_DRIVES];
 static int SIO_format_sectorsize[SIO_MAX_DRIVES];
 static int io_success[SIO_MAX_DRIVES];
 
+/* In-memory disk images.
+   Every SeekSector() + fread() of a 128 or 256 byte sector costs a walk of
+   the FAT cluster chain and a small unbuffered SD card read on the DS, which
+   is what makes multi-load games hitch on each disk access. So an image of
+   up to SIO_CACHE_MAX bytes is read into RAM in one go by SIO_Mount() and
+   its sectors are served from there. Writes go to the RAM copy and mark the
+   128 byte blocks they touch in a dirty bitmap; SIO_Flush() writes those
+   back in runs of consecutive blocks, one fseek() and fwrite() per run.
+   That happens when the disk is dismounted, when the drive has gone
+   SIO_FLUSH_FRAMES without a write (SIO_Frame()) and before a save state.
+   An image too big for the budget, or one there is no RAM for, is read
+   straight from the file as before, and what is written to it is fflush()ed
+   out of the stdio buffer once the drive goes quiet. */
+#ifndef SIO_CACHE_MAX
+#define SIO_CACHE_MAX       (368 * 1024)    /* biggest image held in RAM - a 360K double-sided DD disk */
+#endif
+#ifndef SIO_CACHE_TOTAL
+#define SIO_CACHE_TOTAL     (2 * SIO_CACHE_MAX) /* all drives' images together */
+#endif
+#define SIO_FLUSH_FRAMES    120             /* two seconds without a write */
+#define SIO_BLOCK_SHIFT     7               /* dirty bitmap granularity - 128 bytes */
+
+int SIO_cache_enabled = TRUE;
+static UBYTE *disk_image[SIO_MAX_DRIVES];
+static ULONG disk_image_size[SIO_MAX_DRIVES];
+static ULONG disk_pos[SIO_MAX_DRIVES];
+static UBYTE *disk_dirty[SIO_MAX_DRIVES];
+static int disk_dirty_blocks[SIO_MAX_DRIVES];
+static int disk_idle_frames[SIO_MAX_DRIVES];
+static ULONG disk_cache_used = 0;
+
+/* Sector read-ahead, for images left on the card.
+   DOS and boot loaders ask for sectors one after another, and each request
+   is a seek and a small read of its own. Once a drive has been asked for
+   two sectors in a row, the next SIO_READAHEAD sectors are fetched with
+   one read into a per-drive buffer and the requests that follow are served
+   from it. Only the regular sectors (4 on) of ATR and XFD images are laid
+   out one after another in the file, so only those are read ahead. With
+   SIO_burst_enabled, SIO_Handler() copies a sector that is already in the
+   buffer straight to the Atari without decoding the rest of the request. */
+#define SIO_READAHEAD       16              /* sectors per read-ahead - 4K in double density */
+
+int SIO_readahead_enabled = TRUE;
+int SIO_burst_enabled = TRUE;
+ULONG SIO_readahead_hits[SIO_MAX_DRIVES];   /* sectors served from the buffer */
+ULONG SIO_readahead_misses[SIO_MAX_DRIVES]; /* reads that went to the file */
+static UBYTE readahead_buf[SIO_MAX_DRIVES][SIO_READAHEAD * 256];
+static int readahead_first[SIO_MAX_DRIVES]; /* first sector in the buffer */
+static int readahead_count[SIO_MAX_DRIVES]; /* sectors in the buffer, 0 if none */
+static int readahead_last[SIO_MAX_DRIVES];  /* sector last read, to spot a run */
+
 /* stores dup sector counter for PRO images */
 typedef struct tagpro_additional_info_t {
     int max_sector;
@@ -183,6 +236,240 @@ int ExpectedBytes = 0;
 
 const int ignore_header_writeprotect = FALSE;
 
+ULONG SIO_flush_runs = 0;
+ULONG SIO_flush_errors = 0;
+
+#define DIRTY_BLOCKS(size)  (((size) + (1 << SIO_BLOCK_SHIFT) - 1) >> SIO_BLOCK_SHIFT)
+#define DIRTY_BYTES(size)   ((DIRTY_BLOCKS(size) + 7) >> 3)
+
+/* Read the whole of a just mounted image into RAM, if it fits */
+static void CacheImage(int unit, FILE *f)
+{
+    ULONG size;
+    UBYTE *image;
+    UBYTE *dirty;
+
+    if (!SIO_cache_enabled)
+        return;
+    size = Util_flen(f);
+    if (size == 0 || size > SIO_CACHE_MAX || disk_cache_used + size > SIO_CACHE_TOTAL)
+        return;
+    /* not Util_malloc() - running out of memory here only means no cache */
+    image = (UBYTE *) malloc(size);
+    dirty = (UBYTE *) calloc(DIRTY_BYTES(size), 1);
+    if (image == NULL || dirty == NULL || fseek(f, 0, SEEK_SET) != 0 || fread(image, 1, size, f) != size) {
+        free(image);
+        free(dirty);
+        return;
+    }
+    disk_image[unit] = image;
+    disk_image_size[unit] = size;
+    disk_dirty[unit] = dirty;
+    disk_dirty_blocks[unit] = 0;
+    disk_idle_frames[unit] = 0;
+    disk_pos[unit] = 0;
+    disk_cache_used += size;
+}
+
+/* Write the dirty blocks of an image back to its file, a run of
+   consecutive blocks at a time. A run that doesn't make it to the file
+   stays dirty, to be tried again the next time the drive goes quiet, and
+   is counted in SIO_flush_errors. */
+static void FlushImage(int unit)
+{
+    UBYTE *dirty = disk_dirty[unit];
+    ULONG size = disk_image_size[unit];
+    ULONG blocks = DIRTY_BLOCKS(size);
+    ULONG block = 0;
+    int ok = TRUE;
+
+    if (disk_dirty_blocks[unit] == 0)
+        return;
+    if (disk_image[unit] == NULL) {
+        /* read from its file - only the stdio buffer to write out */
+        SIO_flush_runs++;
+        if (fflush(disk[unit]) == 0)
+            disk_dirty_blocks[unit] = 0;
+        else {
+            SIO_flush_errors++;
+            disk_idle_frames[unit] = 0;
+        }
+        return;
+    }
+    while (block < blocks) {
+        ULONG start;
+        ULONG offset;
+        ULONG len;
+        if (dirty[block >> 3] == 0) {
+            block = (block | 7) + 1;
+            continue;
+        }
+        if (!(dirty[block >> 3] & (1 << (block & 7)))) {
+            block++;
+            continue;
+        }
+        start = block;
+        while (block < blocks && (dirty[block >> 3] & (1 << (block & 7))))
+            block++;
+        offset = start << SIO_BLOCK_SHIFT;
+        len = (block << SIO_BLOCK_SHIFT) - offset;
+        if (offset + len > size)
+            len = size - offset;
+        SIO_flush_runs++;
+        if (fseek(disk[unit], offset, SEEK_SET) != 0
+         || fwrite(disk_image[unit] + offset, 1, len, disk[unit]) != len) {
+            ok = FALSE;
+            continue;
+        }
+        disk_dirty_blocks[unit] -= block - start;
+        for (; start < block; start++)
+            dirty[start >> 3] &= ~(1 << (start & 7));
+    }
+    if (fflush(disk[unit]) != 0)
+        ok = FALSE;
+    if (!ok) {
+        SIO_flush_errors++;
+        disk_idle_frames[unit] = 0;
+    }
+}
+
+/* Flush and drop the RAM copy of an image - the file is used from here on */
+static void UncacheImage(int unit)
+{
+    if (disk_image[unit] == NULL)
+        return;
+    FlushImage(unit);
+    free(disk_image[unit]);
+    free(disk_dirty[unit]);
+    disk_image[unit] = NULL;
+    disk_dirty[unit] = NULL;
+    disk_cache_used -= disk_image_size[unit];
+    disk_image_size[unit] = 0;
+}
+
+/* fseek(), fread() and fwrite() on disk[unit], or on its RAM copy */
+static void DiskSeek(int unit, ULONG offset)
+{
+    if (disk_image[unit] != NULL)
+        disk_pos[unit] = offset;
+    else
+        fseek(disk[unit], offset, SEEK_SET);
+}
+
+static int DiskRead(int unit, void *buffer, int size)
+{
+    ULONG pos;
+
+    if (disk_image[unit] == NULL)
+        return fread(buffer, 1, size, disk[unit]);
+    pos = disk_pos[unit];
+    if (pos >= disk_image_size[unit])
+        return 0;
+    if (pos + size > disk_image_size[unit])
+        size = disk_image_size[unit] - pos;
+    memcpy(buffer, disk_image[unit] + pos, size);
+    disk_pos[unit] = pos + size;
+    return size;
+}
+
+static int DiskWrite(int unit, const void *buffer, int size)
+{
+    ULONG pos = disk_pos[unit];
+    ULONG block;
+
+    if (disk_image[unit] != NULL && pos + size > disk_image_size[unit]) {
+        /* writing past the end grows the file - leave that to the file */
+        UncacheImage(unit);
+        fseek(disk[unit], pos, SEEK_SET);
+    }
+    if (disk_image[unit] == NULL) {
+        disk_dirty_blocks[unit] = 1;    /* for SIO_Frame() to fflush() */
+        disk_idle_frames[unit] = 0;
+        return fwrite(buffer, 1, size, disk[unit]);
+    }
+    memcpy(disk_image[unit] + pos, buffer, size);
+    for (block = pos >> SIO_BLOCK_SHIFT; block <= (pos + size - 1) >> SIO_BLOCK_SHIFT; block++) {
+        if (!(disk_dirty[unit][block >> 3] & (1 << (block & 7)))) {
+            disk_dirty[unit][block >> 3] |= 1 << (block & 7);
+            disk_dirty_blocks[unit]++;
+        }
+    }
+    disk_pos[unit] = pos + size;
+    disk_idle_frames[unit] = 0;
+    return size;
+}
+
+/* The sector from the read-ahead buffer, or NULL if it isn't there */
+static const UBYTE *ReadAheadHit(int unit, int sector)
+{
+    int index = sector - readahead_first[unit];
+    if (index < 0 || index >= readahead_count[unit])
+        return NULL;
+    SIO_readahead_hits[unit]++;
+    readahead_last[unit] = sector;
+    return readahead_buf[unit] + index * sectorsize[unit];
+}
+
+/* Read a sector through the read-ahead buffer, filling it if this read
+   carries on from the last one. FALSE if it has to be read as usual. */
+static int ReadAhead(int unit, int sector, UBYTE *buffer)
+{
+    const UBYTE *hit;
+    int size = sectorsize[unit];
+    int count;
+    ULONG offset;
+
+    if (!SIO_readahead_enabled || disk_image[unit] != NULL || sector < 4
+        || (image_type[unit] != IMAGE_TYPE_ATR && image_type[unit] != IMAGE_TYPE_XFD))
+        return FALSE;
+    hit = ReadAheadHit(unit, sector);
+    if (hit != NULL) {
+        memcpy(buffer, hit, size);
+        return TRUE;
+    }
+    if (sector != readahead_last[unit] + 1) {
+        readahead_last[unit] = sector;
+        return FALSE;
+    }
+    readahead_last[unit] = sector;
+    count = sectorcount[unit] - sector + 1;
+    if (count > SIO_READAHEAD)
+        count = SIO_READAHEAD;
+    SIO_SizeOfSector((UBYTE) unit, sector, NULL, &offset);
+    fseek(disk[unit], offset, SEEK_SET);
+    readahead_count[unit] = fread(readahead_buf[unit], 1, count * size, disk[unit]) / size;
+    readahead_first[unit] = sector;
+    if (readahead_count[unit] == 0)
+        return FALSE;
+    SIO_readahead_misses[unit]++;
+    memcpy(buffer, readahead_buf[unit], size);
+    return TRUE;
+}
+
+static void ReadAheadReset(int unit)
+{
+    readahead_count[unit] = 0;
+    readahead_last[unit] = 0;
+}
+
+/* Write back everything written to the mounted images so far */
+void SIO_FlushDisks(void)
+{
+    int i;
+    for (i = 0; i < SIO_MAX_DRIVES; i++)
+        if (disk[i] != NULL)
+            FlushImage(i);
+}
+
+/* Called once a frame - write back an image once its drive has gone quiet */
+void SIO_Frame(void)
+{
+    int i;
+    for (i = 0; i < SIO_MAX_DRIVES; i++)
+        if (disk_dirty_blocks[i] != 0 && ++disk_idle_frames[i] >= SIO_FLUSH_FRAMES)
+            FlushImage(i);
+}
+
 int SIO_Initialise(int *argc, char *argv[])
 {
     int i;
@@ -218,11 +505,15 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
     /* release previous disk */
     SIO_Dismount(diskno);
 
-    /* open file */
+    /* open file - GZ_fopen() in place of Util_fopen(), so mark sio_tmpbuf as
+       not holding a temporary file's name for Util_fclose() as that did */
+#if !defined(HAVE_TMPFILE) && defined(HAVE_UTIL_UNLINK)
+    sio_tmpbuf[diskno - 1][0] = '\0';
+#endif
     if (!b_open_readonly)
-        f = Util_fopen(filename, "rb+", sio_tmpbuf[diskno - 1]);
+        f = GZ_fopen(filename, "rb+");
     if (f == NULL) {
-        f = Util_fopen(filename, "rb", sio_tmpbuf[diskno - 1]);
+        f = GZ_fopen(filename, "rb");
         if (f == NULL)
             return FALSE;
         status = SIO_READ_ONLY;
@@ -295,7 +586,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 #ifndef VAPI_WRITE_ENABLE
         if (!b_open_readonly) {
             fclose(f);
-            f = Util_fopen(filename, "rb", sio_tmpbuf[diskno - 1]);
+            f = GZ_fopen(filename, "rb");
             if (f == NULL)
                 return FALSE;
             status = SIO_READ_ONLY;
@@ -437,7 +728,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
             /* .pro is read only for now */
             if (!b_open_readonly) {
                 fclose(f);
-                f = Util_fopen(filename, "rb", sio_tmpbuf[diskno - 1]);
+                f = GZ_fopen(filename, "rb");
                 if (f == NULL)
                     return FALSE;
                 status = SIO_READ_ONLY;
@@ -491,14 +782,19 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
     strcpy(SIO_filename[diskno - 1], filename);
     SIO_drive_status[diskno - 1] = status;
     disk[diskno - 1] = f;
+    CacheImage(diskno - 1, f);
+    ReadAheadReset(diskno - 1);
     return TRUE;
 }
 
 void SIO_Dismount(int diskno)
 {
     if (disk[diskno - 1] != NULL) {
+        UncacheImage(diskno - 1);
+        ReadAheadReset(diskno - 1);
         Util_fclose(disk[diskno - 1], sio_tmpbuf[diskno - 1]);
         disk[diskno - 1] = NULL;
+        disk_dirty_blocks[diskno - 1] = 0;
         SIO_drive_status[diskno - 1] = SIO_NO_DISK;
         strcpy(SIO_filename[diskno - 1], "Empty");
         if (image_type[diskno - 1] == IMAGE_TYPE_PRO) {
@@ -578,7 +874,7 @@ static int SeekSector(int unit, int sector)
     int size;
 
     SIO_SizeOfSector((UBYTE) unit, sector, &size, &offset);
-    fseek(disk[unit], offset, SEEK_SET);
+    DiskSeek(unit, offset);
 
     return size;
 }
@@ -600,6 +896,12 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
     if (sector <= 0 || sector > sectorcount[unit])
         return 'E';
     SIO_last_drive = unit + 1;
+    if (ReadAhead(unit, sector, buffer)) {
+        io_success[unit] = 0;
+        return 'C';
+    }
+    if (disk_image[unit] == NULL)
+        SIO_readahead_misses[unit]++;
     /* FIXME: what sector size did the user expect? */
     size = SeekSector(unit, sector);
     if (image_type[unit] == IMAGE_TYPE_PRO) {
@@ -607,7 +909,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
         unsigned char *count;
         info = (pro_additional_info_t *)additional_info[unit];
         count = info->count;
-        if (fread(buffer, 1, 12, disk[unit]) < 12) {
+        if (DiskRead(unit, buffer, 12) < 12) {
             return 'E';
         }
         /* handle duplicate sectors */
@@ -625,14 +927,14 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
                 }
                 size = SeekSector(unit, sector);
                 /* read sector header */
-                if (fread(buffer, 1, 12, disk[unit]) < 12) {
+                if (DiskRead(unit, buffer, 12) < 12) {
                     return 'E';
                 }
             }
         }
         /* bad sector */
         if (buffer[1] != 0xff) {
-            if (fread(buffer, 1, size, disk[unit]) < size) {
+            if (DiskRead(unit, buffer, size) < size) {
             }
             io_success[unit] = sector;
 #ifdef DEBUG_PRO
@@ -723,13 +1025,13 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
         if (secinfo->sec_count > 1)
             Log_print("duplicate sector:%d dupnum:%d delay:%d",sector, secindex,info->vapi_delay_time);
 #endif
-        fseek(disk[unit],secinfo->sec_offset[secindex],SEEK_SET);
+        DiskSeek(unit, secinfo->sec_offset[secindex]);
         info->sec_stat_buff[0] = 0x8 | ((secinfo->sec_status[secindex] == 0xFF) ? 0 : 0x04);
         info->sec_stat_buff[1] = secinfo->sec_status[secindex];
         info->sec_stat_buff[2] = 0xe0;
         info->sec_stat_buff[3] = 0;
         if (secinfo->sec_status[secindex] != 0xFF) {
-            if (fread(buffer, 1, size, disk[unit]) < size) {
+            if (DiskRead(unit, buffer, size) < size) {
             }
             io_success[unit] = sector;
             info->vapi_delay_time += VAPI_CYCLES_PER_ROT + 10000;
@@ -751,7 +1053,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
         Log_flushlog();
 #endif      
     }
-    if (fread(buffer, 1, size, disk[unit]) < size) {
+    if (DiskRead(unit, buffer, size) < size) {
     }
     io_success[unit] = 0;
     return 'C';
@@ -789,8 +1091,8 @@ int SIO_WriteSector(int unit, int sector, const UBYTE *buffer)
         }
         
         size = SeekSector(unit, sector);
-        fseek(disk[unit],secinfo->sec_offset[0],SEEK_SET);
-        fwrite(buffer, 1, size, disk[unit]);
+        DiskSeek(unit, secinfo->sec_offset[0]);
+        DiskWrite(unit, buffer, size);
         io_success[unit] = 0;
         return 'C';
 #if 0       
@@ -812,7 +1114,9 @@ int SIO_WriteSector(int unit, int sector, const UBYTE *buffer)
     } 
 #endif
     size = SeekSector(unit, sector);
-    fwrite(buffer, 1, size, disk[unit]);
+    DiskWrite(unit, buffer, size);
+    if (sector >= readahead_first[unit] && sector < readahead_first[unit] + readahead_count[unit])
+        memcpy(readahead_buf[unit] + (sector - readahead_first[unit]) * size, buffer, size);
     io_success[unit] = 0;
     return 'C';
 }
@@ -1000,7 +1304,7 @@ int SIO_DriveStatus(int unit, UBYTE *buffer)
     if (io_success[unit] != 0  && image_type[unit] == IMAGE_TYPE_PRO) {
         int sector = io_success[unit];
         SeekSector(unit, sector);
-        if (fread(buffer, 1, 4, disk[unit]) < 4) {
+        if (DiskRead(unit, buffer, 4) < 4) {
         }
         return 'C';
     }
@@ -1126,6 +1430,20 @@ void SIO_Handler(void)
                 delay_counter = 0;
             }
 #endif
+            if (SIO_burst_enabled && !BINLOAD_start_binloading && length == sectorsize[unit]
+                && SIO_drive_status[unit] != SIO_OFF && disk[unit] != NULL) {
+                /* the next sector of a run - straight out of the read-ahead buffer,
+                   for a drive SIO_ReadSector() would read it from */
+                const UBYTE *hit = ReadAheadHit(unit, sector);
+                if (hit != NULL) {
+                    dsShowDiskActivity(unit);
+                    CopyToMem(hit, data, length);
+                    SIO_last_drive = unit + 1;
+                    io_success[unit] = 0;
+                    result = 'C';
+                    break;
+                }
+            }
             SIO_SizeOfSector(unit, sector, &realsize, NULL);
             if (realsize == length) {
                 result = SIO_ReadSector(unit, sector, DataBuffer);
@@ -1179,7 +1497,22 @@ void SIO_Handler(void)
     }
     /* cassette i/o */
     else if (dGetByte(0x300) == 0x60) {
-        result = 'N';
+        /* The tape is read only - a record at a time, straight from the image */
+        if (cmd == 0x52 && CASSETTE_record_count > 0) {
+            switch (CASSETTE_ReadToMemory(data, length)) {
+            case 1:
+                result = 'C';
+                break;
+            case -1:
+                result = 'E';
+                break;
+            default:
+                result = 0;         /* off the end of the tape */
+                break;
+            }
+        }
+        else
+            result = 'N';
     }
 
     switch (result) {
@@ -1207,6 +1540,8 @@ void SIO_Handler(void)
     }
     CPU_regA = 0;   /* MMM */
     dPutByte(0x0303, CPU_regY);
+    if (dGetByte(0x300) == 0x60)
+        dPutByte(0x30, CPU_regY);   /* STATUS - the C: handler takes the result from there */
     dPutByte(0x42,0);
     CPU_SetC;
 }
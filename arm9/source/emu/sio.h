@@ -106,6 +106,19 @@ void SIO_PutByte(int byte);
 int SIO_GetByte(void);
 int SIO_Initialise(int *argc, char *argv[]);
 void SIO_Exit(void);
+void SIO_Frame(void);
+void SIO_FlushDisks(void);
+
+/* Mounted images are held in RAM (see sio.c) while this is set */
+extern int SIO_cache_enabled;
+extern ULONG SIO_flush_runs;
+extern ULONG SIO_flush_errors;          /* write-backs that didn't make it to the file */
+
+/* Sequential sectors of images not held in RAM are read ahead (see sio.c) */
+extern int SIO_readahead_enabled;
+extern int SIO_burst_enabled;
+extern ULONG SIO_readahead_hits[SIO_MAX_DRIVES];
+extern ULONG SIO_readahead_misses[SIO_MAX_DRIVES];
 
 /* Some defines about the serial I/O timing. Currently fixed! */
 #define SIO_XMTDONE_INTERVAL  15
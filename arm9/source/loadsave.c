@@ -45,6 +45,10 @@
 
 #define SAVE_FILE_REV   0x0005
 
+// The sound ring was 256 bytes when this revision was set. It has grown since
+// but only that much is kept - it's just the last few milliseconds of audio.
+#define SAVE_POKEY_BUFFER   256
+
 char save_filename[300+4];
 
 u32 XE_MemUsed(void)
@@ -192,6 +196,11 @@ u8 spare_bytes[256];
 void SaveGame(void)
 {
     UWORD t0 = TIMER0_DATA;
+    
+    // Disk writes are held in RAM until the drive goes quiet - put them on the
+    // SD card now so the disk image matches the state we are about to save.
+    SIO_FlushDisks();
+    
     DIR* dir = opendir("sav");
     if (dir)
     {
@@ -221,6 +230,7 @@ void SaveGame(void)
         fwrite(&cart809F_enabled,               sizeof(cart809F_enabled),               1, fp);
         fwrite(&cartA0BF_enabled,               sizeof(cartA0BF_enabled),               1, fp);
 
+        CPU_FlushBlockCache();  // Take the code page write hooks out of the writemap before saving it
         SaveWriteMap();
         fwrite(saved_writemap,                  sizeof(saved_writemap),                 1, fp);
         
@@ -350,6 +360,7 @@ void SaveGame(void)
         fwrite(&COLPF3,                         sizeof(COLPF3),                         1, fp);
         fwrite(&COLBK,                          sizeof(COLBK),                          1, fp);
         fwrite(&GRACTL,                         sizeof(GRACTL),                         1, fp);
+        update_partial_pmpl_colls();    // Fold any logged lines into the collision registers first
         fwrite(&M0PL,                           sizeof(M0PL),                           1, fp);
         fwrite(&M1PL,                           sizeof(M1PL),                           1, fp);
         fwrite(&M2PL,                           sizeof(M2PL),                           1, fp);
@@ -405,7 +416,7 @@ void SaveGame(void)
 
         // POKEY
         fwrite(&pokeyBufIdx,                    sizeof(pokeyBufIdx),                    1, fp);
-        fwrite(pokey_buffer,                    sizeof(pokey_buffer),                   1, fp);
+        fwrite(pokey_buffer,                    SAVE_POKEY_BUFFER,                      1, fp);
         fwrite(&KBCODE,                         sizeof(KBCODE),                         1, fp);
         fwrite(&SERIN,                          sizeof(SERIN),                          1, fp);
         fwrite(&IRQST,                          sizeof(IRQST),                          1, fp);
@@ -420,6 +431,7 @@ void SaveGame(void)
         fwrite(AUDF,                            sizeof(AUDF),                           1, fp);
         fwrite(AUDC,                            sizeof(AUDC),                           1, fp);
         fwrite(AUDCTL,                          sizeof(AUDCTL),                         1, fp);
+        POKEYStateSave();
         fwrite(DivNIRQ,                         sizeof(DivNIRQ),                        1, fp);
         fwrite(DivNMax,                         sizeof(DivNMax),                        1, fp);
         fwrite(Base_mult,                       sizeof(Base_mult),                      1, fp);
@@ -450,7 +462,8 @@ void SaveGame(void)
         fwrite(&emu_state,                      sizeof(emu_state),                      1, fp);
         fwrite(&atari_frames,                   sizeof(atari_frames),                   1, fp);
         fwrite(&sound_idx,                      sizeof(sound_idx),                      1, fp);
-        fwrite(&myPokeyBufIdx,                  sizeof(myPokeyBufIdx),                  1, fp);
+        u8 play_idx = (u8) myPokeyBufIdx;       // Still the one byte it always was - the ring is restarted on load anyway
+        fwrite(&play_idx,                       sizeof(play_idx),                       1, fp);
         fwrite(&t0,                             sizeof(t0),                             1, fp);
         fwrite(spare_bytes,                     32,                                     1, fp);
         
@@ -498,6 +511,7 @@ void LoadGame(void)
             
             fread(ls_mem_map,                      sizeof(ls_mem_map),                     1, fp);
             err = RestoreMemMap();
+            CPU_FlushBlockCache();  // Memory and banking just changed under any predecoded code
 
             u8 xeType = 0;
             u32 offset = 0;
@@ -625,6 +639,7 @@ void LoadGame(void)
             fread(&COLPF3,                         sizeof(COLPF3),                         1, fp);
             fread(&COLBK,                          sizeof(COLBK),                          1, fp);
             fread(&GRACTL,                         sizeof(GRACTL),                         1, fp);
+            update_partial_pmpl_colls();    // Empties the collision log - the registers are read back next
             fread(&M0PL,                           sizeof(M0PL),                           1, fp);
             fread(&M1PL,                           sizeof(M1PL),                           1, fp);
             fread(&M2PL,                           sizeof(M2PL),                           1, fp);
@@ -679,7 +694,8 @@ void LoadGame(void)
             
             // POKEY
             fread(&pokeyBufIdx,                    sizeof(pokeyBufIdx),                    1, fp);
-            fread(pokey_buffer,                    sizeof(pokey_buffer),                   1, fp);
+            fread(pokey_buffer,                    SAVE_POKEY_BUFFER,                      1, fp);
+            pokeyBufIdx &= (SAVE_POKEY_BUFFER - 1);
             fread(&KBCODE,                         sizeof(KBCODE),                         1, fp);
             fread(&SERIN,                          sizeof(SERIN),                          1, fp);
             fread(&IRQST,                          sizeof(IRQST),                          1, fp);
@@ -696,6 +712,7 @@ void LoadGame(void)
             fread(AUDCTL,                          sizeof(AUDCTL),                         1, fp);
             fread(DivNIRQ,                         sizeof(DivNIRQ),                        1, fp);
             fread(DivNMax,                         sizeof(DivNMax),                        1, fp);
+            POKEYStateRead();
             fread(Base_mult,                       sizeof(Base_mult),                      1, fp);
             fread(POT_input,                       sizeof(POT_input),                      1, fp);
             fread(PCPOT_input,                     sizeof(PCPOT_input),                    1, fp);
@@ -716,6 +733,7 @@ void LoadGame(void)
             fread(&P17,                            sizeof(P17),                            1, fp);
             fread(&Samp_n_max,                     sizeof(Samp_n_max),                     1, fp);
             fread(Samp_n_cnt,                      sizeof(Samp_n_cnt),                     1, fp);
+            Pokey_sound_sync_regs();
             fread(spare_bytes,                     32,                                     1, fp);
 
             //A8DS
@@ -723,7 +741,9 @@ void LoadGame(void)
             fread(&emu_state,                      sizeof(emu_state),                      1, fp);
             fread(&atari_frames,                   sizeof(atari_frames),                   1, fp);
             fread(&sound_idx,                      sizeof(sound_idx),                      1, fp);
-            fread(&myPokeyBufIdx,                  sizeof(myPokeyBufIdx),                  1, fp);
+            u8 play_idx;
+            fread(&play_idx,                       sizeof(play_idx),                       1, fp);
+            myPokeyBufIdx = pokeyBufIdx;            // Play from where the Pokey writes next - not from stale samples
             fread(&t0,                             sizeof(t0),                             1, fp);
             fread(spare_bytes,                     32,                                     1, fp);
 
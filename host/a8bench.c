@@ -0,0 +1,458 @@
+/*
+ * A8BENCH.C is a headless frame-throughput benchmark for the A8DS emulation
+ * core. It boots an image (or just the built-in OS), runs Atari800_Frame()
+ * a given number of times and reports frames per second, per-frame time
+ * percentiles and a hash of the final framebuffer and of every audio sample
+ * produced - so both speed and bit-exactness of a change can be checked
+ * before anything is flashed to a card.
+ *
+ *   a8bench [-frames N] [-warmup N] [-pal] [-ram 0..5] [-basic] [-skip 0..3] [-dsscale N] [-noidle] [-nocoll] [-nodirty] [-noglyph] [-noplan] [-noslice] [-dlist] [-pokeybatch N] [-sound 0..3] [-stereo] [-pace] [-nodiskcache] [-nobulkload] [-nosiopatch] [-hashall] [-segments] [-dump out.pgm] [-profile out.txt] [image]
+ *
+ * It also drives the 6502 core on its own (see cputest.c) and the sound core
+ * on its own (see soundtest.c) and the SIO disk layer on its own (see
+ * disktest.c) and checks a gzip compressed image against the one it was
+ * made from (see gztest.c). It also writes out the test images the compare
+ * targets use (see testimg.c):
+ *
+ *   a8bench -cputest
+ *   a8bench -cpu test.bin [-load addr] [-start addr] [-success addr] [-error addr] [-mcycles N] [-noidle]
+ *   a8bench -opbench [-only name] [-mcycles N]
+ *   a8bench -soundtest
+ *   a8bench -disktest image.atr
+ *   a8bench -gztest image.atr.gz image.atr
+ *   a8bench -mkimage name out
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "cpu.h"
+#include "antic.h"
+#include "pokey.h"
+#include "pokeysnd.h"
+#include "profile.h"
+#include "cputest.h"
+#include "soundtest.h"
+#include "disktest.h"
+#include "testimg.h"
+#include "gztest.h"
+#include "sio.h"
+#include "binload.h"
+#include "cassette.h"
+#include "esc.h"
+#include "input.h"
+
+#define FNV_OFFSET  0x811C9DC5u
+#define FNV_PRIME   0x01000193u
+
+typedef struct
+{
+    unsigned int hash;
+    unsigned int count;
+} audio_sum_t;
+
+static unsigned int fnv1a(unsigned int h, const UBYTE *p, int len)
+{
+    while (len--) { h ^= *p++; h *= FNV_PRIME; }
+    return h;
+}
+
+static void audio_sink(const UBYTE *samples, int count, void *ctx)
+{
+    audio_sum_t *sum = (audio_sum_t *)ctx;
+    sum->hash = fnv1a(sum->hash, samples, count);
+    sum->count += count;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void sleep_us(double us)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t) (us / 1e6);
+    ts.tv_nsec = (long) ((us - ts.tv_sec * 1e6) * 1e3);
+    nanosleep(&ts, NULL);
+}
+
+// ---------------------------------------------------------------------------
+// -pace: FRAME PACING = AUDIO CLOCK in real time. A pretend sound card plays
+// the samples off the host clock at the Pokey rate, nudged by the pacer just
+// as the DS sound timer is, and before each frame we sleep until it has
+// played the ring down to one frame's worth - what dsPaceToAudio() does.
+// Samples it wanted but didn't have count as underruns, samples made beyond
+// what the DS ring could hold as overruns.
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    double made;        // Samples the Pokey has produced
+    double played;      // And the card has played
+    double last_us;
+} pace_card_t;
+
+static double pace_rate(void)
+{
+    return snd_playback_freq * (1.0 + pace_adjust / 65536.0);
+}
+
+static void pace_play(pace_card_t *card)
+{
+    double now = now_us();
+    card->played += (now - card->last_us) * pace_rate() / 1e6;
+    card->last_us = now;
+    if (card->played > card->made)
+    {
+        pace_underruns += (ULONG) (card->played - card->made + 0.5);
+        card->played = card->made;
+    }
+}
+
+static void pace_wait(pace_card_t *card)
+{
+    int frame = snd_playback_freq / (myConfig.tv_type == TV_NTSC ? 60 : 50);
+    for (;;)
+    {
+        pace_play(card);
+        double fill = card->made - card->played;
+        if (fill <= frame) break;
+        sleep_us((fill - frame) * 1e6 / pace_rate());
+    }
+    Atari800_PaceRate((int) (card->made - card->played));
+}
+
+static void pace_made(pace_card_t *card, unsigned int samples)
+{
+    if (card->made == 0) card->last_us = now_us();     // The card starts with the first frame's samples
+    pace_play(card);
+    card->made += samples;
+    double over = card->made - card->played - (SNDLENGTH / Num_pokeys);
+    if (over > 0)
+    {
+        pace_overruns += (ULONG) over;
+        card->played += over;
+    }
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int n, double pct)
+{
+    int idx = (int)(pct / 100.0 * (n - 1) + 0.5);
+    return sorted[idx];
+}
+
+// ---------------------------------------------------------------------------
+// Write the visible part of bg2 as a greyscale PGM of raw Atari colour
+// indices - handy for eyeballing a run or diffing two builds.
+// ---------------------------------------------------------------------------
+static void dump_screen(const char *filename)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) return;
+    fprintf(fp, "P5\n%d %d\n255\n", ATARI_WIDTH - 64, ATARI_HEIGHT);
+    for (int y = 0; y < ATARI_HEIGHT; y++)
+        fwrite((UBYTE *)bgGetGfxPtr(bg2) + y * 512 + 32, 1, ATARI_WIDTH - 64, fp);
+    fclose(fp);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: a8bench [-frames N] [-warmup N] [-pal] [-ram 0..5] [-basic] [-skip 0..3] [-dsscale N] [-noidle] [-nocoll] [-nodirty] [-noglyph] [-noplan] [-noslice] [-dlist] [-pokeybatch N] [-sound 0..3] [-stereo] [-pace] [-nodiskcache] [-nobulkload] [-nosiopatch] [-hashall] [-segments] [-dump out.pgm] [-profile out.txt] [image]\n");
+    fprintf(stderr, "       a8bench -cputest\n");
+    fprintf(stderr, "       a8bench -cpu test.bin [-load addr] [-start addr] [-success addr] [-error addr] [-mcycles N] [-noidle]\n");
+    fprintf(stderr, "       a8bench -opbench [-only name] [-mcycles N]\n");
+    fprintf(stderr, "       a8bench -soundtest\n");
+    fprintf(stderr, "       a8bench -disktest image.atr\n");
+    fprintf(stderr, "       a8bench -gztest image.atr.gz image.atr\n");
+    fprintf(stderr, "       a8bench -mkimage name out\n");
+    exit(1);
+}
+
+// ---------------------------------------------------------------------------
+// Print the segment table of the executable that was loaded.
+// ---------------------------------------------------------------------------
+static void dump_segments(void)
+{
+    printf("%d segments", BINLOAD_segment_count);
+    if (BINLOAD_trailing_bytes) printf(", %d bytes left over after the last", BINLOAD_trailing_bytes);
+    printf("\n  seg  start  end    offset  length  flags\n");
+    for (int i = 0; i < BINLOAD_segment_count; i++)
+    {
+        const BINLOAD_Segment *seg = &BINLOAD_segments[i];
+        printf("  %3d  $%04X  $%04X  %6u  %6u  %s%s%s%s%s%s\n", i, seg->start, seg->end, (unsigned) seg->offset, (unsigned) seg->length,
+               seg->flags & BINLOAD_SEG_HEADER ? "$FFFF " : "", seg->flags & BINLOAD_SEG_INIT ? "INIT " : "",
+               seg->flags & BINLOAD_SEG_RUN ? "RUN " : "", seg->flags & BINLOAD_SEG_WRAPS ? "WRAPS " : "",
+               seg->flags & BINLOAD_SEG_SHORT ? "SHORT " : "", seg->flags & BINLOAD_SEG_HOOKED ? "HOOKED" : "");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Print what ANTIC made of the display list in the last frame.
+// ---------------------------------------------------------------------------
+static void dump_dlist(void)
+{
+    static const char *mode_name[16] = {"blank", "jump", "2", "3", "4", "5", "6", "7", "8", "9", "A", "B", "C", "D", "E", "F"};
+    const antic_dl_plan_t *plan = ANTIC_GetDListPlan();
+
+    printf("display list at $%04X, %d instructions\n", plan->start, plan->count);
+    printf("  line  addr   IR  mode  lines  dma  flags\n");
+    for (int i = 0; i < plan->count; i++)
+    {
+        const antic_dl_entry_t *e = &plan->entry[i];
+        int mode = e->ir & 0x0f;
+        printf("  %4d  $%04X  %02X  %-5s %5d  %3d  %s%s%s%s", e->ypos, e->addr, e->ir, mode_name[mode], e->lines, e->dl_cycles,
+               e->ir & 0x80 ? "DLI " : "", mode > 1 && (e->ir & 0x20) ? "VSCROL " : "", mode > 1 && (e->ir & 0x10) ? "HSCROL " : "",
+               mode == 1 && (e->ir & 0x40) ? "JVB " : "");
+        if (e->dl_cycles > 1) printf("%s $%04X", mode == 1 ? "to" : "LMS", e->operand);
+        printf("\n");
+    }
+}
+
+// Addresses may be given as $1234, 0x1234 or plain decimal
+static int parse_addr(const char *arg)
+{
+    int addr = (arg[0] == '$') ? (int) strtol(arg + 1, NULL, 16) : (int) strtol(arg, NULL, 0);
+    if (addr < 0 || addr > 0xffff) usage();
+    return addr;
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = 3000, warmup = 120;
+    int tv_type = TV_NTSC, ram_type = RAM_IDX_128K, basic_type = BASIC_NONE, skip_frames = 0, idle_skip = 1, collision_disable = 0;
+    const char *image = NULL;
+    const char *dump = NULL;
+    const char *profile = NULL;
+    const char *cpu_test = NULL;
+    const char *only = NULL;
+    const char *gz_test = NULL;
+    const char *mkimage = NULL;
+    int show_segments = 0, show_dlist = 0, hash_all = 0, sound_mode = 0, sound_test = 0, disk_test = 0, pokey_stereo = 0, pace = 0;
+    int sio_patch = 1, cpu_selftest = 0, opbench = 0, load = 0x0000, start = 0x0400, success = CPUTEST_NONE, error = CPUTEST_NONE;
+    double mcycles = 0, dsscale = 0;
+    audio_sum_t audio = {FNV_OFFSET, 0};
+    unsigned int frames_hash = FNV_OFFSET;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if      (!strcmp(argv[i], "-frames") && i+1 < argc) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-warmup") && i+1 < argc) warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-ram")    && i+1 < argc) ram_type = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-skip")   && i+1 < argc) skip_frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-dump")   && i+1 < argc) dump = argv[++i];
+        else if (!strcmp(argv[i], "-profile") && i+1 < argc) profile = argv[++i];
+        else if (!strcmp(argv[i], "-cpu")    && i+1 < argc) cpu_test = argv[++i];
+        else if (!strcmp(argv[i], "-load")   && i+1 < argc) load = parse_addr(argv[++i]);
+        else if (!strcmp(argv[i], "-start")  && i+1 < argc) start = parse_addr(argv[++i]);
+        else if (!strcmp(argv[i], "-success") && i+1 < argc) success = parse_addr(argv[++i]);
+        else if (!strcmp(argv[i], "-error")  && i+1 < argc) error = parse_addr(argv[++i]);
+        else if (!strcmp(argv[i], "-mcycles") && i+1 < argc) mcycles = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-dsscale") && i+1 < argc) dsscale = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-pokeybatch") && i+1 < argc) pokey_batch_lines = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-sound")  && i+1 < argc) sound_mode = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-stereo"))               pokey_stereo = 1;
+        else if (!strcmp(argv[i], "-pace"))                 pace = 1;
+        else if (!strcmp(argv[i], "-only")   && i+1 < argc) only = argv[++i];
+        else if (!strcmp(argv[i], "-cputest"))              cpu_selftest = 1;
+        else if (!strcmp(argv[i], "-opbench"))              opbench = 1;
+        else if (!strcmp(argv[i], "-soundtest"))            sound_test = 1;
+        else if (!strcmp(argv[i], "-disktest"))             disk_test = 1;
+        else if (!strcmp(argv[i], "-gztest") && i+1 < argc) gz_test = argv[++i];
+        else if (!strcmp(argv[i], "-mkimage") && i+1 < argc) mkimage = argv[++i];
+        else if (!strcmp(argv[i], "-nodiskcache"))          SIO_cache_enabled = FALSE;
+        else if (!strcmp(argv[i], "-nobulkload"))           BINLOAD_bulk_loading = FALSE;
+        else if (!strcmp(argv[i], "-nosiopatch"))           sio_patch = 0;
+        else if (!strcmp(argv[i], "-pal"))                  tv_type = TV_PAL;
+        else if (!strcmp(argv[i], "-basic"))                basic_type = BASIC_ALTIRRA;
+        else if (!strcmp(argv[i], "-noidle"))               idle_skip = 0;
+        else if (!strcmp(argv[i], "-nocoll"))               collision_disable = 1;
+        else if (!strcmp(argv[i], "-nodirty"))              antic_skip_unchanged = FALSE;
+        else if (!strcmp(argv[i], "-noglyph"))              antic_glyph_cache = FALSE;
+        else if (!strcmp(argv[i], "-noplan"))               antic_dl_plan = FALSE;
+        else if (!strcmp(argv[i], "-noslice"))              antic_slice = FALSE;
+        else if (!strcmp(argv[i], "-dlist"))                show_dlist = 1;
+        else if (!strcmp(argv[i], "-hashall"))              hash_all = 1;
+        else if (!strcmp(argv[i], "-segments"))             show_segments = 1;
+        else if (argv[i][0] == '-')                         usage();
+        else                                                image = argv[i];
+    }
+    if (frames <= 0 || sound_mode < 0 || sound_mode > 3 || (mkimage && !image)) usage();
+    if (mkimage) return testimg_write(mkimage, image);
+#ifndef CPU_PROFILE
+    if (profile)
+    {
+        fprintf(stderr, "a8bench: built without CPU_PROFILE - use 'make profile'\n");
+        return 1;
+    }
+#endif
+
+    host_configure(OS_ALTIRRA_XL, ram_type, tv_type, basic_type);
+    myConfig.skip_frames = skip_frames;
+    myConfig.idle_skip = idle_skip;
+    myConfig.collision_disable = collision_disable;
+    if (sound_mode || pokey_stereo)
+    {
+        // The sound rate and the second Pokey are taken when the machine is set up - as on the DS, start again
+        myConfig.sound_mode = sound_mode;
+        myConfig.pokey_stereo = pokey_stereo;
+        Atari800_Initialise();
+    }
+    if (!sio_patch)
+    {
+        // DISK SPEEDUP off - the OS's own SIO code, and a tape plays in real time through POKEY
+        myConfig.disk_speedup = 0;
+        ESC_UpdatePatches();
+    }
+
+    // The 6502 on its own - these take over the whole machine
+    if (cpu_selftest) return cputest_selftest();
+    if (cpu_test) return cputest_run(cpu_test, load, start, success, error, mcycles > 0 ? mcycles : 2000);
+    if (opbench)
+    {
+        cputest_opbench(mcycles > 0 ? mcycles : 50, only);
+        return 0;
+    }
+    if (sound_test)
+    {
+        soundtest_run(0.5);
+        return 0;
+    }
+    if (disk_test) return disktest_run(image, 0.5);
+    if (gz_test) return gztest_run(image, gz_test, 0.5);
+
+    int file_type = host_load(image);
+    if (file_type == AFILE_ERROR)
+    {
+        fprintf(stderr, "a8bench: unable to load %s\n", image);
+        return 1;
+    }
+
+    // Let the OS boot and the image load before timing anything...
+    for (int i = 0; i < warmup; i++)
+    {
+        key_code = AKEY_NONE;           // No keys - read afresh every frame, as the DS does
+        Atari800_Frame();
+        host_drain_audio(audio_sink, &audio);
+    }
+
+    idle_cycles_skipped = idle_loops_skipped = 0;
+    antic_lines_drawn = antic_lines_skipped = 0;
+    antic_glyph_rebuilds = 0;
+    antic_dl_followed = antic_dl_decoded = 0;
+    pm_span_lines = pm_span_bytes = 0;
+    pokey_batches = pokey_writes_logged = snd_samples_bypassed = 0;
+    pace_underruns = pace_overruns = pace_adjust = 0;
+    frames_drawn = frames_skipped = 0;
+    Atari800_ResetFrameSkip();
+#ifdef CPU_STATS
+    memset(&cpu_stats, 0x00, sizeof(cpu_stats));
+#endif
+#ifdef CPU_PROFILE
+    PROFILE_Reset();
+#endif
+
+    double *frame_us = (double *)malloc(sizeof(double) * frames);
+    double total_start = now_us();
+    clock_t cpu_start = clock();
+    pace_card_t card = {0, 0, total_start};
+    for (int i = 0; i < frames; i++)
+    {
+        if (pace) pace_wait(&card);
+        double t0 = now_us();
+        unsigned int samples_from = audio.count;
+        key_code = AKEY_NONE;
+        Atari800_Frame();
+        frame_us[i] = now_us() - t0;
+        // A DS 'dsscale' times slower takes that much longer over the frame
+        if (pace && dsscale > 1) sleep_us(frame_us[i] * (dsscale - 1));
+        // Every frame's bitmap, not just the last one - slow, so only for checking output
+        if (hash_all) frames_hash = fnv1a(frames_hash, (UBYTE *)bgGetGfxPtr(bg2), 512 * ATARI_HEIGHT);
+        host_drain_audio(audio_sink, &audio);
+        if (pace) pace_made(&card, (audio.count - samples_from) / Num_pokeys);
+        // SKIP FRAMES = AUTO: pass the frame time on in DS timer ticks, as if the DS were 'dsscale' times slower
+        if (skip_frames == SKIP_FRAMES_AUTO) Atari800_FrameTime((int) (frame_us[i] * (dsscale > 0 ? dsscale : 1) * 32728.5 / 1e6 + 0.5));
+    }
+    double total_us = now_us() - total_start;
+    double cpu_us = (double) (clock() - cpu_start) * 1e6 / CLOCKS_PER_SEC;
+
+    unsigned int video_hash = fnv1a(FNV_OFFSET, (UBYTE *)bgGetGfxPtr(bg2), 512 * ATARI_HEIGHT);
+
+    if (dump) dump_screen(dump);
+    if (show_segments) dump_segments();
+    if (show_dlist) dump_dlist();
+#ifdef CPU_PROFILE
+    if (profile && !PROFILE_Dump(profile)) fprintf(stderr, "a8bench: unable to write %s\n", profile);
+#endif
+
+    qsort(frame_us, frames, sizeof(double), cmp_double);
+    double fps = frames / (total_us / 1e6);
+    double native = (tv_type == TV_NTSC ? 60.0 : 50.0);
+
+    printf("image      : %s (type %d, %s, %dK)\n", image ? image : "(none - OS only)", file_type, tv_type == TV_NTSC ? "NTSC" : "PAL", ram_size);
+    printf("frames     : %d (+%d warmup)\n", frames, warmup);
+    printf("time       : %.3f s  %.1f fps  %.2fx realtime\n", total_us / 1e6, fps, fps / native);
+    printf("frame us   : min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+           frame_us[0], percentile(frame_us, frames, 50), percentile(frame_us, frames, 90),
+           percentile(frame_us, frames, 99), frame_us[frames-1]);
+    printf("video hash : %08x\n", video_hash);
+    printf("audio hash : %08x (%u samples)\n", audio.hash, audio.count);
+    if (hash_all) printf("frames hash: %08x (every frame)\n", frames_hash);
+    printf("idle skip  : %s  %u loops  %u cycles (%.1f%% of the CPU time)\n", idle_skip ? "on" : "off", idle_loops_skipped, idle_cycles_skipped,
+           100.0 * idle_cycles_skipped / ((double) frames * LINE_C * (tv_type == TV_NTSC ? TV_NTSC_SCANLINES : TV_PAL_SCANLINES)));
+    printf("frame skip : %s  %u drawn  %u skipped\n", skip_frames == SKIP_FRAMES_AUTO ? "auto" : (skip_frames ? (skip_frames == 1 ? "moderate" : "aggressive") : "off"), frames_drawn, frames_skipped);
+    printf("scanlines  : %s  %u drawn  %u unchanged (%.1f%% skipped)\n", antic_skip_unchanged ? "skip unchanged" : "draw all", antic_lines_drawn, antic_lines_skipped,
+           antic_lines_drawn + antic_lines_skipped ? 100.0 * antic_lines_skipped / (antic_lines_drawn + antic_lines_skipped) : 0.0);
+    printf("glyphs     : %s  %u colour set rebuilds\n", antic_glyph_cache ? "cached" : "uncached", antic_glyph_rebuilds);
+    printf("dlist      : %s  %u instructions followed from the last frame's plan  %u decoded afresh\n", antic_dl_plan ? "planned" : "unplanned",
+           antic_dl_followed, antic_dl_decoded);
+    printf("slices     : %s  %u visible lines started inside GO()  %u from ANTIC_Frame()\n", antic_slice ? "on" : "off",
+           antic_slice_lines, antic_slice_stops);
+    printf("pm spans   : %u lines with players or missiles  %.1f of %d bytes wide on average\n", pm_span_lines,
+           pm_span_lines ? (double) pm_span_bytes / pm_span_lines : 0.0, ATARI_WIDTH / 2);
+    printf("pokey      : %s %s %d Hz  %d lines a batch  %u Pokey_process batches  %u writes replayed  %u samples quiet\n", SOUND_POKEYS > 1 ? "stereo" : "mono", SOUND_BLEP ? "blep" : "classic", SOUND_FREQ,
+           pokey_batch_lines, pokey_batches, pokey_writes_logged, snd_samples_bypassed);
+    if (pace) printf("pacing     : audio clock  %u underruns  %u overruns  adjust %+d/65536  busy %.1f%% of the time\n",
+                     pace_underruns, pace_overruns, pace_adjust, 100.0 * cpu_us / total_us);
+    printf("disk I/O   : %d sector accesses%s\n", host_disk_activity, bAtariCrash ? "  ** CPU CRASH **" : "");
+    if (file_type == AFILE_CAS) printf("tape       : %s  record %d of %d  %lu records by SIO patch  %lu bytes through POKEY\n", sio_patch ? "SIO patch" : "real time",
+           CASSETTE_current_record, CASSETTE_record_count, (unsigned long) CASSETTE_records_read, (unsigned long) CASSETTE_bytes_read);
+#ifdef CPU_STATS
+    printf("6502       : %llu insns  %.2f M insns/s  (block cache %s)\n", cpu_stats.insns, cpu_stats.insns / total_us,
+#ifdef CPU_BLOCK_CACHE
+           "on");
+    printf("blocks     : %u hits  %u linked  %u decodes  %u code writes  %u flushes  %u uncached insns\n",
+           cpu_stats.block_hits + cpu_stats.block_links, cpu_stats.block_links, cpu_stats.block_decodes, cpu_stats.block_smc, cpu_stats.block_flushes, cpu_stats.uncached);
+#else
+           "off");
+#endif
+#endif
+
+    free(frame_us);
+    return 0;
+}
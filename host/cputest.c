@@ -0,0 +1,440 @@
+/*
+ * cputest.c runs 6502 test binaries and per-opcode microbenchmarks through
+ * GO() with the Atari stripped away - 64K of plain RAM, no hardware pages,
+ * no ANTIC, no interrupts. The test binaries are the usual ones that finish
+ * by looping on themselves (JMP * or a branch to itself): the address they
+ * end up stuck at tells pass from fail. The built-in self test needs no
+ * binary at all - it runs the ALU instructions over every accumulator,
+ * operand and carry (and decimal mode for ADC and SBC) and checks each result
+ * and flag against a model of the NMOS 6502. The microbenchmarks time one
+ * instruction class at a time so a change to the dispatch in GO() can be
+ * measured per class rather than per game.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "antic.h"
+#include "cpu.h"
+#include "memory.h"
+#include "cputest.h"
+
+#define SLICE_C         (LINE_C * TV_NTSC_SCANLINES)    // Cycles per GO() call - one NTSC frame
+#define ATARI_MHZ       1.7897725                       // NTSC 6502 clock
+
+#define BENCH_ORG       0x1000      // Where each microbenchmark is built
+#define BENCH_DATA      0x2000      // Absolute operand of the memory benchmarks
+#define BENCH_SUB       0x3000      // An RTS for the JSR benchmark
+#define BENCH_ZP        0x80        // Zero page operand (pointer to BENCH_DATA)
+#define BENCH_REPS      32          // Copies of the instruction(s) per trip round the loop
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// ---------------------------------------------------------------------------
+// Unhook every hardware page and map all 64K straight onto RAM, cleared.
+// ---------------------------------------------------------------------------
+static void flat_memory(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        readmap[i] = NULL;
+        writemap[i] = NULL;
+    }
+    mem_map[0] = fast_page;
+    for (int i = 1; i < 16; i++) mem_map[i] = memory;
+    memset(fast_page, 0x00, sizeof(fast_page));
+    memset(memory, 0x00, sizeof(memory));
+
+    rts_handler = NULL;
+    cim_encountered = FALSE;
+    IRQ = 0;
+    wsync_halt = 0;
+    xpos = 0;
+}
+
+static void flat_start(UWORD pc)
+{
+    CPU_Reset();                    // Also drops anything the block cache decoded
+    regPC = pc;
+}
+
+// Run one slice of SLICE_C cycles
+static void flat_slice(void)
+{
+    GO(SLICE_C);
+    xpos -= SLICE_C;
+    screenline_cpu_clock += SLICE_C;
+}
+
+// A JMP to itself or a branch to itself - how the test binaries stop
+static int is_trap(UWORD pc)
+{
+    UBYTE op = dGetByte(pc);
+    if (op == 0x4c) return dGetWord((UWORD) (pc + 1)) == pc;
+    if ((op & 0x1f) == 0x10) return dGetByte((UWORD) (pc + 1)) == 0xfe;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Load a raw binary at 'load', start it at 'start' and run until it traps.
+// With a success address it passes only if it traps there; with an error
+// byte it passes only if that byte is zero (the decimal-mode tests report
+// that way). Returns 0 on a pass.
+// ---------------------------------------------------------------------------
+int cputest_run(const char *filename, int load, int start, int success, int error, double max_mcycles)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "a8bench: unable to open %s\n", filename);
+        return 1;
+    }
+
+    flat_memory();
+    int size = 0, ch;
+    while ((ch = fgetc(fp)) != EOF && load + size < 0x10000) dPutByte((UWORD) (load + size++), (UBYTE) ch);
+    fclose(fp);
+    flat_start((UWORD) start);
+
+    double cycles = 0, max_cycles = max_mcycles * 1e6;
+    int trapped = 0;
+    UWORD last = (UWORD) ~regPC;
+    double t0 = now_us();
+    while (cycles < max_cycles && !cim_encountered)
+    {
+        flat_slice();
+        cycles += SLICE_C;
+        if (regPC == last && is_trap(regPC)) { trapped = 1; break; }
+        last = regPC;
+    }
+    double host_us = now_us() - t0;
+
+    int pass = trapped;
+    if (success != CPUTEST_NONE && regPC != success) pass = 0;
+    if (error != CPUTEST_NONE && dGetByte((UWORD) error) != 0) pass = 0;
+
+    printf("cpu test   : %s (%d bytes at $%04X, start $%04X)\n", filename, size, load, start);
+    if (trapped)
+        printf("result     : %s - stopped at $%04X  A=%02X X=%02X Y=%02X S=%02X\n", pass ? "PASS" : "FAIL", regPC, regA, regX, regY, regS);
+    else
+        printf("result     : FAIL - %s at $%04X after %.0f M cycles\n", cim_encountered ? "crashed (CIM)" : "still running", regPC, cycles / 1e6);
+    if (error != CPUTEST_NONE)
+        printf("error byte : $%04X = %02X\n", error, dGetByte((UWORD) error));
+    printf("speed      : %.0f M cycles in %.3f s  %.1f MHz emulated (%.1fx a real 6502)\n",
+           cycles / 1e6, host_us / 1e6, cycles / host_us, cycles / host_us / ATARI_MHZ);
+
+    return pass ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// The self test. One small program runs every case: the accumulator, operand
+// and flags come in through zero page, the instruction under test works on
+// the operand at SELF_M, and the accumulator, flags and operand it leaves
+// are stored for checking. The code itself never changes, so it is the same
+// with or without the block cache.
+// ---------------------------------------------------------------------------
+#define SELF_ORG        0x0200
+#define SELF_A          0x00        // Accumulator going in...
+#define SELF_M          0x01        // ...the operand (and its result for ASL, INC and the like)...
+#define SELF_P          0x02        // ...and the flags
+#define SELF_OUT_A      0x10        // Accumulator, flags and operand coming out
+#define SELF_OUT_P      0x11
+#define SELF_OUT_M      0x12
+#define SELF_C          64          // Cycles per GO() call - each case is done well inside that
+
+typedef struct
+{
+    UBYTE a, m, p;
+} self_result_t;
+
+// NMOS decimal mode (as in Bruce Clark's "Decimal Mode" tutorial): A and C come
+// from the BCD sum, N and V from the sum before the high nibble is corrected and
+// Z from the plain binary sum. SBC sets every flag just as it does in binary.
+static self_result_t model_adc(UBYTE a, UBYTE m, UBYTE p)
+{
+    self_result_t r;
+    int c = p & C_FLAG;
+    int bin = a + m + c;
+
+    r.p = p & ~(N_FLAG | V_FLAG | Z_FLAG | C_FLAG);
+    if (p & D_FLAG)
+    {
+        int al = (a & 0x0f) + (m & 0x0f) + c;
+        if (al >= 0x0a) al = ((al + 0x06) & 0x0f) + 0x10;
+        int sum = (a & 0xf0) + (m & 0xf0) + al;
+        int ssum = (signed char) (a & 0xf0) + (signed char) (m & 0xf0) + al;
+        if (sum & 0x80) r.p |= N_FLAG;
+        if (ssum < -128 || ssum > 127) r.p |= V_FLAG;
+        if (sum >= 0xa0) sum += 0x60;
+        if (sum >= 0x100) r.p |= C_FLAG;
+        r.a = sum & 0xff;
+    }
+    else
+    {
+        r.a = bin & 0xff;
+        if (r.a & 0x80) r.p |= N_FLAG;
+        if (~(a ^ m) & (a ^ r.a) & 0x80) r.p |= V_FLAG;
+        if (bin >= 0x100) r.p |= C_FLAG;
+    }
+    if ((bin & 0xff) == 0) r.p |= Z_FLAG;
+    r.m = m;
+    return r;
+}
+
+static self_result_t model_sbc(UBYTE a, UBYTE m, UBYTE p)
+{
+    self_result_t r;
+    int c = p & C_FLAG;
+    int bin = a - m - !c;
+
+    r.p = p & ~(N_FLAG | V_FLAG | Z_FLAG | C_FLAG);
+    r.a = bin & 0xff;
+    if (r.a & 0x80) r.p |= N_FLAG;
+    if ((a ^ m) & (a ^ r.a) & 0x80) r.p |= V_FLAG;
+    if (r.a == 0) r.p |= Z_FLAG;
+    if (bin >= 0) r.p |= C_FLAG;
+    if (p & D_FLAG)
+    {
+        int al = (a & 0x0f) - (m & 0x0f) + c - 1;
+        if (al < 0) al = ((al - 0x06) & 0x0f) - 0x10;
+        int diff = (a & 0xf0) - (m & 0xf0) + al;
+        if (diff < 0) diff -= 0x60;
+        r.a = diff & 0xff;
+    }
+    r.m = m;
+    return r;
+}
+
+// N and Z from a value, the other flags left as they were
+static UBYTE nz(UBYTE p, UBYTE v)
+{
+    p &= ~(N_FLAG | Z_FLAG);
+    if (v & 0x80) p |= N_FLAG;
+    if (v == 0) p |= Z_FLAG;
+    return p;
+}
+
+static self_result_t model_and(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {a & m, m, 0}; r.p = nz(p, r.a); return r; }
+static self_result_t model_ora(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {a | m, m, 0}; r.p = nz(p, r.a); return r; }
+static self_result_t model_eor(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {a ^ m, m, 0}; r.p = nz(p, r.a); return r; }
+static self_result_t model_lda(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {m, m, 0}; r.p = nz(p, r.a); return r; }
+static self_result_t model_inc(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {a, m + 1, 0}; r.p = nz(p, r.m); return r; }
+static self_result_t model_dec(UBYTE a, UBYTE m, UBYTE p) { self_result_t r = {a, m - 1, 0}; r.p = nz(p, r.m); return r; }
+
+static self_result_t model_cmp(UBYTE a, UBYTE m, UBYTE p)
+{
+    self_result_t r = {a, m, 0};
+    r.p = nz(p, a - m) & ~C_FLAG;
+    if (a >= m) r.p |= C_FLAG;
+    return r;
+}
+
+static self_result_t model_bit(UBYTE a, UBYTE m, UBYTE p)
+{
+    self_result_t r = {a, m, (p & ~(N_FLAG | V_FLAG | Z_FLAG)) | (m & (N_FLAG | V_FLAG))};
+    if ((a & m) == 0) r.p |= Z_FLAG;
+    return r;
+}
+
+// The shifts and rotates - 'in' is the bit shifted in, the bit shifted out goes to C
+static self_result_t shift(UBYTE a, UBYTE m, UBYTE p, int left, int in)
+{
+    self_result_t r = {a, 0, 0};
+    int out = left ? (m >> 7) : (m & 1);
+    r.m = left ? ((m << 1) | in) : ((m >> 1) | (in << 7));
+    r.p = nz(p, r.m) & ~C_FLAG;
+    if (out) r.p |= C_FLAG;
+    return r;
+}
+
+static self_result_t model_asl(UBYTE a, UBYTE m, UBYTE p) { return shift(a, m, p, 1, 0); }
+static self_result_t model_lsr(UBYTE a, UBYTE m, UBYTE p) { return shift(a, m, p, 0, 0); }
+static self_result_t model_rol(UBYTE a, UBYTE m, UBYTE p) { return shift(a, m, p, 1, p & C_FLAG); }
+static self_result_t model_ror(UBYTE a, UBYTE m, UBYTE p) { return shift(a, m, p, 0, p & C_FLAG); }
+
+typedef struct
+{
+    const char *name;
+    UBYTE opcode;                   // Zero page form - the operand is SELF_M
+    UBYTE decimal;                  // Run every case with D set as well
+    self_result_t (*model)(UBYTE a, UBYTE m, UBYTE p);
+} selftest_t;
+
+static const selftest_t selftest[] =
+{
+    {"ADC",     0x65, 1, model_adc},
+    {"SBC",     0xe5, 1, model_sbc},
+    {"AND",     0x25, 0, model_and},
+    {"ORA",     0x05, 0, model_ora},
+    {"EOR",     0x45, 0, model_eor},
+    {"CMP",     0xc5, 0, model_cmp},
+    {"BIT",     0x24, 0, model_bit},
+    {"LDA",     0xa5, 0, model_lda},
+    {"ASL",     0x06, 0, model_asl},
+    {"LSR",     0x46, 0, model_lsr},
+    {"ROL",     0x26, 0, model_rol},
+    {"ROR",     0x66, 0, model_ror},
+    {"INC",     0xe6, 0, model_inc},
+    {"DEC",     0xc6, 0, model_dec},
+};
+
+int cputest_selftest(void)
+{
+    const UBYTE flag_mask = N_FLAG | V_FLAG | D_FLAG | Z_FLAG | C_FLAG;
+    int failed = 0;
+
+    for (int t = 0; t < (int) (sizeof(selftest) / sizeof(selftest[0])); t++)
+    {
+        const selftest_t *st = &selftest[t];
+        const UBYTE code[] =
+        {
+            0xa5, SELF_P, 0x48,                 // LDA p / PHA
+            0xa5, SELF_A, 0x28,                 // LDA a / PLP
+            st->opcode, SELF_M,                 // The instruction under test
+            0x08, 0x85, SELF_OUT_A,             // PHP / STA out_a
+            0x68, 0x85, SELF_OUT_P,             // PLA / STA out_p
+            0xa5, SELF_M, 0x85, SELF_OUT_M,     // LDA m / STA out_m
+            0x4c, (SELF_ORG + 18) & 0xff, (SELF_ORG + 18) >> 8,    // JMP *
+        };
+        unsigned long cases = 0, bad = 0;
+
+        flat_memory();
+        for (int i = 0; i < (int) sizeof(code); i++) dPutByte((UWORD) (SELF_ORG + i), code[i]);
+        flat_start(SELF_ORG);
+
+        // C and V going in (and D for ADC and SBC) over every accumulator and operand
+        for (int flags = 0; flags < (st->decimal ? 8 : 4); flags++)
+        {
+            UBYTE p = 0x30 | ((flags & 1) ? C_FLAG : 0) | ((flags & 2) ? V_FLAG : 0) | ((flags & 4) ? D_FLAG : 0);
+            for (int a = 0; a < 256; a++)
+            {
+                for (int m = 0; m < 256; m++)
+                {
+                    dPutByte(SELF_A, a);
+                    dPutByte(SELF_M, m);
+                    dPutByte(SELF_P, p);
+                    regPC = SELF_ORG;
+                    regS = 0xff;
+                    GO(SELF_C);
+                    xpos -= SELF_C;
+
+                    self_result_t want = st->model(a, m, p);
+                    UBYTE got_a = dGetByte(SELF_OUT_A), got_p = dGetByte(SELF_OUT_P), got_m = dGetByte(SELF_OUT_M);
+                    cases++;
+                    if (got_a != want.a || (got_p & flag_mask) != (want.p & flag_mask) || got_m != want.m)
+                    {
+                        if (bad++ < 4)
+                            printf("  %s%s A=%02X M=%02X P=%02X: got A=%02X P=%02X M=%02X, want A=%02X P=%02X M=%02X\n", st->name, (p & D_FLAG) ? " (BCD)" : "",
+                                   a, m, p, got_a, got_p & flag_mask, got_m, want.a, want.p & flag_mask, want.m);
+                    }
+                }
+            }
+        }
+        printf("self test  : %-4s %7lu cases  %s\n", st->name, cases, bad ? "FAIL" : "ok");
+        if (bad) failed = 1;
+    }
+    printf("result     : %s\n", failed ? "FAIL" : "PASS");
+    return failed;
+}
+
+// ---------------------------------------------------------------------------
+// Microbenchmarks: each one is a setup sequence and then a loop of BENCH_REPS
+// copies of the body followed by a JMP back. Add a line to the table to time
+// another instruction class.
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    const char *name;
+    UBYTE setup[12];
+    UBYTE setup_len;
+    UBYTE body[4];
+    UBYTE body_len;
+    UBYTE insns;                    // Instructions in the body...
+    UBYTE cycles;                   // ...and the cycles they take
+} opbench_t;
+
+#define PTR_SETUP   0xa9, BENCH_DATA & 0xff, 0x85, BENCH_ZP, 0xa9, BENCH_DATA >> 8, 0x85, BENCH_ZP+1, 0xa0, 0x00, 0xa2, 0x00
+
+static const opbench_t opbench[] =
+{
+    {"NOP",             {0},                    0, {0xea},                                  1, 1,  2},
+    {"LDA #imm",        {0},                    0, {0xa9, 0x42},                            2, 1,  2},
+    {"LDA zp",          {0},                    0, {0xa5, BENCH_ZP},                        2, 1,  3},
+    {"LDA abs",         {0},                    0, {0xad, BENCH_DATA & 0xff, BENCH_DATA >> 8}, 3, 1,  4},
+    {"LDA abs,X",       {PTR_SETUP},           12, {0xbd, BENCH_DATA & 0xff, BENCH_DATA >> 8}, 3, 1,  4},
+    {"LDA (zp),Y",      {PTR_SETUP},           12, {0xb1, BENCH_ZP},                        2, 1,  5},
+    {"STA zp",          {0},                    0, {0x85, BENCH_ZP + 2},                    2, 1,  3},
+    {"STA abs",         {0},                    0, {0x8d, BENCH_DATA & 0xff, BENCH_DATA >> 8}, 3, 1,  4},
+    {"STA (zp),Y",      {PTR_SETUP},           12, {0x91, BENCH_ZP},                        2, 1,  6},
+    {"ADC #imm",        {0xd8},                 1, {0x69, 0x01},                            2, 1,  2},
+    {"ADC #imm (BCD)",  {0xf8},                 1, {0x69, 0x01},                            2, 1,  2},
+    {"SBC #imm (BCD)",  {0xf8},                 1, {0xe9, 0x01},                            2, 1,  2},
+    {"CMP #imm",        {0},                    0, {0xc9, 0x42},                            2, 1,  2},
+    {"ASL A",           {0},                    0, {0x0a},                                  1, 1,  2},
+    {"INC zp",          {0},                    0, {0xe6, BENCH_ZP + 2},                    2, 1,  5},
+    {"INC abs",         {0},                    0, {0xee, BENCH_DATA & 0xff, BENCH_DATA >> 8}, 3, 1,  6},
+    {"INX/DEY",         {0},                    0, {0xe8, 0x88},                            2, 2,  4},
+    {"BNE taken",       {0xa9, 0x01},           2, {0xd0, 0x00},                            2, 1,  3},
+    {"BEQ not taken",   {0xa9, 0x01},           2, {0xf0, 0x00},                            2, 1,  2},
+    {"PHA/PLA",         {0},                    0, {0x48, 0x68},                            2, 2,  7},
+    {"JSR/RTS",         {0},                    0, {0x20, BENCH_SUB & 0xff, BENCH_SUB >> 8}, 3, 2, 12},
+};
+
+void cputest_opbench(double mcycles, const char *only)
+{
+    printf("%-16s %9s %9s %9s\n", "opbench", "MHz", "M insn/s", "ns/insn");
+
+    for (int b = 0; b < (int) (sizeof(opbench) / sizeof(opbench[0])); b++)
+    {
+        const opbench_t *ob = &opbench[b];
+        if (only && !strstr(ob->name, only)) continue;
+
+        flat_memory();
+        UWORD pc = BENCH_ORG;
+        for (int i = 0; i < ob->setup_len; i++) dPutByte(pc++, ob->setup[i]);
+        UWORD loop = pc;
+        for (int r = 0; r < BENCH_REPS; r++)
+            for (int i = 0; i < ob->body_len; i++) dPutByte(pc++, ob->body[i]);
+        dPutByte(pc++, 0x4c);
+        dPutByte(pc++, loop & 0xff);
+        dPutByte(pc++, loop >> 8);
+        dPutByte(BENCH_SUB, 0x60);
+        flat_start(BENCH_ORG);
+
+        double cycles = 0, max_cycles = mcycles * 1e6;
+        double t0 = now_us();
+        while (cycles < max_cycles)
+        {
+            flat_slice();
+            cycles += SLICE_C;
+        }
+        double host_us = now_us() - t0;
+
+        // The few setup instructions are lost in the noise - count whole trips round the loop
+        int trip_cycles = BENCH_REPS * ob->cycles + 3;
+        double insns = cycles / trip_cycles * (BENCH_REPS * ob->insns + 1);
+        printf("%-16s %9.1f %9.1f %9.2f\n", ob->name, cycles / host_us, insns / host_us, host_us * 1e3 / insns);
+    }
+}
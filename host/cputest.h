@@ -0,0 +1,29 @@
+/*
+ * cputest.h contains the flat-memory 6502 test runner and the per-opcode
+ * microbenchmarks that a8bench runs with -cpu and -opbench.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _CPUTEST_H_
+#define _CPUTEST_H_
+
+#define CPUTEST_NONE    -1      // No success address / error byte given
+
+extern int  cputest_selftest(void);
+extern int  cputest_run(const char *filename, int load, int start, int success, int error, double max_mcycles);
+extern void cputest_opbench(double mcycles, const char *only);
+
+#endif // _CPUTEST_H_
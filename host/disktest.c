@@ -0,0 +1,309 @@
+/*
+ * disktest.c drives the SIO disk layer (sio.c) on its own - no 6502, no
+ * OS - to measure sectors per second with a mounted image read from its
+ * file on every access, read ahead a run of sectors at a time, read ahead
+ * with the SIO patch bursting sectors straight out of the read-ahead
+ * buffer, and held in RAM (SIO_cache_enabled). For each it reads every
+ * sector in order and in a random order through SIO_Handler(), as the OS
+ * does with the SIO patch, then writes every sector over a number of passes
+ * and dismounts, which is when the RAM copy is written back. The sectors
+ * read must hash the same every way and the image files left behind must
+ * be byte for byte the same, so the read-ahead and the cache are checked as
+ * well as timed. The image given is copied first and never written to.
+ *
+ * A host's file reads come out of its page cache, so the gap here is
+ * smaller than on the DS where each one is an SD card access through libfat.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "memory.h"
+#include "sio.h"
+#include "disktest.h"
+
+#define WRITE_PASSES    16          // Every sector written this many times before the dismount
+#define SECTOR_ADDR     0x4000      // Where the SIO patch puts the sectors read
+#define FNV_OFFSET      0x811C9DC5u
+#define FNV_PRIME       0x01000193u
+
+typedef struct
+{
+    const char *name;
+    int cached;
+    int readahead;
+    int burst;
+    double seq_sps;             // Sectors per second read in order
+    double rnd_sps;             // In a random order
+    double wr_sps;              // Written, write-back on dismount included
+    unsigned int read_hash;
+    unsigned int flush_runs;
+    unsigned int flush_errors;
+    ULONG file_reads;           // For one pass in order and one in a random order
+    UBYTE *result;              // The image file once it was dismounted
+    long result_len;
+} disk_mode_t;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static UBYTE *read_file(const char *filename, long *len)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) return NULL;
+    fseek(fp, 0, SEEK_END);
+    *len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    UBYTE *data = (UBYTE *) malloc(*len + 1);
+    if (fread(data, 1, *len, fp) != (size_t) *len) { free(data); data = NULL; }
+    fclose(fp);
+    return data;
+}
+
+static int write_file(const char *filename, const UBYTE *data, long len)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) return 0;
+    int ok = fwrite(data, 1, len, fp) == (size_t) len;
+    fclose(fp);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Sectors 1..N that drive 1 reads back - the rest report an error.
+// ---------------------------------------------------------------------------
+static int count_sectors(void)
+{
+    UBYTE buf[256];
+    int n = 0;
+    while (n < 65535 && SIO_ReadSector(0, n + 1, buf) == 'C') n++;
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Read a sector into Atari memory the way the OS's SIOV does with the SIO
+// patch in place - fill in the device control block and call the handler.
+// ---------------------------------------------------------------------------
+static void sio_read(int sector)
+{
+    int size;
+    SIO_SizeOfSector(0, sector, &size, NULL);
+    dPutByte(0x300, 0x31);              // DDEVIC - disk
+    dPutByte(0x301, 1);                 // DUNIT - D1:
+    dPutByte(0x302, 0x52);              // DCOMND - read
+    dPutWord(0x304, SECTOR_ADDR);       // DBUFLO/HI
+    dPutWord(0x308, size);              // DBYTLO/HI
+    dPutWord(0x30a, sector);            // DAUX1/2
+    SIO_Handler();
+}
+
+// ---------------------------------------------------------------------------
+// Read every sector, in order or not - hashing what comes back if asked.
+// ---------------------------------------------------------------------------
+static void read_pass(int sectors, int random, unsigned int *hash)
+{
+    UBYTE buf[256];
+    unsigned int seed = 12345;
+    for (int i = 1; i <= sectors; i++)
+    {
+        int sector = i;
+        if (random)
+        {
+            seed = seed * 1103515245u + 12345u;
+            sector = 1 + (seed >> 8) % sectors;
+        }
+        if (hash) memset(memory + SECTOR_ADDR, 0, 256);
+        sio_read(sector);
+        if (hash == NULL) continue;
+        CopyFromMem(SECTOR_ADDR, buf, 256);
+        for (int b = 0; b < 256; b++) { *hash ^= buf[b]; *hash *= FNV_PRIME; }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Reads are repeated for at least the given time after a first, hashed pass
+// - the file reads per sector come from that first pass.
+// ---------------------------------------------------------------------------
+static double read_rate(int sectors, int random, double seconds, unsigned int *hash, ULONG *file_reads)
+{
+    ULONG misses = SIO_readahead_misses[0];
+    read_pass(sectors, random, hash);
+    *file_reads += SIO_readahead_misses[0] - misses;
+
+    double done = 0, t0 = now_us(), us;
+    do
+    {
+        read_pass(sectors, random, NULL);
+        done += sectors;
+        us = now_us() - t0;
+    } while (us < seconds * 1e6);
+    return done / us * 1e6;
+}
+
+static int run_mode(disk_mode_t *m, const char *copy, const UBYTE *orig, long orig_len, double seconds, int *sectors)
+{
+    UBYTE buf[256];
+
+    if (!write_file(copy, orig, orig_len)) return 0;
+    SIO_cache_enabled = m->cached;
+    SIO_readahead_enabled = m->readahead;
+    SIO_burst_enabled = m->burst;
+    SIO_flush_runs = 0;
+    SIO_flush_errors = 0;
+    if (!SIO_Mount(1, copy, FALSE)) return 0;
+    *sectors = count_sectors();
+    if (*sectors == 0) return 0;
+
+    m->read_hash = FNV_OFFSET;
+    m->file_reads = 0;
+    m->seq_sps = read_rate(*sectors, 0, seconds, &m->read_hash, &m->file_reads);
+    m->rnd_sps = read_rate(*sectors, 1, seconds, &m->read_hash, &m->file_reads);
+
+    double t0 = now_us();
+    for (int pass = 0; pass < WRITE_PASSES; pass++)
+    {
+        for (int s = 1; s <= *sectors; s++)
+        {
+            for (int b = 0; b < (int) sizeof(buf); b++) buf[b] = (UBYTE) (s * 7 + pass + b);
+            SIO_WriteSector(0, s, buf);
+        }
+    }
+    SIO_Dismount(1);
+    m->wr_sps = (double) *sectors * WRITE_PASSES / (now_us() - t0) * 1e6;
+    m->flush_runs = SIO_flush_runs;
+    m->flush_errors = SIO_flush_errors;
+
+    m->result = read_file(copy, &m->result_len);
+    return m->result != NULL;
+}
+
+// ---------------------------------------------------------------------------
+// A sector written must reach the file by itself once the drive has been left
+// alone for a while (SIO_Frame()), without a dismount - out of the RAM copy
+// if the image fits in the cache, out of the stdio buffer if it does not.
+// A gzip compressed image mounts locked, so there is nothing to check.
+// ---------------------------------------------------------------------------
+static int idle_flush_check(const char *copy, const UBYTE *orig, long orig_len)
+{
+    UBYTE buf[128];
+    ULONG offset;
+    long len;
+    int size, ok;
+
+    if (!write_file(copy, orig, orig_len)) return 0;
+    SIO_cache_enabled = TRUE;
+    SIO_Mount(1, copy, FALSE);
+    if (SIO_drive_status[0] == SIO_READ_ONLY)
+    {
+        SIO_Dismount(1);
+        return 1;
+    }
+    memset(buf, 0xa5, sizeof(buf));
+    SIO_WriteSector(0, 1, buf);
+    SIO_SizeOfSector(0, 1, &size, &offset);
+    for (int i = 0; i < 10 * 60; i++) SIO_Frame();
+
+    UBYTE *data = read_file(copy, &len);
+    ok = data != NULL && (long) offset + size <= len && !memcmp(data + offset, buf, size);
+    if (!ok) printf("FAIL: a sector written was not flushed once the drive went idle\n");
+    free(data);
+    SIO_Dismount(1);
+    return ok;
+}
+
+int disktest_run(const char *image, double seconds)
+{
+    disk_mode_t modes[] =
+    {
+        {"file",  FALSE, FALSE, FALSE},
+        {"ahead", FALSE, TRUE,  FALSE},
+        {"burst", FALSE, TRUE,  TRUE},
+        {"ram",   TRUE,  TRUE,  TRUE},
+    };
+    const int n_modes = (int) (sizeof(modes) / sizeof(modes[0]));
+    int saved_cache = SIO_cache_enabled, saved_readahead = SIO_readahead_enabled, saved_burst = SIO_burst_enabled;
+    int sectors = 0, ok = 1;
+    long orig_len = 0;
+    char copy[] = "/tmp/a8disktestXXXXXX";
+
+    UBYTE *orig = image ? read_file(image, &orig_len) : NULL;
+    int fd = mkstemp(copy);
+    if (orig == NULL || fd < 0)
+    {
+        fprintf(stderr, "a8bench: unable to read %s\n", image ? image : "(no image)");
+        return 1;
+    }
+    close(fd);
+
+    printf("%-6s %14s %14s %14s %12s %11s\n", "disk", "seq sectors/s", "rnd sectors/s", "wr sectors/s", "flush runs", "file reads");
+    for (int i = 0; i < n_modes; i++)
+    {
+        disk_mode_t *m = &modes[i];
+        if (!run_mode(m, copy, orig, orig_len, seconds, &sectors))
+        {
+            fprintf(stderr, "a8bench: %s is not a disk image SIO can mount\n", image);
+            unlink(copy);
+            return 1;
+        }
+        printf("%-6s %14.0f %14.0f %14.0f %12u %11u\n", m->name, m->seq_sps, m->rnd_sps, m->wr_sps, m->flush_runs, (unsigned) m->file_reads);
+    }
+    ok = idle_flush_check(copy, orig, orig_len);
+    unlink(copy);
+    SIO_cache_enabled = saved_cache;
+    SIO_readahead_enabled = saved_readahead;
+    SIO_burst_enabled = saved_burst;
+
+    for (int i = 1; i < n_modes; i++)
+        printf("%-6s %13.1fx %13.1fx %13.1fx\n", modes[i].name, modes[i].seq_sps / modes[0].seq_sps, modes[i].rnd_sps / modes[0].rnd_sps, modes[i].wr_sps / modes[0].wr_sps);
+    printf("%d sectors, %ld bytes - file reads are for one pass in order and one in a random order\n", sectors, orig_len);
+
+    for (int i = 0; i < n_modes; i++)
+    {
+        if (modes[i].flush_errors)
+        {
+            printf("FAIL: %u write-backs to the file failed with %s\n", modes[i].flush_errors, modes[i].name);
+            ok = 0;
+        }
+    }
+    for (int i = 1; i < n_modes; i++)
+    {
+        if (modes[0].read_hash != modes[i].read_hash)
+        {
+            printf("FAIL: sectors read differ with %s (%08x, not %08x)\n", modes[i].name, modes[i].read_hash, modes[0].read_hash);
+            ok = 0;
+        }
+        if (modes[0].result_len != modes[i].result_len || memcmp(modes[0].result, modes[i].result, modes[0].result_len))
+        {
+            printf("FAIL: image written back differs with %s\n", modes[i].name);
+            ok = 0;
+        }
+    }
+    if (ok) printf("ok: same sectors read and same image written back every way\n");
+
+    free(orig);
+    for (int i = 0; i < n_modes; i++) free(modes[i].result);
+    return ok ? 0 : 1;
+}
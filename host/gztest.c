@@ -0,0 +1,175 @@
+/*
+ * gztest.c checks the gzip image layer (gzfile.c) against the image it was
+ * made from - the Makefile's gztest target compresses each image with gzip
+ * and hands a8bench -gztest the pair. Through GZ_fopen() the compressed one
+ * must read back byte for byte the same straight through, at random offsets
+ * after seeks back and forth (which is what builds the checkpoint index), and
+ * report the same length at SEEK_END; asking for write access must be turned
+ * down; and the same file with a byte damaged must not read back whole. It
+ * times the straight read in MB/s and the random reads against the same
+ * reads of the plain file.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "gzfile.h"
+#include "gztest.h"
+
+#define RANDOM_READS    2000        // Random reads checked, and timed
+#define RANDOM_LEN      256         // Bytes each - a double density sector
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static UBYTE *read_all(FILE *fp, long *len)
+{
+    long cap = 1 << 16, n = 0;
+    UBYTE *data = (UBYTE *) malloc(cap);
+    size_t got;
+    while ((got = fread(data + n, 1, cap - n, fp)) > 0)
+    {
+        n += got;
+        if (n == cap) data = (UBYTE *) realloc(data, cap *= 2);
+    }
+    *len = n;
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+// Random reads of a file - checked against the image if it is given. Returns
+// reads per second.
+// ---------------------------------------------------------------------------
+static double random_reads(FILE *fp, const UBYTE *image, long len, int *bad)
+{
+    UBYTE buf[RANDOM_LEN];
+    unsigned int seed = 4321;
+    double t0 = now_us();
+
+    for (int i = 0; i < RANDOM_READS; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        long offset = (long) ((seed >> 4) % (unsigned int) len);
+        size_t want = (len - offset < RANDOM_LEN) ? (size_t) (len - offset) : RANDOM_LEN;
+        fseek(fp, offset, SEEK_SET);
+        if (fread(buf, 1, want, fp) != want || (image && memcmp(buf, image + offset, want)))
+            (*bad)++;
+    }
+    return RANDOM_READS / (now_us() - t0) * 1e6;
+}
+
+int gztest_run(const char *plain, const char *packed, double seconds)
+{
+    FILE *fp;
+    long len = 0, gz_len = 0, packed_len = 0;
+    int fails = 0, bad = 0;
+
+    if (plain == NULL || packed == NULL || (fp = fopen(plain, "rb")) == NULL)
+    {
+        fprintf(stderr, "a8bench: -gztest wants an image and its gzip compressed copy\n");
+        return 1;
+    }
+    UBYTE *image = read_all(fp, &len);
+    fclose(fp);
+    if ((fp = fopen(packed, "rb")) == NULL) { fprintf(stderr, "a8bench: unable to read %s\n", packed); return 1; }
+    UBYTE *packed_data = read_all(fp, &packed_len);
+    fclose(fp);
+
+    // Straight through, as a cartridge or XEX is read
+    double t0 = now_us(), us;
+    int passes = 0;
+    ULONG inflated = GZ_bytes_inflated;
+    do
+    {
+        fp = GZ_fopen(packed, "rb");
+        if (fp == NULL) { printf("FAIL: %s does not open\n", packed); return 1; }
+        UBYTE *data = read_all(fp, &gz_len);
+        fclose(fp);
+        if (passes == 0 && (gz_len != len || memcmp(data, image, len)))
+        {
+            printf("FAIL: %s does not inflate to %s (%ld bytes, not %ld)\n", packed, plain, gz_len, len);
+            fails++;
+        }
+        free(data);
+        passes++;
+        us = now_us() - t0;
+    } while (us < seconds * 1e6);
+    double mb_sec = (double) (GZ_bytes_inflated - inflated) / us;
+
+    // Seeks, as the SIO layer makes them
+    fp = GZ_fopen(packed, "rb");
+    fseek(fp, 0, SEEK_END);
+    if (ftell(fp) != len) { printf("FAIL: SEEK_END of %s is %ld, not %ld\n", packed, ftell(fp), len); fails++; }
+    ULONG restarts = GZ_restarts;
+    inflated = GZ_bytes_inflated;
+    double gz_rate = random_reads(fp, image, len, &bad);
+    double per_read = (double) (GZ_bytes_inflated - inflated) / RANDOM_READS;
+    int points = (int) GZ_checkpoints;
+    restarts = GZ_restarts - restarts;
+    fclose(fp);
+    if (bad) { printf("FAIL: %d of %d random reads of %s differ\n", bad, RANDOM_READS, packed); fails++; }
+    if (GZ_checkpoints != 0) { printf("FAIL: %d checkpoints still held after close\n", (int) GZ_checkpoints); fails++; }
+
+    fp = fopen(plain, "rb");
+    double plain_rate = random_reads(fp, NULL, len, &bad);
+    fclose(fp);
+
+    // Locked, and damage noticed
+    fp = GZ_fopen(packed, "rb+");
+    if (fp != NULL) { printf("FAIL: %s opened for writing\n", packed); fclose(fp); fails++; }
+
+    char damaged[] = "/tmp/a8gztestXXXXXX";
+    int fd = mkstemp(damaged);
+    if (fd >= 0)
+    {
+        packed_data[packed_len / 2] ^= 0x55;
+        if (write(fd, packed_data, packed_len) == packed_len)
+        {
+            close(fd);
+            fp = GZ_fopen(damaged, "rb");
+            UBYTE *data = fp ? read_all(fp, &gz_len) : NULL;
+            if (fp && gz_len == len && !memcmp(data, image, len))
+            {
+                printf("FAIL: a damaged %s still reads back whole\n", packed);
+                fails++;
+            }
+            if (fp) fclose(fp);
+            free(data);
+        }
+        else close(fd);
+        unlink(damaged);
+    }
+
+    printf("gzip   : %s %ld bytes, %s %ld bytes (%.0f%%)\n", plain, len, packed, packed_len, 100.0 * packed_len / len);
+    printf("inflate: %.1f MB/s straight through\n", mb_sec);
+    printf("seek   : %.0f random %d byte reads/s (plain file %.0f/s), %.0f bytes inflated a read, %lu restarts, %d checkpoints\n",
+           gz_rate, RANDOM_LEN, plain_rate, per_read, (unsigned long) restarts, points);
+    if (fails == 0) printf("ok: %s reads back the same as %s\n", packed, plain);
+
+    free(image);
+    free(packed_data);
+    return fails ? 1 : 0;
+}
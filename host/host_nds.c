@@ -0,0 +1,152 @@
+/*
+ * HOST_NDS.C contains the host-side stand-ins for the DS front end so that
+ * the emulation core under arm9/source/emu can be linked and run headless on
+ * a desktop machine. This mirrors the small amount of glue that a8ds.c and
+ * config.c normally provide: the global configuration, the VRAM banks that
+ * the core borrows, the two bitmap backgrounds and the OS/RAM setup.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "cartridge.h"
+#include "pia.h"
+#include "pokey.h"
+#include "altirra_os.h"
+#include "altirra_basic.h"
+
+// ---------------------------------------------------------------------------
+// VRAM banks and the bitmap backgrounds (bg2 and bg3 are the ones we draw to)
+// ---------------------------------------------------------------------------
+u16 host_vram_h[0x8000 / 2];
+u16 host_vram_i[0x4000 / 2];
+u8  host_bg[4][HOST_BG_BYTES] __attribute__((aligned (4)));
+
+int bg0 = 0, bg1 = 1, bg2 = 2, bg3 = 3;
+
+u16 *bgGetGfxPtr(int id)
+{
+    return (u16 *)host_bg[id & 3];
+}
+
+// ---------------------------------------------------------------------------
+// Globals normally owned by a8ds.c and config.c
+// ---------------------------------------------------------------------------
+struct GameSettings_t myConfig;
+UBYTE machine_type     = MACHINE_XLXE;
+UBYTE disable_basic    = TRUE;
+UWORD ram_size         = RAM_128K;
+UBYTE ROM_basic[0x2000];
+
+u16  gTotalAtariFrames = 0;
+bool bAtariCrash       = false;
+int  debug[16]         = {0};
+
+int host_disk_activity = 0;
+
+void dsShowDiskActivity(int drive)
+{
+    host_disk_activity++;
+}
+
+// ---------------------------------------------------------------------------
+// Same defaults SetMyConfigDefaults() uses, then map the RAM choice and copy
+// the built-in Altirra OS into place just as install_os() would.
+// ---------------------------------------------------------------------------
+void host_configure(int os_type, int ram_type, int tv_type, int basic_type)
+{
+    memset(&myConfig, 0x00, sizeof(myConfig));
+    myConfig.xOffset      = 32;
+    myConfig.yOffset      = 24;
+    myConfig.xScale       = 256;
+    myConfig.yScale       = 256;
+    myConfig.blending     = 1;
+    myConfig.disk_speedup = 1;
+    myConfig.idle_skip    = 1;
+    myConfig.emulatorText = true;
+    myConfig.cart_type    = CART_NONE;
+    myConfig.os_type      = os_type;
+    myConfig.ram_type     = ram_type;
+    myConfig.tv_type      = tv_type;
+    myConfig.basic_type   = basic_type;
+
+    switch (ram_type)
+    {
+        case RAM_IDX_48K:   ram_size = RAM_48K;         break;
+        case RAM_IDX_64K:   ram_size = RAM_64K;         break;
+        case RAM_IDX_128K:  ram_size = RAM_128K;        break;
+        case RAM_IDX_320K:  ram_size = RAM_320_RAMBO;   break;
+        case RAM_IDX_576K:  ram_size = RAM_576_COMPY;   break;
+        default:            ram_size = RAM_1088K;       break;
+    }
+
+    // Only the built-in Altirra OS and BASIC are available on the host
+    if (ram_size == RAM_48K)
+    {
+        myConfig.os_type = OS_ALTIRRA_800;
+        memcpy(atari_os, ROM_altirraos_800, 0x2800);
+        machine_type = MACHINE_OSB;
+    }
+    else
+    {
+        myConfig.os_type = OS_ALTIRRA_XL;
+        memcpy(atari_os, ROM_altirraos_xl, 0x4000);
+        machine_type = MACHINE_XLXE;
+    }
+    memcpy(ROM_basic, ROM_altirra_basic, 0x2000);
+
+    memset(host_bg, 0x00, sizeof(host_bg));
+    gTotalAtariFrames = 0;
+    bAtariCrash = false;
+
+    Atari800_Initialise();
+}
+
+// ---------------------------------------------------------------------------
+// Boot a .ATR/.ATX/.XEX/.CAR/.ROM or, with no file, just cold start the OS.
+// Returns the detected file type (AFILE_ERROR on failure).
+// ---------------------------------------------------------------------------
+int host_load(const char *filename)
+{
+    if (filename == NULL)
+    {
+        CART_Insert(myConfig.basic_type, AFILE_ATR, "");
+        Atari800_Coldstart();
+        return AFILE_ATR;
+    }
+    return Atari800_OpenFile(filename, TRUE, DISK_1, TRUE, myConfig.basic_type);
+}
+
+// ---------------------------------------------------------------------------
+// The DS drains pokey_buffer from a timer interrupt (VsoundHandler). On the
+// host we hand everything produced since the last call to the sink instead.
+// The host build uses a ring larger than any frame so nothing is lost.
+// ---------------------------------------------------------------------------
+void host_drain_audio(void (*sink)(const UBYTE *samples, int count, void *ctx), void *ctx)
+{
+    static unsigned short drainIdx = 0;
+
+    while (drainIdx != pokeyBufIdx)
+    {
+        int count = (pokeyBufIdx > drainIdx) ? (pokeyBufIdx - drainIdx) : (SNDLENGTH - drainIdx);
+        sink((const UBYTE *)&pokey_buffer[drainIdx], count, ctx);
+        drainIdx = (drainIdx + count) & (SNDLENGTH-1);
+    }
+}
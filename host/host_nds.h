@@ -0,0 +1,37 @@
+/*
+ * host_nds.h contains the host-side replacements for the bits of the DS
+ * front end (a8ds.c / config.c) that the emulation core links against.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _HOST_NDS_H_
+#define _HOST_NDS_H_
+
+#include <nds.h>
+#include "atari.h"
+
+extern int bg0, bg1, bg2, bg3;
+extern u16 gTotalAtariFrames;
+extern bool bAtariCrash;
+
+extern u8  host_bg[4][HOST_BG_BYTES];
+extern int host_disk_activity;
+
+extern void host_configure(int os_type, int ram_type, int tv_type, int basic_type);
+extern int  host_load(const char *filename);
+extern void host_drain_audio(void (*sink)(const UBYTE *samples, int count, void *ctx), void *ctx);
+
+#endif // _HOST_NDS_H_
@@ -0,0 +1,73 @@
+/*
+ * nds.h (host) - stand-in for the libnds header when building the emulation
+ * core for a desktop host (Linux/gcc) instead of the Nintendo DS/DSi.
+ *
+ * Only the handful of types, attributes and hardware helpers that are
+ * referenced by arm9/source/emu are provided here. The ITCM/DTCM placement
+ * attributes compile away (or land in ordinary ELF sections) and the VRAM
+ * banks the core borrows for lookup tables are backed by plain arrays.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#ifndef _HOST_LIBNDS_H
+#define _HOST_LIBNDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifndef A8DS_HOST
+#define A8DS_HOST
+#endif
+
+typedef uint8_t             u8;
+typedef uint16_t            u16;
+typedef uint32_t            u32;
+typedef uint64_t            u64;
+typedef int8_t              s8;
+typedef int16_t             s16;
+typedef int32_t             s32;
+typedef int64_t             s64;
+typedef volatile uint8_t    vu8;
+typedef volatile uint16_t   vu16;
+typedef volatile uint32_t   vu32;
+typedef unsigned char       byte;
+
+// ---------------------------------------------------------------------------
+// Fast memory placement has no meaning on the host - everything is cached.
+// ---------------------------------------------------------------------------
+#define ITCM_CODE
+#define DTCM_DATA
+#define DTCM_BSS
+
+// ---------------------------------------------------------------------------
+// VRAM banks H and I are used by the core as spare fast memory (RAM under
+// the XL OS and the GRAFP lookup table). The host backs them with arrays.
+// ---------------------------------------------------------------------------
+extern u16 host_vram_h[0x8000 / 2];
+extern u16 host_vram_i[0x4000 / 2];
+#define VRAM_H  (host_vram_h)
+#define VRAM_I  (host_vram_i)
+
+// ---------------------------------------------------------------------------
+// The two 8bpp 512x512 bitmap backgrounds the ANTIC renderer draws into.
+// ---------------------------------------------------------------------------
+#define HOST_BG_BYTES   (512 * 512)
+extern u16 *bgGetGfxPtr(int id);
+
+#define siprintf    sprintf
+
+#endif // _HOST_LIBNDS_H
@@ -0,0 +1,206 @@
+/*
+ * soundtest.c drives the POKEY sound core (pokeysnd.c) on its own - no 6502,
+ * no scanlines - to compare the classic one-level-per-sample synthesis with
+ * the band-limited step (SND_BLEP) one at each of the output rates the SOUND
+ * option offers. For every engine and rate it plays a sweep of pure tones
+ * and measures how much of the output is aliasing: the square wave's
+ * harmonics above half the output rate fold back down between the harmonics
+ * below it, so everything the spectrum holds away from a harmonic (and from
+ * DC) is counted as alias. Then it times the engine with all four channels
+ * busy for samples per second.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "pokeysnd.h"
+#include "soundtest.h"
+
+#define FFT_N           4096        // Samples analysed per tone
+#define SETTLE_N        256         // Played first so the BLEP ring is full and the tone has started
+#define HARM_BINS       4           // Bins either side of a harmonic that count as the harmonic
+#define SWEEP_TONES     24          // Log spaced from SWEEP_LO to SWEEP_HI
+#define SWEEP_LO        200.0
+#define SWEEP_HI        7000.0      // Just under half the classic 15.7K rate
+#define SOUND_GAIN      4           // As pokey.c plays it
+
+typedef struct
+{
+    const char *name;
+    int rate;
+    unsigned int flags;
+} engine_t;
+
+static const engine_t engines[] =
+{
+    {"classic", 15720, 0},
+    {"blep",    15720, SND_BLEP},
+    {"classic", 23580, 0},
+    {"blep",    23580, SND_BLEP},
+    {"classic", 31440, 0},
+    {"blep",    31440, SND_BLEP},
+};
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// ---------------------------------------------------------------------------
+// In-place radix-2 FFT - n must be a power of two.
+// ---------------------------------------------------------------------------
+static void fft(double *re, double *im, int n)
+{
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j)
+        {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        double ang = -2 * M_PI / len;
+        for (int i = 0; i < n; i += len)
+        {
+            for (int k = 0; k < len / 2; k++)
+            {
+                double wr = cos(ang * k), wi = sin(ang * k);
+                double xr = re[i+k+len/2] * wr - im[i+k+len/2] * wi;
+                double xi = re[i+k+len/2] * wi + im[i+k+len/2] * wr;
+                re[i+k+len/2] = re[i+k] - xr; im[i+k+len/2] = im[i+k] - xi;
+                re[i+k] += xr;                im[i+k] += xi;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Start the sound core fresh with channel 2 playing a pure tone - channels 1
+// and 2 joined into one 16-bit divider on the 1.79MHz clock, so any period
+// can be had. Returns the frequency actually played.
+// ---------------------------------------------------------------------------
+static double start_tone(const engine_t *e, double freq)
+{
+    int div = (int) (FREQ_17_APPROX / (2 * freq) + 0.5);   // Divider = AUDF2*256 + AUDF1 + 7
+    Pokey_sound_init(FREQ_17_APPROX, e->rate, 1, e->flags);
+    Update_pokey_sound(_AUDCTL, CH1_CH2 | CH1_179, 0, SOUND_GAIN);
+    Update_pokey_sound(_AUDF1, (div - 7) & 0xff, 0, SOUND_GAIN);
+    Update_pokey_sound(_AUDF2, (div - 7) >> 8, 0, SOUND_GAIN);
+    Update_pokey_sound(_AUDC2, 0xaf, 0, SOUND_GAIN);                 // Pure tone, volume 15
+    return FREQ_17_APPROX / (2.0 * div);
+}
+
+// ---------------------------------------------------------------------------
+// Alias power relative to the harmonic power, in dB, for one tone.
+// ---------------------------------------------------------------------------
+static double alias_db(const engine_t *e, double freq)
+{
+    static UBYTE buf[SETTLE_N + FFT_N];
+    static double re[FFT_N], im[FFT_N];
+    static UBYTE harmonic[FFT_N / 2];
+
+    double f0 = start_tone(e, freq);
+    Pokey_process_ptr(buf, SETTLE_N + FFT_N);
+
+    for (int i = 0; i < FFT_N; i++)
+    {
+        double hann = 0.5 - 0.5 * cos(2 * M_PI * i / FFT_N);
+        re[i] = (signed char) buf[SETTLE_N + i] * hann;     // Sample bytes are the level less 128
+        im[i] = 0;
+    }
+    fft(re, im, FFT_N);
+
+    memset(harmonic, 0, sizeof(harmonic));
+    double bin_hz = (double) e->rate / FFT_N;
+    for (double f = f0; f < e->rate / 2.0; f += f0)
+    {
+        int c = (int) (f / bin_hz + 0.5);
+        for (int b = c - HARM_BINS; b <= c + HARM_BINS; b++)
+            if (b > 0 && b < FFT_N / 2) harmonic[b] = 1;
+    }
+
+    double harm = 0, alias = 0;
+    for (int b = HARM_BINS + 1; b < FFT_N / 2; b++)     // Clear of DC
+    {
+        double p = re[b] * re[b] + im[b] * im[b];
+        if (harmonic[b]) harm += p; else alias += p;
+    }
+    return 10 * log10(alias / harm);
+}
+
+// ---------------------------------------------------------------------------
+// All four channels going - two pure tones, poly 4 and poly 17 noise - and
+// samples rendered a scanline batch at a time, as pokey.c asks for them.
+// ---------------------------------------------------------------------------
+static double samples_per_sec(const engine_t *e, double seconds)
+{
+    static UBYTE buf[64];
+    static const UBYTE regs[][2] =
+    {
+        {_AUDCTL, 0x00},
+        {_AUDF1, 0x40}, {_AUDC1, 0xa8},     // Pure tone
+        {_AUDF2, 0x51}, {_AUDC2, 0xc8},     // Poly 4
+        {_AUDF3, 0x08}, {_AUDC3, 0x88},     // Poly 17 noise
+        {_AUDF4, 0x79}, {_AUDC4, 0xa8},     // Pure tone
+    };
+
+    Pokey_sound_init(FREQ_17_APPROX, e->rate, 1, e->flags);
+    for (int i = 0; i < (int) (sizeof(regs) / sizeof(regs[0])); i++)
+        Update_pokey_sound(regs[i][0], regs[i][1], 0, SOUND_GAIN);
+
+    double samples = 0, t0 = now_us(), host_us;
+    do
+    {
+        for (int i = 0; i < 256; i++) Pokey_process_ptr(buf, sizeof(buf));
+        samples += 256 * sizeof(buf);
+        host_us = now_us() - t0;
+    } while (host_us < seconds * 1e6);
+    return samples / host_us * 1e6;
+}
+
+void soundtest_run(double seconds)
+{
+    printf("%-8s %6s %12s %12s %10s %12s %9s\n", "sound", "rate", "alias avg dB", "worst dB", "at Hz", "M samples/s", "realtime");
+
+    for (int i = 0; i < (int) (sizeof(engines) / sizeof(engines[0])); i++)
+    {
+        const engine_t *e = &engines[i];
+        double sum = 0, worst = -1000, worst_hz = 0;
+
+        for (int t = 0; t < SWEEP_TONES; t++)
+        {
+            double freq = SWEEP_LO * pow(SWEEP_HI / SWEEP_LO, (double) t / (SWEEP_TONES - 1));
+            double db = alias_db(e, freq);
+            sum += db;
+            if (db > worst) { worst = db; worst_hz = freq; }
+        }
+
+        double sps = samples_per_sec(e, seconds);
+        printf("%-8s %6d %12.1f %12.1f %10.0f %12.2f %8.0fx\n", e->name, e->rate, sum / SWEEP_TONES, worst, worst_hz, sps / 1e6, sps / e->rate);
+    }
+}
@@ -0,0 +1,952 @@
+/*
+ * testimg.c writes out the small test images the host compare targets run
+ * along with any IMAGES given, so the checks that went with a change can be
+ * run again from a clean checkout. Each one is built here from its 6502 code
+ * (listed with the source it was assembled from) rather than kept as a binary:
+ *
+ *   coll.xex - four players and four missiles of mixed sizes moving over
+ *              lines of modes 2-7 and bitmap modes. Every frame it copies
+ *              all 16 collision registers to the screen, then clears them
+ *              with HITCLR; DLIs read P0PL, M0PL, M1PF and P3PL part way
+ *              down the frame and change the player graphics.
+ *   mix.xex  - 40 lines of mode F and E (every other one horizontally
+ *              scrolled) and rows of modes 2 and 4, under players of
+ *              several sizes that move and change colour every frame.
+ *   mixn.xex - mix.xex with the players off (GRACTL and player/missile
+ *              DMA) - the same playfield on its own.
+ *   mixs.xex - mix.xex with the players kept to a narrow band in the
+ *              middle of the line (HPOS 80-167), so most of it has none.
+ *   idleirq.xex - POKEY timer 1 IRQs land while the main loop waits for
+ *              RTCLOK and then VCOUNT to move on, through an IRQ handler of
+ *              its own with no loop in it. RANDOM read after each wait
+ *              shows the exact cycle it ended on, so skipping the wait
+ *              loops (and not) must give the same screens.
+ *   timer.xex - POKEY timer 1 at AUDF1=9, 106.67 IRQs a frame. The IRQ
+ *              logs VCOUNT each time; at line 16 of each frame the main loop
+ *              puts up how many came since the last and the lines the first,
+ *              53rd and last of them landed on. The counts run 107, 106, 107
+ *              ..., 1280 every 12 frames, if the IRQs keep their own cycle.
+ *   dlmod.xex - a display list that changes under ANTIC: the main loop
+ *              moves the first line's LMS on every frame, a DLI rewrites the
+ *              mode of a line further down and every fourth frame another
+ *              DLI points DLISTL/H at a second list part way down the screen.
+ *              Following last frame's plan (and not) must give the same
+ *              screens.
+ *   stereo.xex - both POKEYs play: a sweep and three pitches that change
+ *              each sweep on the second one ($D21x), with AUDCTL and the
+ *              distortions changing, and a tone and volume ramp on the
+ *              first. compare-audio runs it with -stereo as well.
+ *   boot.cas - a boot tape of 7 records at 600 baud. The boot file fills
+ *              the screen with a pattern and changes its colour, so the
+ *              SIO patch and real time loading (-nosiopatch) should both
+ *              end on the same screen - compare-tape checks they do.
+ *   disk.atr - 720 single density sectors (92K), small enough for SIO to
+ *              hold in RAM. Each sector is filled with a pattern of its own
+ *              so disktest can tell them apart.
+ *   bigdisk.atr - 1600 double density sectors (400K), over SIO_CACHE_MAX,
+ *              so disktest's "ram" run reads it from the file after all.
+ *
+ * A8DS - Atari 8-bit Emulator designed to run on the Nintendo DS/DSi is
+ * Copyright (c) 2021-2024 Dave Bernazzani (wavemotion-dave)
+
+ * Copying and distribution of this emulator, its source code and associated
+ * readme files, with or without modification, are permitted in any medium without
+ * royalty provided this full copyright notice (including the Atari800 one below)
+ * is used and wavemotion-dave, alekmaul (original port), Atari800 team (for the
+ * original source) and Avery Lee (Altirra OS) are credited and thanked profusely.
+ *
+ * The A8DS emulator is offered as-is, without any warranty.
+ *
+ * Since much of the original codebase came from the Atari800 project, and since
+ * that project is released under the GPL V2, this program and source must also
+ * be distributed using that same licensing model. See COPYING for the full license.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "host_nds.h"
+#include "atari.h"
+#include "sio.h"
+#include "testimg.h"
+
+#define TESTIMG_ORG     0x2000      // Where each executable loads and runs
+
+static const UBYTE coll_code[] =
+{
+    0xa2, 0x00,                         // $2000  start: LDX #0
+    0xad, 0x0a, 0xd2,                   // $2002  fill: LDA RANDOM
+    0x29, 0x3f,                         // $2005  AND #$3F
+    0x9d, 0x00, 0x40,                   // $2007  STA SCR,X
+    0xad, 0x0a, 0xd2,                   // $200A  LDA RANDOM
+    0x9d, 0x00, 0x41,                   // $200D  STA SCR+$100,X
+    0xad, 0x0a, 0xd2,                   // $2010  LDA RANDOM
+    0x9d, 0x00, 0x50,                   // $2013  STA GFX,X
+    0xad, 0x0a, 0xd2,                   // $2016  LDA RANDOM
+    0x9d, 0x00, 0x51,                   // $2019  STA GFX+$100,X
+    0xad, 0x0a, 0xd2,                   // $201C  LDA RANDOM
+    0x9d, 0x00, 0x52,                   // $201F  STA GFX+$200,X
+    0xad, 0x0a, 0xd2,                   // $2022  LDA RANDOM
+    0x9d, 0x00, 0x53,                   // $2025  STA GFX+$300,X
+    0xe8,                               // $2028  INX
+    0xd0, 0xd7,                         // $2029  BNE fill
+    0xa9, 0xbd,                         // $202B  LDA #<dli
+    0x8d, 0x00, 0x02,                   // $202D  STA VDSLST
+    0xa9, 0x20,                         // $2030  LDA #>dli
+    0x8d, 0x01, 0x02,                   // $2032  STA VDSLST+1
+    0xa9, 0xf5,                         // $2035  LDA #<dl
+    0x8d, 0x30, 0x02,                   // $2037  STA SDLSTL
+    0xa9, 0x20,                         // $203A  LDA #>dl
+    0x8d, 0x31, 0x02,                   // $203C  STA SDLSTL+1
+    0xa9, 0xc0,                         // $203F  LDA #$C0
+    0x8d, 0x0e, 0xd4,                   // $2041  STA NMIEN
+    0xa9, 0x3c,                         // $2044  LDA #$3C
+    0x8d, 0x0d, 0xd0,                   // $2046  STA GRAFP0
+    0xa9, 0x81,                         // $2049  LDA #$81
+    0x8d, 0x0e, 0xd0,                   // $204B  STA GRAFP1
+    0xa9, 0xff,                         // $204E  LDA #$FF
+    0x8d, 0x0f, 0xd0,                   // $2050  STA GRAFP2
+    0xa9, 0xaa,                         // $2053  LDA #$AA
+    0x8d, 0x10, 0xd0,                   // $2055  STA GRAFP3
+    0xa9, 0xe4,                         // $2058  LDA #$E4
+    0x8d, 0x11, 0xd0,                   // $205A  STA GRAFM
+    0xa9, 0x01,                         // $205D  LDA #1
+    0x8d, 0x09, 0xd0,                   // $205F  STA SIZEP1
+    0xa9, 0x03,                         // $2062  LDA #3
+    0x8d, 0x0a, 0xd0,                   // $2064  STA SIZEP2
+    0xa9, 0x80,                         // $2067  LDA #$80
+    0x8d, 0x03, 0xd0,                   // $2069  STA HPOSP3
+    0xa5, 0x14,                         // $206C  main: LDA RTCLOK
+    0xc5, 0x14,                         // $206E  wait: CMP RTCLOK
+    0xf0, 0xfc,                         // $2070  BEQ wait
+    0xa2, 0x0f,                         // $2072  LDX #15
+    0xbd, 0x00, 0xd0,                   // $2074  rd: LDA $D000,X
+    0x9d, 0x00, 0x40,                   // $2077  STA SCR,X
+    0xca,                               // $207A  DEX
+    0x10, 0xf7,                         // $207B  BPL rd
+    0x8d, 0x1e, 0xd0,                   // $207D  STA HITCLR
+    0xa9, 0x00,                         // $2080  LDA #0
+    0x85, 0x80,                         // $2082  STA DCNT
+    0xa5, 0x14,                         // $2084  LDA RTCLOK
+    0x8d, 0x00, 0xd0,                   // $2086  STA HPOSP0
+    0x0a,                               // $2089  ASL A
+    0x8d, 0x01, 0xd0,                   // $208A  STA HPOSP1
+    0x49, 0xff,                         // $208D  EOR #$FF
+    0x8d, 0x02, 0xd0,                   // $208F  STA HPOSP2
+    0xa5, 0x14,                         // $2092  LDA RTCLOK
+    0x4a,                               // $2094  LSR A
+    0x8d, 0x04, 0xd0,                   // $2095  STA HPOSM0
+    0x69, 0x30,                         // $2098  ADC #$30
+    0x8d, 0x05, 0xd0,                   // $209A  STA HPOSM1
+    0x69, 0x07,                         // $209D  ADC #$07
+    0x8d, 0x06, 0xd0,                   // $209F  STA HPOSM2
+    0x49, 0x5a,                         // $20A2  EOR #$5A
+    0x8d, 0x07, 0xd0,                   // $20A4  STA HPOSM3
+    0xa5, 0x14,                         // $20A7  LDA RTCLOK
+    0x4a,                               // $20A9  LSR A
+    0x4a,                               // $20AA  LSR A
+    0x8d, 0x0c, 0xd0,                   // $20AB  STA SIZEM
+    0x29, 0x03,                         // $20AE  AND #$03
+    0x8d, 0x0b, 0xd0,                   // $20B0  STA SIZEP3
+    0xa5, 0x14,                         // $20B3  LDA RTCLOK
+    0x29, 0x0f,                         // $20B5  AND #$0F
+    0x8d, 0x6f, 0x02,                   // $20B7  STA GPRIOR
+    0x4c, 0x6c, 0x20,                   // $20BA  JMP main
+    0x48,                               // $20BD  dli: PHA
+    0x8a,                               // $20BE  TXA
+    0x48,                               // $20BF  PHA
+    0xad, 0x0b, 0xd4,                   // $20C0  LDA VCOUNT
+    0x8d, 0x0a, 0xd4,                   // $20C3  STA WSYNC
+    0x8d, 0x0f, 0xd0,                   // $20C6  STA GRAFP2
+    0x49, 0x55,                         // $20C9  EOR #$55
+    0x8d, 0x11, 0xd0,                   // $20CB  STA GRAFM
+    0xa6, 0x80,                         // $20CE  LDX DCNT
+    0xad, 0x0c, 0xd0,                   // $20D0  LDA $D00C
+    0x9d, 0x28, 0x40,                   // $20D3  STA SCR+40,X
+    0xad, 0x08, 0xd0,                   // $20D6  LDA $D008
+    0x9d, 0x50, 0x40,                   // $20D9  STA SCR+80,X
+    0xad, 0x05, 0xd0,                   // $20DC  LDA $D005
+    0x9d, 0x78, 0x40,                   // $20DF  STA SCR+120,X
+    0xad, 0x0f, 0xd0,                   // $20E2  LDA $D00F
+    0x9d, 0xa0, 0x40,                   // $20E5  STA SCR+160,X
+    0xe6, 0x80,                         // $20E8  INC DCNT
+    0xad, 0x0b, 0xd4,                   // $20EA  LDA VCOUNT
+    0x0a,                               // $20ED  ASL A
+    0x8d, 0x03, 0xd0,                   // $20EE  STA HPOSP3
+    0x68,                               // $20F1  PLA
+    0xaa,                               // $20F2  TAX
+    0x68,                               // $20F3  PLA
+    0x40,                               // $20F4  RTI
+    // $20F5  dl: the display list - DLIs on mode 2-7 and F/E/D-8 lines, some without
+    0x70, 0x70, 0x70,
+    0xc2, 0x00, 0x40,
+    0x82, 0x82, 0x84, 0x84, 0x86, 0x87, 0x85,
+    0xcf, 0x00, 0x50,
+    0x8f, 0x8f, 0x8f, 0x8f, 0x8f, 0x0f, 0x0f, 0x0f, 0x8f, 0x0f, 0x0f, 0x8f,
+    0x8f, 0x8f, 0x8f, 0x8f, 0x8f, 0x8f, 0x8f,
+    0x8e, 0x8e, 0x0e, 0x0e, 0x8e, 0x8e, 0x8e, 0x0e, 0x8e, 0x8e, 0x8e, 0x8e,
+    0x8e, 0x8e, 0x8e, 0x8e, 0x8e, 0x8e, 0x8e,
+    0x8d, 0x8d, 0x8d, 0x8c, 0x8c, 0x8a, 0x8a, 0x89, 0x88, 0x88,
+    0x02, 0x02, 0x82, 0x02, 0x02,
+    0x41, 0xf5, 0x20,
+};
+
+static const UBYTE mix_code[] =
+{
+    0xa9, 0x00,                         // $2000  start: LDA #0
+    0x8d, 0x2f, 0x02,                   // $2002  STA SDMCTL
+    0xa0, 0x00,                         // $2005  LDY #0
+    0xa9, 0x70,                         // $2007  LDA #$70
+    0x20, 0x6e, 0x21,                   // $2009  JSR put
+    0x20, 0x6e, 0x21,                   // $200C  JSR put
+    0x20, 0x6e, 0x21,                   // $200F  JSR put
+    // 40 lines of mode F at $4000, every other one horizontally scrolled
+    0xa9, 0x4f,                         // $2012  LDA #$4F
+    0x20, 0x6e, 0x21,                   // $2014  JSR put
+    0xa9, 0x00,                         // $2017  LDA #$00
+    0x20, 0x6e, 0x21,                   // $2019  JSR put
+    0xa9, 0x40,                         // $201C  LDA #$40
+    0x20, 0x6e, 0x21,                   // $201E  JSR put
+    0xa2, 0x27,                         // $2021  LDX #39
+    0x8a,                               // $2023  f1: TXA
+    0x29, 0x01,                         // $2024  AND #1
+    0x0a,                               // $2026  ASL A
+    0x0a,                               // $2027  ASL A
+    0x0a,                               // $2028  ASL A
+    0x0a,                               // $2029  ASL A
+    0x09, 0x0f,                         // $202A  ORA #$0F
+    0x20, 0x6e, 0x21,                   // $202C  JSR put
+    0xca,                               // $202F  DEX
+    0xd0, 0xf1,                         // $2030  BNE f1
+    // 40 lines of mode E at $5000
+    0xa9, 0x4e,                         // $2032  LDA #$4E
+    0x20, 0x6e, 0x21,                   // $2034  JSR put
+    0xa9, 0x00,                         // $2037  LDA #$00
+    0x20, 0x6e, 0x21,                   // $2039  JSR put
+    0xa9, 0x50,                         // $203C  LDA #$50
+    0x20, 0x6e, 0x21,                   // $203E  JSR put
+    0xa2, 0x27,                         // $2041  LDX #39
+    0x8a,                               // $2043  e1: TXA
+    0x29, 0x02,                         // $2044  AND #2
+    0x0a,                               // $2046  ASL A
+    0x0a,                               // $2047  ASL A
+    0x0a,                               // $2048  ASL A
+    0x09, 0x0e,                         // $2049  ORA #$0E
+    0x20, 0x6e, 0x21,                   // $204B  JSR put
+    0xca,                               // $204E  DEX
+    0xd0, 0xf2,                         // $204F  BNE e1
+    // 6 rows of mode 2 and 6 of mode 4 at $6000, scrolled and not
+    0xa9, 0x42,                         // $2051  LDA #$42
+    0x20, 0x6e, 0x21,                   // $2053  JSR put
+    0xa9, 0x00,                         // $2056  LDA #$00
+    0x20, 0x6e, 0x21,                   // $2058  JSR put
+    0xa9, 0x60,                         // $205B  LDA #$60
+    0x20, 0x6e, 0x21,                   // $205D  JSR put
+    0xa9, 0x12,                         // $2060  LDA #$12
+    0x20, 0x6e, 0x21,                   // $2062  JSR put
+    0xa9, 0x02,                         // $2065  LDA #$02
+    0x20, 0x6e, 0x21,                   // $2067  JSR put
+    0xa9, 0x12,                         // $206A  LDA #$12
+    0x20, 0x6e, 0x21,                   // $206C  JSR put
+    0xa9, 0x02,                         // $206F  LDA #$02
+    0x20, 0x6e, 0x21,                   // $2071  JSR put
+    0xa9, 0x12,                         // $2074  LDA #$12
+    0x20, 0x6e, 0x21,                   // $2076  JSR put
+    0xa9, 0x14,                         // $2079  LDA #$14
+    0x20, 0x6e, 0x21,                   // $207B  JSR put
+    0xa9, 0x04,                         // $207E  LDA #$04
+    0x20, 0x6e, 0x21,                   // $2080  JSR put
+    0xa9, 0x14,                         // $2083  LDA #$14
+    0x20, 0x6e, 0x21,                   // $2085  JSR put
+    0xa9, 0x04,                         // $2088  LDA #$04
+    0x20, 0x6e, 0x21,                   // $208A  JSR put
+    0xa9, 0x14,                         // $208D  LDA #$14
+    0x20, 0x6e, 0x21,                   // $208F  JSR put
+    0xa9, 0x04,                         // $2092  LDA #$04
+    0x20, 0x6e, 0x21,                   // $2094  JSR put
+    0xa9, 0x41,                         // $2097  LDA #$41
+    0x20, 0x6e, 0x21,                   // $2099  JSR put
+    0xa9, 0x00,                         // $209C  LDA #<DL
+    0x20, 0x6e, 0x21,                   // $209E  JSR put
+    0xa9, 0x28,                         // $20A1  LDA #>DL
+    0x20, 0x6e, 0x21,                   // $20A3  JSR put
+    // fill screen with pattern
+    0xa9, 0x00,                         // $20A6  LDA #<SCR
+    0x85, 0x80,                         // $20A8  STA PTR
+    0xa9, 0x40,                         // $20AA  LDA #>SCR
+    0x8d, 0x81, 0x00,                   // $20AC  STA PTR+1
+    0xa2, 0x30,                         // $20AF  LDX #48
+    0xa0, 0x00,                         // $20B1  LDY #0
+    0x98,                               // $20B3  fill: TYA
+    0x4d, 0x81, 0x00,                   // $20B4  EOR PTR+1
+    0x0a,                               // $20B7  ASL A
+    0x6d, 0x81, 0x00,                   // $20B8  ADC PTR+1
+    0x91, 0x80,                         // $20BB  STA (PTR),Y
+    0xc8,                               // $20BD  INY
+    0xd0, 0xf3,                         // $20BE  BNE fill
+    0xee, 0x81, 0x00,                   // $20C0  INC PTR+1
+    0xca,                               // $20C3  DEX
+    0xd0, 0xed,                         // $20C4  BNE fill
+    // a few blank bytes so the background path is used too
+    0xa9, 0x00,                         // $20C6  LDA #0
+    0xa0, 0x14,                         // $20C8  LDY #20
+    0x99, 0x00, 0x40,                   // $20CA  bl: STA $4000,Y
+    0x99, 0x00, 0x50,                   // $20CD  STA $5000,Y
+    0x99, 0x00, 0x60,                   // $20D0  STA $6000,Y
+    0x88,                               // $20D3  DEY
+    0x10, 0xf4,                         // $20D4  BPL bl
+    // PMG
+    0xa9, 0x30,                         // $20D6  LDA #>PMG
+    0x8d, 0x07, 0xd4,                   // $20D8  STA PMBASE
+    0xa9, 0x03,                         // $20DB  LDA #3
+    0x8d, 0x1d, 0xd0,                   // $20DD  STA GRACTL
+    0xa9, 0x04,                         // $20E0  LDA #4
+    0x8d, 0x6f, 0x02,                   // $20E2  STA GPRIOR
+    0xa2, 0x00,                         // $20E5  LDX #0
+    0x8a,                               // $20E7  pm1: TXA
+    0x29, 0x3c,                         // $20E8  AND #$3C
+    0x9d, 0x00, 0x34,                   // $20EA  STA PMG+$400,X
+    0x9d, 0x00, 0x35,                   // $20ED  STA PMG+$500,X
+    0x49, 0xff,                         // $20F0  EOR #$FF
+    0x9d, 0x00, 0x36,                   // $20F2  STA PMG+$600,X
+    0x9d, 0x00, 0x37,                   // $20F5  STA PMG+$700,X
+    0x8a,                               // $20F8  TXA
+    0x29, 0x33,                         // $20F9  AND #$33
+    0x9d, 0x00, 0x33,                   // $20FB  STA PMG+$300,X
+    0xe8,                               // $20FE  INX
+    0xd0, 0xe6,                         // $20FF  BNE pm1
+    0xa9, 0x01,                         // $2101  LDA #1
+    0x8d, 0x09, 0xd0,                   // $2103  STA SIZEP0+1
+    0xa9, 0x03,                         // $2106  LDA #3
+    0x8d, 0x0b, 0xd0,                   // $2108  STA SIZEP0+3
+    0xa9, 0x1a,                         // $210B  LDA #$1A
+    0x8d, 0xc0, 0x02,                   // $210D  STA PCOLR0
+    0xa9, 0x46,                         // $2110  LDA #$46
+    0x8d, 0xc1, 0x02,                   // $2112  STA PCOLR0+1
+    0xa9, 0x88,                         // $2115  LDA #$88
+    0x8d, 0xc2, 0x02,                   // $2117  STA PCOLR0+2
+    0xa9, 0xc8,                         // $211A  LDA #$C8
+    0x8d, 0xc3, 0x02,                   // $211C  STA PCOLR0+3
+    0xa9, 0x28,                         // $211F  LDA #$28
+    0x8d, 0xc4, 0x02,                   // $2121  STA COLOR0
+    0xa9, 0x9e,                         // $2124  LDA #$9E
+    0x8d, 0xc5, 0x02,                   // $2126  STA COLOR0+1
+    0xa9, 0x0e,                         // $2129  LDA #$0E
+    0x8d, 0xc6, 0x02,                   // $212B  STA COLOR0+2
+    0xa9, 0x36,                         // $212E  LDA #$36
+    0x8d, 0xc7, 0x02,                   // $2130  STA COLOR0+3
+    0xa9, 0x02,                         // $2133  LDA #$02
+    0x8d, 0xc8, 0x02,                   // $2135  STA COLOR4
+    0xa9, 0x00,                         // $2138  LDA #<DL
+    0x8d, 0x30, 0x02,                   // $213A  STA SDLSTL
+    0xa9, 0x28,                         // $213D  LDA #>DL
+    0x8d, 0x31, 0x02,                   // $213F  STA SDLSTL+1
+    0xa9, 0x3e,                         // $2142  LDA #$3E
+    0x8d, 0x2f, 0x02,                   // $2144  STA SDMCTL
+    0xa5, 0x14,                         // $2147  main: LDA RTCLOK
+    0xc5, 0x14,                         // $2149  wait: CMP RTCLOK
+    0xf0, 0xfc,                         // $214B  BEQ wait
+    0xe6, 0x82,                         // $214D  INC FRM
+    0xa5, 0x82,                         // $214F  LDA FRM
+    0x8d, 0x04, 0xd4,                   // $2151  STA HSCROL
+    0x29, 0xf0,                         // $2154  AND #$F0
+    0x09, 0x04,                         // $2156  ORA #$04
+    0x8d, 0xc6, 0x02,                   // $2158  STA COLOR0+2
+    0xa2, 0x03,                         // $215B  LDX #3
+    0xa5, 0x82,                         // $215D  mv: LDA FRM
+    0x7d, 0x73, 0x21,                   // $215F  ADC tab,X
+    0x9d, 0x00, 0xd0,                   // $2162  STA HPOSP0,X
+    0x9d, 0x04, 0xd0,                   // $2165  STA HPOSP0+4,X
+    0xca,                               // $2168  DEX
+    0x10, 0xf2,                         // $2169  BPL mv
+    0x4c, 0x47, 0x21,                   // $216B  JMP main
+    0x99, 0x00, 0x28,                   // $216E  put: STA DL,Y
+    0xc8,                               // $2171  INY
+    0x60,                               // $2172  RTS
+    // $2173  tab:
+    0x28, 0x50, 0x78, 0xa0,
+};
+
+static const UBYTE mixs_code[] =
+{
+    0xa9, 0x00,                         // $2000  start: LDA #0
+    0x8d, 0x2f, 0x02,                   // $2002  STA SDMCTL
+    0xa0, 0x00,                         // $2005  LDY #0
+    0xa9, 0x70,                         // $2007  LDA #$70
+    0x20, 0x70, 0x21,                   // $2009  JSR put
+    0x20, 0x70, 0x21,                   // $200C  JSR put
+    0x20, 0x70, 0x21,                   // $200F  JSR put
+    // 40 lines of mode F at $4000, every other one horizontally scrolled
+    0xa9, 0x4f,                         // $2012  LDA #$4F
+    0x20, 0x70, 0x21,                   // $2014  JSR put
+    0xa9, 0x00,                         // $2017  LDA #$00
+    0x20, 0x70, 0x21,                   // $2019  JSR put
+    0xa9, 0x40,                         // $201C  LDA #$40
+    0x20, 0x70, 0x21,                   // $201E  JSR put
+    0xa2, 0x27,                         // $2021  LDX #39
+    0x8a,                               // $2023  f1: TXA
+    0x29, 0x01,                         // $2024  AND #1
+    0x0a,                               // $2026  ASL A
+    0x0a,                               // $2027  ASL A
+    0x0a,                               // $2028  ASL A
+    0x0a,                               // $2029  ASL A
+    0x09, 0x0f,                         // $202A  ORA #$0F
+    0x20, 0x70, 0x21,                   // $202C  JSR put
+    0xca,                               // $202F  DEX
+    0xd0, 0xf1,                         // $2030  BNE f1
+    // 40 lines of mode E at $5000
+    0xa9, 0x4e,                         // $2032  LDA #$4E
+    0x20, 0x70, 0x21,                   // $2034  JSR put
+    0xa9, 0x00,                         // $2037  LDA #$00
+    0x20, 0x70, 0x21,                   // $2039  JSR put
+    0xa9, 0x50,                         // $203C  LDA #$50
+    0x20, 0x70, 0x21,                   // $203E  JSR put
+    0xa2, 0x27,                         // $2041  LDX #39
+    0x8a,                               // $2043  e1: TXA
+    0x29, 0x02,                         // $2044  AND #2
+    0x0a,                               // $2046  ASL A
+    0x0a,                               // $2047  ASL A
+    0x0a,                               // $2048  ASL A
+    0x09, 0x0e,                         // $2049  ORA #$0E
+    0x20, 0x70, 0x21,                   // $204B  JSR put
+    0xca,                               // $204E  DEX
+    0xd0, 0xf2,                         // $204F  BNE e1
+    // 6 rows of mode 2 and 6 of mode 4 at $6000, scrolled and not
+    0xa9, 0x42,                         // $2051  LDA #$42
+    0x20, 0x70, 0x21,                   // $2053  JSR put
+    0xa9, 0x00,                         // $2056  LDA #$00
+    0x20, 0x70, 0x21,                   // $2058  JSR put
+    0xa9, 0x60,                         // $205B  LDA #$60
+    0x20, 0x70, 0x21,                   // $205D  JSR put
+    0xa9, 0x12,                         // $2060  LDA #$12
+    0x20, 0x70, 0x21,                   // $2062  JSR put
+    0xa9, 0x02,                         // $2065  LDA #$02
+    0x20, 0x70, 0x21,                   // $2067  JSR put
+    0xa9, 0x12,                         // $206A  LDA #$12
+    0x20, 0x70, 0x21,                   // $206C  JSR put
+    0xa9, 0x02,                         // $206F  LDA #$02
+    0x20, 0x70, 0x21,                   // $2071  JSR put
+    0xa9, 0x12,                         // $2074  LDA #$12
+    0x20, 0x70, 0x21,                   // $2076  JSR put
+    0xa9, 0x14,                         // $2079  LDA #$14
+    0x20, 0x70, 0x21,                   // $207B  JSR put
+    0xa9, 0x04,                         // $207E  LDA #$04
+    0x20, 0x70, 0x21,                   // $2080  JSR put
+    0xa9, 0x14,                         // $2083  LDA #$14
+    0x20, 0x70, 0x21,                   // $2085  JSR put
+    0xa9, 0x04,                         // $2088  LDA #$04
+    0x20, 0x70, 0x21,                   // $208A  JSR put
+    0xa9, 0x14,                         // $208D  LDA #$14
+    0x20, 0x70, 0x21,                   // $208F  JSR put
+    0xa9, 0x04,                         // $2092  LDA #$04
+    0x20, 0x70, 0x21,                   // $2094  JSR put
+    0xa9, 0x41,                         // $2097  LDA #$41
+    0x20, 0x70, 0x21,                   // $2099  JSR put
+    0xa9, 0x00,                         // $209C  LDA #<DL
+    0x20, 0x70, 0x21,                   // $209E  JSR put
+    0xa9, 0x28,                         // $20A1  LDA #>DL
+    0x20, 0x70, 0x21,                   // $20A3  JSR put
+    // fill screen with pattern
+    0xa9, 0x00,                         // $20A6  LDA #<SCR
+    0x85, 0x80,                         // $20A8  STA PTR
+    0xa9, 0x40,                         // $20AA  LDA #>SCR
+    0x8d, 0x81, 0x00,                   // $20AC  STA PTR+1
+    0xa2, 0x30,                         // $20AF  LDX #48
+    0xa0, 0x00,                         // $20B1  LDY #0
+    0x98,                               // $20B3  fill: TYA
+    0x4d, 0x81, 0x00,                   // $20B4  EOR PTR+1
+    0x0a,                               // $20B7  ASL A
+    0x6d, 0x81, 0x00,                   // $20B8  ADC PTR+1
+    0x91, 0x80,                         // $20BB  STA (PTR),Y
+    0xc8,                               // $20BD  INY
+    0xd0, 0xf3,                         // $20BE  BNE fill
+    0xee, 0x81, 0x00,                   // $20C0  INC PTR+1
+    0xca,                               // $20C3  DEX
+    0xd0, 0xed,                         // $20C4  BNE fill
+    // a few blank bytes so the background path is used too
+    0xa9, 0x00,                         // $20C6  LDA #0
+    0xa0, 0x14,                         // $20C8  LDY #20
+    0x99, 0x00, 0x40,                   // $20CA  bl: STA $4000,Y
+    0x99, 0x00, 0x50,                   // $20CD  STA $5000,Y
+    0x99, 0x00, 0x60,                   // $20D0  STA $6000,Y
+    0x88,                               // $20D3  DEY
+    0x10, 0xf4,                         // $20D4  BPL bl
+    // PMG
+    0xa9, 0x30,                         // $20D6  LDA #>PMG
+    0x8d, 0x07, 0xd4,                   // $20D8  STA PMBASE
+    0xa9, 0x03,                         // $20DB  LDA #3
+    0x8d, 0x1d, 0xd0,                   // $20DD  STA GRACTL
+    0xa9, 0x04,                         // $20E0  LDA #4
+    0x8d, 0x6f, 0x02,                   // $20E2  STA GPRIOR
+    0xa2, 0x00,                         // $20E5  LDX #0
+    0x8a,                               // $20E7  pm1: TXA
+    0x29, 0x3c,                         // $20E8  AND #$3C
+    0x9d, 0x00, 0x34,                   // $20EA  STA PMG+$400,X
+    0x9d, 0x00, 0x35,                   // $20ED  STA PMG+$500,X
+    0x49, 0xff,                         // $20F0  EOR #$FF
+    0x9d, 0x00, 0x36,                   // $20F2  STA PMG+$600,X
+    0x9d, 0x00, 0x37,                   // $20F5  STA PMG+$700,X
+    0x8a,                               // $20F8  TXA
+    0x29, 0x33,                         // $20F9  AND #$33
+    0x9d, 0x00, 0x33,                   // $20FB  STA PMG+$300,X
+    0xe8,                               // $20FE  INX
+    0xd0, 0xe6,                         // $20FF  BNE pm1
+    0xa9, 0x01,                         // $2101  LDA #1
+    0x8d, 0x09, 0xd0,                   // $2103  STA SIZEP0+1
+    0xa9, 0x03,                         // $2106  LDA #3
+    0x8d, 0x0b, 0xd0,                   // $2108  STA SIZEP0+3
+    0xa9, 0x1a,                         // $210B  LDA #$1A
+    0x8d, 0xc0, 0x02,                   // $210D  STA PCOLR0
+    0xa9, 0x46,                         // $2110  LDA #$46
+    0x8d, 0xc1, 0x02,                   // $2112  STA PCOLR0+1
+    0xa9, 0x88,                         // $2115  LDA #$88
+    0x8d, 0xc2, 0x02,                   // $2117  STA PCOLR0+2
+    0xa9, 0xc8,                         // $211A  LDA #$C8
+    0x8d, 0xc3, 0x02,                   // $211C  STA PCOLR0+3
+    0xa9, 0x28,                         // $211F  LDA #$28
+    0x8d, 0xc4, 0x02,                   // $2121  STA COLOR0
+    0xa9, 0x9e,                         // $2124  LDA #$9E
+    0x8d, 0xc5, 0x02,                   // $2126  STA COLOR0+1
+    0xa9, 0x0e,                         // $2129  LDA #$0E
+    0x8d, 0xc6, 0x02,                   // $212B  STA COLOR0+2
+    0xa9, 0x36,                         // $212E  LDA #$36
+    0x8d, 0xc7, 0x02,                   // $2130  STA COLOR0+3
+    0xa9, 0x02,                         // $2133  LDA #$02
+    0x8d, 0xc8, 0x02,                   // $2135  STA COLOR4
+    0xa9, 0x00,                         // $2138  LDA #<DL
+    0x8d, 0x30, 0x02,                   // $213A  STA SDLSTL
+    0xa9, 0x28,                         // $213D  LDA #>DL
+    0x8d, 0x31, 0x02,                   // $213F  STA SDLSTL+1
+    0xa9, 0x3e,                         // $2142  LDA #$3E
+    0x8d, 0x2f, 0x02,                   // $2144  STA SDMCTL
+    0xa5, 0x14,                         // $2147  main: LDA RTCLOK
+    0xc5, 0x14,                         // $2149  wait: CMP RTCLOK
+    0xf0, 0xfc,                         // $214B  BEQ wait
+    0xe6, 0x82,                         // $214D  INC FRM
+    0xa5, 0x82,                         // $214F  LDA FRM
+    0x8d, 0x04, 0xd4,                   // $2151  STA HSCROL
+    0x29, 0xf0,                         // $2154  AND #$F0
+    0x09, 0x04,                         // $2156  ORA #$04
+    0x8d, 0xc6, 0x02,                   // $2158  STA COLOR0+2
+    0xa2, 0x03,                         // $215B  LDX #3
+    0xa5, 0x82,                         // $215D  mv: LDA FRM
+    0x29, 0x3f,                         // $215F  AND #$3F
+    0x7d, 0x75, 0x21,                   // $2161  ADC tab,X
+    0x9d, 0x00, 0xd0,                   // $2164  STA HPOSP0,X
+    0x9d, 0x04, 0xd0,                   // $2167  STA HPOSP0+4,X
+    0xca,                               // $216A  DEX
+    0x10, 0xf0,                         // $216B  BPL mv
+    0x4c, 0x47, 0x21,                   // $216D  JMP main
+    0x99, 0x00, 0x28,                   // $2170  put: STA DL,Y
+    0xc8,                               // $2173  INY
+    0x60,                               // $2174  RTS
+    // $2175  tab:
+    0x50, 0x58, 0x60, 0x68,
+};
+
+static const UBYTE idleirq_code[] =
+{
+    0x78,                               // $2000  start: SEI
+    0xa9, 0x50,                         // $2001  LDA #<tirq
+    0x8d, 0x16, 0x02,                   // $2003  STA VIMIRQ
+    0xa9, 0x20,                         // $2006  LDA #>tirq
+    0x8d, 0x17, 0x02,                   // $2008  STA VIMIRQ+1
+    0xa9, 0x00,                         // $200B  LDA #0
+    0x8d, 0x08, 0xd2,                   // $200D  STA AUDCTL
+    0x85, 0x80,                         // $2010  STA POS
+    0x85, 0x81,                         // $2012  STA CNT
+    0xa9, 0x03,                         // $2014  LDA #3
+    0x8d, 0x0f, 0xd2,                   // $2016  STA SKCTL
+    0xa9, 0x40,                         // $2019  LDA #$40
+    0x8d, 0x00, 0xd2,                   // $201B  STA AUDF1
+    0xa5, 0x10,                         // $201E  LDA POKMSK
+    0x09, 0x01,                         // $2020  ORA #1
+    0x85, 0x10,                         // $2022  STA POKMSK
+    0x8d, 0x0e, 0xd2,                   // $2024  STA IRQEN
+    0x8d, 0x09, 0xd2,                   // $2027  STA STIMER
+    0x58,                               // $202A  CLI
+    // wait for the next frame, then for line 120 - the timer goes off part way through both
+    0xa5, 0x14,                         // $202B  main: LDA RTCLOK
+    0xc5, 0x14,                         // $202D  wait: CMP RTCLOK
+    0xf0, 0xfc,                         // $202F  BEQ wait
+    0xa4, 0x80,                         // $2031  LDY POS
+    0xad, 0x0a, 0xd2,                   // $2033  LDA RANDOM
+    0x91, 0x58,                         // $2036  STA (SAVMSC),Y
+    0xc8,                               // $2038  INY
+    0xa9, 0x3c,                         // $2039  LDA #60
+    0xcd, 0x0b, 0xd4,                   // $203B  vwait: CMP VCOUNT
+    0xd0, 0xfb,                         // $203E  BNE vwait
+    0xad, 0x0a, 0xd2,                   // $2040  LDA RANDOM
+    0x91, 0x58,                         // $2043  STA (SAVMSC),Y
+    0xc8,                               // $2045  INY
+    0xa5, 0x81,                         // $2046  LDA CNT
+    0x91, 0x58,                         // $2048  STA (SAVMSC),Y
+    0xc8,                               // $204A  INY
+    0x84, 0x80,                         // $204B  STY POS
+    0x4c, 0x2b, 0x20,                   // $204D  JMP main
+    // the whole IRQ (VIMIRQ, not the OS's dispatcher) - no loop in here, so the wait
+    // loop comes back round with the same registers and flags
+    0x48,                               // $2050  tirq: PHA
+    0xa9, 0x00,                         // $2051  LDA #0
+    0x8d, 0x0e, 0xd2,                   // $2053  STA IRQEN
+    0xa5, 0x10,                         // $2056  LDA POKMSK
+    0x8d, 0x0e, 0xd2,                   // $2058  STA IRQEN
+    0xe6, 0x81,                         // $205B  INC CNT
+    0x68,                               // $205D  PLA
+    0x40,                               // $205E  RTI
+};
+
+static const UBYTE timer_code[] =
+{
+    0x78,                               // $2000  start: SEI
+    0xa9, 0x5a,                         // $2001  LDA #<tirq
+    0x8d, 0x10, 0x02,                   // $2003  STA VTIMR1
+    0xa9, 0x20,                         // $2006  LDA #>tirq
+    0x8d, 0x11, 0x02,                   // $2008  STA VTIMR1+1
+    0xa9, 0x00,                         // $200B  LDA #0
+    0x8d, 0x08, 0xd2,                   // $200D  STA AUDCTL
+    0x85, 0x80,                         // $2010  STA POS
+    0x85, 0x81,                         // $2012  STA CNT
+    0xa9, 0x03,                         // $2014  LDA #3
+    0x8d, 0x0f, 0xd2,                   // $2016  STA SKCTL
+    0xa9, 0x09,                         // $2019  LDA #9
+    0x8d, 0x00, 0xd2,                   // $201B  STA AUDF1
+    0xa5, 0x10,                         // $201E  LDA POKMSK
+    0x09, 0x01,                         // $2020  ORA #1
+    0x85, 0x10,                         // $2022  STA POKMSK
+    0x8d, 0x0e, 0xd2,                   // $2024  STA IRQEN
+    0x8d, 0x09, 0xd2,                   // $2027  STA STIMER
+    0x58,                               // $202A  CLI
+    // once a frame, at line 16, put up the IRQ count and the lines the first, a middle and the last IRQ landed on
+    0xa9, 0x08,                         // $202B  main: LDA #8
+    0xcd, 0x0b, 0xd4,                   // $202D  wait: CMP VCOUNT
+    0xf0, 0xfb,                         // $2030  BEQ wait
+    0xcd, 0x0b, 0xd4,                   // $2032  line: CMP VCOUNT
+    0xd0, 0xfb,                         // $2035  BNE line
+    0xa6, 0x81,                         // $2037  LDX CNT
+    0xa9, 0x00,                         // $2039  LDA #0
+    0x85, 0x81,                         // $203B  STA CNT
+    0xa4, 0x80,                         // $203D  LDY POS
+    0x8a,                               // $203F  TXA
+    0x91, 0x58,                         // $2040  STA (SAVMSC),Y
+    0xc8,                               // $2042  INY
+    0xad, 0x01, 0x06,                   // $2043  LDA LOG+1
+    0x91, 0x58,                         // $2046  STA (SAVMSC),Y
+    0xc8,                               // $2048  INY
+    0xad, 0x35, 0x06,                   // $2049  LDA LOG+53
+    0x91, 0x58,                         // $204C  STA (SAVMSC),Y
+    0xc8,                               // $204E  INY
+    0xbd, 0x00, 0x06,                   // $204F  LDA LOG,X
+    0x91, 0x58,                         // $2052  STA (SAVMSC),Y
+    0xc8,                               // $2054  INY
+    0x84, 0x80,                         // $2055  STY POS
+    0x4c, 0x2b, 0x20,                   // $2057  JMP main
+    // VCOUNT at every IRQ, in the order they came this frame
+    0x8a,                               // $205A  tirq: TXA
+    0x48,                               // $205B  PHA
+    0xe6, 0x81,                         // $205C  INC CNT
+    0xa6, 0x81,                         // $205E  LDX CNT
+    0xad, 0x0b, 0xd4,                   // $2060  LDA VCOUNT
+    0x9d, 0x00, 0x06,                   // $2063  STA LOG,X
+    0x68,                               // $2066  PLA
+    0xaa,                               // $2067  TAX
+    0x68,                               // $2068  PLA
+    0x40,                               // $2069  RTI
+};
+
+static const UBYTE dlmod_code[] =
+{
+    0xa2, 0x00,                         // $2000  start: LDX #0
+    0xad, 0x0a, 0xd2,                   // $2002  fill: LDA RANDOM
+    0x9d, 0x00, 0x40,                   // $2005  STA SCR,X
+    0xad, 0x0a, 0xd2,                   // $2008  LDA RANDOM
+    0x9d, 0x00, 0x41,                   // $200B  STA SCR+$100,X
+    0xad, 0x0a, 0xd2,                   // $200E  LDA RANDOM
+    0x9d, 0x00, 0x42,                   // $2011  STA SCR+$200,X
+    0xe8,                               // $2014  INX
+    0xd0, 0xeb,                         // $2015  BNE fill
+    0xa9, 0x3c,                         // $2017  LDA #<dli
+    0x8d, 0x00, 0x02,                   // $2019  STA VDSLST
+    0xa9, 0x20,                         // $201C  LDA #>dli
+    0x8d, 0x01, 0x02,                   // $201E  STA VDSLST+1
+    0xa9, 0x6c,                         // $2021  LDA #<dl
+    0x8d, 0x30, 0x02,                   // $2023  STA SDLSTL
+    0xa9, 0x20,                         // $2026  LDA #>dl
+    0x8d, 0x31, 0x02,                   // $2028  STA SDLSTL+1
+    0xa9, 0xc0,                         // $202B  LDA #$C0
+    0x8d, 0x0e, 0xd4,                   // $202D  STA NMIEN
+    // each frame the first line's LMS moves on a byte
+    0xa5, 0x14,                         // $2030  main: LDA RTCLOK
+    0xc5, 0x14,                         // $2032  wait: CMP RTCLOK
+    0xf0, 0xfc,                         // $2034  BEQ wait
+    0x8d, 0x70, 0x20,                   // $2036  STA lms
+    0x4c, 0x30, 0x20,                   // $2039  JMP main
+    // the first DLI changes the mode of a line further down, the second
+    // moves DLIST to another list every fourth frame
+    0x48,                               // $203C  dli: PHA
+    0x8a,                               // $203D  TXA
+    0x48,                               // $203E  PHA
+    0xad, 0x0b, 0xd4,                   // $203F  LDA VCOUNT
+    0xc9, 0x28,                         // $2042  CMP #40
+    0xb0, 0x0e,                         // $2044  BCS second
+    0xa5, 0x14,                         // $2046  LDA RTCLOK
+    0x29, 0x03,                         // $2048  AND #3
+    0xaa,                               // $204A  TAX
+    0xbd, 0x68, 0x20,                   // $204B  LDA modes,X
+    0x8d, 0x76, 0x20,                   // $204E  STA mod
+    0x4c, 0x64, 0x20,                   // $2051  JMP done
+    0xa5, 0x14,                         // $2054  second: LDA RTCLOK
+    0x29, 0x03,                         // $2056  AND #3
+    0xd0, 0x0a,                         // $2058  BNE done
+    0xa9, 0x89,                         // $205A  LDA #<dl2
+    0x8d, 0x02, 0xd4,                   // $205C  STA DLISTL
+    0xa9, 0x20,                         // $205F  LDA #>dl2
+    0x8d, 0x03, 0xd4,                   // $2061  STA DLISTH
+    0x68,                               // $2064  done: PLA
+    0xaa,                               // $2065  TAX
+    0x68,                               // $2066  PLA
+    0x40,                               // $2067  RTI
+    // $2068  modes:
+    0x02, 0x04, 0x06, 0x07,
+    // $206C  dl:
+    0x70, 0x70, 0x70,
+    0x42,
+    // $2070  lms:
+    0x00, 0x40,
+    0x02, 0x02, 0x02, 0x82,
+    // $2076  mod:
+    0x02,
+    0x02, 0x02, 0x82, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+    0x02, 0x02, 0x02,
+    0x41, 0x6c, 0x20,
+    // $2089  dl2:
+    0x47, 0x00, 0x40, 0x07, 0x06, 0x04, 0x02,
+    0x41, 0x6c, 0x20,
+};
+
+static const UBYTE stereo_code[] =
+{
+    // Left POKEY at $D200, right at $D210
+    0xa9, 0x03,                         // $2000  start: LDA #3
+    0x8d, 0x1f, 0xd2,                   // $2002  STA RSKCTL
+    0xa9, 0x00,                         // $2005  LDA #0
+    0x85, 0x80,                         // $2007  STA CNT
+    0xa2, 0x00,                         // $2009  main: LDX #0
+    // a sweep on the right, its volume stepping, and a tone on the left
+    0x8a,                               // $200B  loop: TXA
+    0x29, 0x0f,                         // $200C  AND #$0F
+    0x09, 0x10,                         // $200E  ORA #$10
+    0x8d, 0x17, 0xd2,                   // $2010  STA RAUDC4
+    0x8e, 0x10, 0xd2,                   // $2013  STX RAUDF1
+    0x8a,                               // $2016  TXA
+    0x4a,                               // $2017  LSR A
+    0x4a,                               // $2018  LSR A
+    0x4a,                               // $2019  LSR A
+    0x4a,                               // $201A  LSR A
+    0x09, 0xa0,                         // $201B  ORA #$A0
+    0x8d, 0x01, 0xd2,                   // $201D  STA LAUDC1
+    0xe8,                               // $2020  INX
+    0xd0, 0xe8,                         // $2021  BNE loop
+    // once a sweep, new distortions, AUDCTL and pitches on the right
+    0xe6, 0x80,                         // $2023  INC CNT
+    0xa5, 0x80,                         // $2025  LDA CNT
+    0x8d, 0x00, 0xd2,                   // $2027  STA LAUDF1
+    0x8d, 0x18, 0xd2,                   // $202A  STA RAUDCTL
+    0x29, 0xe0,                         // $202D  AND #$E0
+    0x09, 0x0a,                         // $202F  ORA #$0A
+    0x8d, 0x11, 0xd2,                   // $2031  STA RAUDC1
+    0xa5, 0x80,                         // $2034  LDA CNT
+    0x0a,                               // $2036  ASL A
+    0x29, 0xe0,                         // $2037  AND #$E0
+    0x09, 0x08,                         // $2039  ORA #$08
+    0x8d, 0x13, 0xd2,                   // $203B  STA RAUDC2
+    0x49, 0x40,                         // $203E  EOR #$40
+    0x8d, 0x15, 0xd2,                   // $2040  STA RAUDC3
+    0xa5, 0x80,                         // $2043  LDA CNT
+    0x8d, 0x12, 0xd2,                   // $2045  STA RAUDF2
+    0x49, 0xff,                         // $2048  EOR #$FF
+    0x8d, 0x14, 0xd2,                   // $204A  STA RAUDF3
+    0x4a,                               // $204D  LSR A
+    0x8d, 0x16, 0xd2,                   // $204E  STA RAUDF4
+    0x4c, 0x09, 0x20,                   // $2051  JMP main
+};
+
+// The boot file of boot.cas: the 6 byte boot header, the code that runs once
+// it is in and then (added by write_cas()) filler to take it to several records
+static const UBYTE boot_code[] =
+{
+    0x00,                               // $2000  flags
+    0x00,                               // $2001  records - set by write_cas()
+    0x00, 0x20,                         // $2002  load address
+    0x3f, 0x20,                         // $2004  init address
+    0xa9, 0x40,                         // $2006  LDA #<main
+    0x85, 0x0a,                         // $2008  STA DOSVEC
+    0xa9, 0x20,                         // $200A  LDA #>main
+    0x85, 0x0b,                         // $200C  STA DOSVEC+1
+    0x18,                               // $200E  CLC
+    0x60,                               // $200F  RTS
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0x60,                               // $203F  init: RTS
+    0xa9, 0x94,                         // $2040  main: LDA #$94
+    0x8d, 0xc6, 0x02,                   // $2042  STA COLOR2
+    0xa0, 0x00,                         // $2045  LDY #0
+    0x98,                               // $2047  fill: TYA
+    0x91, 0x58,                         // $2048  STA (SAVMSC),Y
+    0xc8,                               // $204A  INY
+    0xd0, 0xfa,                         // $204B  BNE fill
+    0xee, 0x00, 0x30,                   // $204D  loop: INC $3000
+    0x4c, 0x4d, 0x20,                   // $2050  JMP loop
+};
+
+typedef struct
+{
+    const char *name;
+    const UBYTE *code;
+    int size;
+    void (*patch)(UBYTE *code);         // Makes a variant of code, or NULL
+    int (*write)(FILE *fp, const UBYTE *code, int size);
+} testimg_t;
+
+// ---------------------------------------------------------------------------
+// An executable of one segment at TESTIMG_ORG that RUNAD starts.
+// ---------------------------------------------------------------------------
+static int write_xex(FILE *fp, const UBYTE *code, int size)
+{
+    UWORD end = TESTIMG_ORG + size - 1;
+    const UBYTE header[] = {0xff, 0xff, TESTIMG_ORG & 0xff, TESTIMG_ORG >> 8, end & 0xff, end >> 8};
+    const UBYTE runad[] = {0xe0, 0x02, 0xe1, 0x02, TESTIMG_ORG & 0xff, TESTIMG_ORG >> 8};
+
+    return fwrite(header, sizeof(header), 1, fp) == 1 && fwrite(code, size, 1, fp) == 1 && fwrite(runad, sizeof(runad), 1, fp) == 1;
+}
+
+// ---------------------------------------------------------------------------
+// A .CAS boot tape at 600 baud: the boot file (code and CAS_FILLER bytes of
+// filler after it) in 128 byte records, each with the two $55 sync bytes, the
+// control byte and the checksum the OS reads, then the end of file record.
+// The first record has the long leader before it, the others a short gap.
+// ---------------------------------------------------------------------------
+#define CAS_FILLER      600
+#define CAS_RECORD      128
+
+static int write_chunk(FILE *fp, const char *id, const UBYTE *data, int length, int aux)
+{
+    const UBYTE header[] = {id[0], id[1], id[2], id[3], length & 0xff, length >> 8, aux & 0xff, aux >> 8};
+
+    return fwrite(header, sizeof(header), 1, fp) == 1 && (length == 0 || fwrite(data, length, 1, fp) == 1);
+}
+
+static int write_record(FILE *fp, UBYTE control, const UBYTE *data, int gap_ms)
+{
+    UBYTE record[3 + CAS_RECORD + 1] = {0x55, 0x55, control};
+
+    memcpy(record + 3, data, CAS_RECORD);
+    record[3 + CAS_RECORD] = SIO_ChkSum(record, 3 + CAS_RECORD);
+    return write_chunk(fp, "data", record, sizeof(record), gap_ms);
+}
+
+static int write_cas(FILE *fp, const UBYTE *code, int size)
+{
+    static const char description[] = "A8DS test tape";
+    UBYTE file[0x1000] = {0};
+    int records = (size + CAS_FILLER + CAS_RECORD - 1) / CAS_RECORD;
+    int ok;
+
+    memcpy(file, code, size);
+    for (int i = 0; i < CAS_FILLER; i++) file[size + i] = (UBYTE) (i * 7 + 3);
+    file[1] = (UBYTE) records;
+
+    ok = write_chunk(fp, "FUJI", (const UBYTE *) description, sizeof(description) - 1, 0) && write_chunk(fp, "baud", NULL, 0, 600);
+    for (int r = 0; r < records && ok; r++)
+        ok = write_record(fp, 0xfc, file + r * CAS_RECORD, r ? 1000 : 20000);
+    memset(file, 0, CAS_RECORD);
+    return ok && write_record(fp, 0xfe, file, 1000);
+}
+
+// ---------------------------------------------------------------------------
+// An .ATR disk image of size sectors (the table's size is a sector count for
+// these). Double density images keep the first three sectors at 128 bytes,
+// as the OS boots them. Nothing here boots - the sectors only carry a
+// pattern made from their number.
+// ---------------------------------------------------------------------------
+#define ATR_HEADER      16
+
+static int write_atr(FILE *fp, int sectors, int sector_size)
+{
+    UBYTE sector[256];
+    ULONG bytes = (sector_size == 128) ? sectors * 128 : 3 * 128 + (sectors - 3) * 256;
+    ULONG paras = bytes >> 4;
+    const UBYTE header[ATR_HEADER] = {0x96, 0x02, paras & 0xff, (paras >> 8) & 0xff, sector_size & 0xff, sector_size >> 8, (paras >> 16) & 0xff};
+    int ok = fwrite(header, sizeof(header), 1, fp) == 1;
+
+    for (int s = 1; s <= sectors && ok; s++)
+    {
+        int size = (s <= 3) ? 128 : sector_size;
+        for (int b = 0; b < size; b++) sector[b] = (UBYTE) (s * 13 + (s >> 8) + b * 5);
+        ok = fwrite(sector, size, 1, fp) == 1;
+    }
+    return ok;
+}
+
+static int write_atr_sd(FILE *fp, const UBYTE *code, int size)
+{
+    return write_atr(fp, size, 128);
+}
+
+static int write_atr_dd(FILE *fp, const UBYTE *code, int size)
+{
+    return write_atr(fp, size, 256);
+}
+
+// mixn.xex - the immediates of the LDA #3 for GRACTL and the LDA #$3E for SDMCTL
+#define MIX_GRACTL      (0x20dc - TESTIMG_ORG)
+#define MIX_SDMCTL      (0x2143 - TESTIMG_ORG)
+
+static void mix_no_players(UBYTE *code)
+{
+    code[MIX_GRACTL] = 0x00;
+    code[MIX_SDMCTL] = 0x22;            // Normal playfield, no player/missile DMA
+}
+
+static const testimg_t testimg[] =
+{
+    {"coll.xex",    coll_code,  sizeof(coll_code),  NULL,               write_xex},
+    {"mix.xex",     mix_code,   sizeof(mix_code),   NULL,               write_xex},
+    {"mixn.xex",    mix_code,   sizeof(mix_code),   mix_no_players,     write_xex},
+    {"mixs.xex",    mixs_code,  sizeof(mixs_code),  NULL,               write_xex},
+    {"idleirq.xex", idleirq_code, sizeof(idleirq_code), NULL,           write_xex},
+    {"timer.xex",   timer_code, sizeof(timer_code), NULL,               write_xex},
+    {"dlmod.xex",   dlmod_code, sizeof(dlmod_code), NULL,               write_xex},
+    {"stereo.xex",  stereo_code, sizeof(stereo_code), NULL,             write_xex},
+    {"boot.cas",    boot_code,  sizeof(boot_code),  NULL,               write_cas},
+    {"disk.atr",    NULL,       720,                NULL,               write_atr_sd},
+    {"bigdisk.atr", NULL,       1600,               NULL,               write_atr_dd},
+};
+
+// Write the image called name (as listed above) to filename. Returns 0 if it went.
+int testimg_write(const char *name, const char *filename)
+{
+    const testimg_t *img = NULL;
+
+    for (int i = 0; i < (int) (sizeof(testimg) / sizeof(testimg[0])); i++)
+        if (!strcmp(testimg[i].name, name)) img = &testimg[i];
+    if (img == NULL)
+    {
+        fprintf(stderr, "a8bench: no test image called %s\n", name);
+        return 1;
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "a8bench: unable to write %s\n", filename);
+        return 1;
+    }
+    UBYTE code[0x1000];
+    if (img->code) memcpy(code, img->code, img->size);
+    if (img->patch) img->patch(code);
+    int ok = img->write(fp, code, img->size);
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "a8bench: unable to write %s\n", filename);
+    return ok ? 0 : 1;
+}